@@ -0,0 +1,15 @@
+/*
+ * checksum.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#ifndef INC_CHECKSUM_H_
+#define INC_CHECKSUM_H_
+
+#include <stdint.h>
+
+uint16_t Checksum_Fletcher16(const uint8_t *pData, uint16_t nSize);
+
+#endif /* INC_CHECKSUM_H_ */
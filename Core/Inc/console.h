@@ -15,6 +15,9 @@
 #include "console_drv.h"
 #include "tof.h"
 
+// Measurement records printed by the HIST command
+#define CONSOLE_HISTORY_RECORDS 10
+
 void  Console_Init();
 void  Console_Exec(void);
 
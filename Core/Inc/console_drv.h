@@ -41,6 +41,7 @@ CONSOLE_STATUS      ConsoleDrv_Init(USART_TypeDef* eModule);
 void                ConsoleDrv_Start();
 void                ConsoleDrv_Putc(uint8_t Symbol);
 void                ConsoleDrv_Puts(char *Message);
+uint8_t             ConsoleDrv_Write(const uint8_t *pData, uint16_t nSize);
 void                ConsoleDrv_Printf(char *Message, ...);
 int                 ConsoleDrv_GetMessageLength(char *Message);
 char*               ConsoleDrv_GetNextArgument(char *Message);
@@ -14,6 +14,14 @@
 #define MAX_SHELVES_COUNT     0x05
 #define DATA_STARTING_ADDRESS 0x00
 
+// I2C controller of each shelf sensor, stored after the shelf records of the header
+#define SHELF_I2C_BUS_ADDRESS (DATA_STARTING_ADDRESS + 3 + MAX_SHELVES_COUNT * 4)
+
+// Per-sensor cache of the data decoded from the ToF sensor NVM
+#define SENSOR_CACHE_STARTING_ADDRESS 0x100
+#define SENSOR_CACHE_SLOT_SIZE        0x100
+#define SENSOR_CACHE_HEADER_SIZE      16
+
 typedef enum {
 	DRINK = 0,
 	SNACK = 1,
@@ -23,12 +31,22 @@ typedef enum {
 typedef struct {
 	SHELF_TYPES m_eShelfType;
 	uint8_t     m_nI2cAddress;
+	uint8_t     m_nI2cBus;		// 0 - I2C1 ... 3 - I2C4, other values are treated as I2C1
 	uint8_t     m_nInitialStock;
 	uint8_t     m_nLeftStock;
 }EEPROM_SHELF_INFO;
 
+// Sensor cache write waiting for EEPROM_Exec
+typedef struct {
+	uint8_t  m_arrData[SENSOR_CACHE_SLOT_SIZE];	// Header and data, laid out as in the cache slot
+	uint16_t m_nNext;							// Next byte to write
+	uint16_t m_nEnd;							// End of the part being written - the data goes first, the header last
+	uint8_t  m_bPending;
+}EEPROM_CACHE_WRITE;
+
 void EEPROM_Init();
 void EEPROM_ReadAll();
+void EEPROM_Exec();
 void EEPROM_RegisterNewShelf(EEPROM_SHELF_INFO *pShelf);
 void EEPROM_UpdateShelfLeftStock(uint8_t nIndex, uint8_t nLeftStock);
 
@@ -38,5 +56,8 @@ uint8_t            EEPROM_GetShelfInitialStock(uint8_t nIndex);
 uint8_t 		   EEPROM_GetShelfLeftStock(uint8_t nIndex);
 uint8_t            EEPROM_GetTotalShelvesCount();
 
+uint8_t EEPROM_ReadSensorCache(uint8_t nIndex, uint64_t nUid, uint8_t *pData, uint16_t nSize);
+uint8_t EEPROM_WriteSensorCache(uint8_t nIndex, uint64_t nUid, uint8_t *pData, uint16_t nSize);
+
 
 #endif /* INC_EEPROM_H_ */
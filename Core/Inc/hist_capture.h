@@ -0,0 +1,64 @@
+/*
+ * hist_capture.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#ifndef INC_HIST_CAPTURE_H_
+#define INC_HIST_CAPTURE_H_
+
+#include "vl53lx_api.h"
+
+/* Raw histogram capture. Every consumed measurement of the captured sensors
+ * is serialized in a binary frame and queued on the console UART (the ST-LINK
+ * virtual COM port). A frame which doesn't fit in the UART FIFO is dropped
+ * and counted, the measurements are never delayed by the capture.
+ *
+ * Frame, all fields little endian:
+ *   Header (16 bytes)
+ *     uint8  sync[2]          HIST_CAPTURE_SYNC_0, HIST_CAPTURE_SYNC_1
+ *     uint8  version          HIST_CAPTURE_VERSION
+ *     uint8  sensor
+ *     uint16 payload size
+ *     uint16 dropped frames   since the start of the capture, wraps around
+ *     uint32 sequence         of the frame, including the dropped ones
+ *     uint32 timestamp        of the data ready event [us]
+ *   Histogram
+ *     uint8  stream count, range status, first bin, bins count (n),
+ *            ambient bins, VCSEL period, phasecal VCSEL start
+ *     uint8  bin sequence[6], bin repeats[6]
+ *     uint16 VCSEL width, fast oscillator frequency, zero distance phase,
+ *            reference phase, effective SPADs (8.8)
+ *     uint32 total periods elapsed, peak duration [us], WOI duration [us]
+ *     int24  bins[n]
+ *   Range results
+ *     uint8  stream count, device status, targets (t)
+ *     int16  wrap dmax [mm]
+ *     t times:
+ *       int16  median, min, max range [mm]
+ *       uint8  range status
+ *       uint16 sigma [mm 9.7], peak signal, ambient [MCPS 9.7]
+ *   Fletcher-16 checksum of the header and the payload (uint16)
+ */
+#define HIST_CAPTURE_SYNC_0  0xA5
+#define HIST_CAPTURE_SYNC_1  0x5A
+#define HIST_CAPTURE_VERSION 1
+
+#define HIST_CAPTURE_HEADER_SIZE 16
+#define HIST_CAPTURE_FRAME_SIZE  (HIST_CAPTURE_HEADER_SIZE + 41 + VL53LX_HISTOGRAM_BUFFER_SIZE * 3 + \
+								  5 + VL53LX_MAX_RANGE_RESULTS * 13 + 2)
+
+typedef struct {
+	uint32_t m_nFrames;
+	uint32_t m_nDropped;
+	uint32_t m_nBytes;
+}HIST_CAPTURE_STATS;
+
+void HistCapture_Start(uint8_t nSensorMask);
+void HistCapture_Stop(void);
+uint8_t HistCapture_IsEnabled(uint8_t nSensor);
+void HistCapture_Frame(uint8_t nSensor, uint32_t nTimestamp, const VL53LX_histogram_bin_data_t *pHistogram, const VL53LX_range_results_t *pResults);
+const HIST_CAPTURE_STATS* HistCapture_GetStats(void);
+
+#endif /* INC_HIST_CAPTURE_H_ */
@@ -0,0 +1,103 @@
+/*
+ * i2c_bus.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#ifndef INC_I2C_BUS_H_
+#define INC_I2C_BUS_H_
+
+#include "main.h"
+#include "hw_resources.h"
+#include "led.h"
+#include "system.h"
+
+#define I2C_BUS_DMA_IRQ_PRIORITY 0
+
+// Maximum number of non-blocking transactions waiting for the bus
+#define I2C_BUS_QUEUE_SIZE 8
+
+// Time a blocking client waits for the bus before giving up
+#define I2C_BUS_ACQUIRE_TIMEOUT_MS 20
+
+typedef enum {
+	I2C_BUS_1 = 0,
+	I2C_BUS_2 = 1,
+	I2C_BUS_3 = 2,
+	I2C_BUS_4 = 3,
+	I2C_BUSES_COUNT
+}I2C_BUS_ID;
+
+typedef enum {
+	I2C_BUS_CLIENT_TOF      = 0,
+	I2C_BUS_CLIENT_EXPANDER = 1,
+	I2C_BUS_CLIENT_DISPLAY  = 2,
+	I2C_BUS_CLIENTS_COUNT
+}I2C_BUS_CLIENT;
+
+typedef enum {
+	I2C_BUS_PRIORITY_LOW    = 0,	// Display refresh
+	I2C_BUS_PRIORITY_NORMAL = 1,	// Configuration, expander I/O
+	I2C_BUS_PRIORITY_HIGH   = 2		// Histogram readout
+}I2C_BUS_PRIORITY;
+
+typedef enum {
+	I2C_BUS_STATUS_OK,
+	I2C_BUS_STATUS_BUSY,
+	I2C_BUS_STATUS_ERROR
+}I2C_BUS_STATUS;
+
+typedef enum {
+	I2C_TRANSACTION_IDLE,
+	I2C_TRANSACTION_QUEUED,
+	I2C_TRANSACTION_ACTIVE,
+	I2C_TRANSACTION_DONE,
+	I2C_TRANSACTION_ERROR
+}I2C_TRANSACTION_STATE;
+
+/* Non-blocking memory read/write. The structure is owned by the client and
+ * has to stay valid until the transaction is done. The callback is called
+ * from the interrupt context.
+ */
+typedef struct I2C_BUS_TRANSACTION {
+	I2C_BUS_ID       m_eBus;
+	I2C_BUS_CLIENT   m_eClient;
+	I2C_BUS_PRIORITY m_ePriority;
+	uint16_t         m_nDevAddr;
+	uint16_t         m_nMemAddr;
+	uint16_t         m_nMemAddrSize;	// I2C_MEMADD_SIZE_8BIT or I2C_MEMADD_SIZE_16BIT
+	uint8_t          *m_pData;
+	uint16_t         m_nSize;
+	uint8_t          m_bRead;
+	void             (*m_pCallback)(struct I2C_BUS_TRANSACTION *pTransaction);
+	void             *m_pContext;
+
+	// Private, maintained by the bus manager
+	volatile I2C_TRANSACTION_STATE m_eState;
+	uint32_t m_nRequestTimestamp;
+}I2C_BUS_TRANSACTION;
+
+typedef struct {
+	uint32_t m_nTransactions;
+	uint32_t m_nBytes;
+	uint32_t m_nErrors;
+	uint32_t m_nTotalLatency_us;	// From the request to the bus grant
+	uint32_t m_nMaxLatency_us;
+}I2C_BUS_CLIENT_STATS;
+
+void I2CBus_Init(I2C_BUS_ID eBus);
+uint8_t I2CBus_IsInitialized(I2C_BUS_ID eBus);
+I2C_BUS_STATUS I2CBus_Submit(I2C_BUS_TRANSACTION *pTransaction);
+I2C_BUS_STATUS I2CBus_Acquire(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient, I2C_BUS_PRIORITY ePriority);
+void I2CBus_Release(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient);
+HAL_StatusTypeDef I2CBus_Transmit(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient, uint16_t nDevAddr, uint8_t *pData, uint16_t nSize, uint32_t nTimeout);
+HAL_StatusTypeDef I2CBus_Receive(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient, uint16_t nDevAddr, uint8_t *pData, uint16_t nSize, uint32_t nTimeout);
+uint8_t I2CBus_IsAvailable(I2C_BUS_ID eBus, I2C_BUS_PRIORITY ePriority);
+const I2C_BUS_CLIENT_STATS* I2CBus_GetStats(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient);
+void I2CBus_ResetStats(void);
+I2C_HandleTypeDef* I2CBus_GetHandle(I2C_BUS_ID eBus);
+DMA_HandleTypeDef* I2CBus_GetDmaRxHandle(I2C_BUS_ID eBus);
+DMA_HandleTypeDef* I2CBus_GetDmaTxHandle(I2C_BUS_ID eBus);
+
+#endif /* INC_I2C_BUS_H_ */
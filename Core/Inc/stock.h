@@ -0,0 +1,84 @@
+/*
+ * stock.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#ifndef INC_STOCK_H_
+#define INC_STOCK_H_
+
+/* The stock estimation doesn't depend on the HAL or the ToF driver, so the
+ * same code runs in the firmware and in the host replay tool.
+ */
+#include <stdint.h>
+
+#define DRINK_SIZE_MM                 55
+#define TOF_INITIAL_OFFSET_MM         100
+#define TOF_DISTANCE_BETWEEN_ITEMS_MM 20
+
+/* Linear fit of the raw distance, real = A * raw + B, in Q20 fixed point
+ * (A = 0.9740, B = 26.0097). Q20 gives the same millimetres as the floating
+ * point fit over the whole range of the sensor.
+ */
+#define STOCK_POLYFIT_Q_BITS      20
+#define STOCK_POLYFIT_COEF_A_Q20  1021313
+#define STOCK_POLYFIT_COEF_B_Q20  27273147
+
+/* Item boundaries kept per shelf. Items farther than the last boundary
+ * (~6m, past the range of the sensor) can't be told apart anyway.
+ */
+#define STOCK_TABLE_SIZE 80
+
+/* Stock filter. Consecutive ranges are averaged with weights of
+ * signal / sigma^2 while they agree with each other (within GATE sigmas).
+ * A new stock is confirmed once the averaged range is CONFIDENCE sigmas
+ * away from the boundaries of that stock, but not before MIN_FRAMES frames.
+ * Frames with signal below the reference rate weigh proportionally less.
+ * The values can be overridden at build time for tuning with the replay tool.
+ */
+#ifndef STOCK_FILTER_GATE_SIGMAS
+#define STOCK_FILTER_GATE_SIGMAS       3
+#endif
+#ifndef STOCK_FILTER_CONFIDENCE_SIGMAS
+#define STOCK_FILTER_CONFIDENCE_SIGMAS 3
+#endif
+#ifndef STOCK_FILTER_MIN_FRAMES
+#define STOCK_FILTER_MIN_FRAMES        2
+#endif
+#ifndef STOCK_FILTER_SIGNAL_REF_MCPS
+#define STOCK_FILTER_SIGNAL_REF_MCPS   1
+#endif
+#define STOCK_FILTER_MAX_WEIGHT        0x01000000	// Older frames fade out above this
+
+/* Raw distances at which the stock of a shelf changes, built once from the
+ * shelf record. Entry k is the shortest raw distance with k+1 items taken.
+ */
+typedef struct {
+	uint8_t m_nMaxItems;
+	uint8_t m_nBoundariesCount;
+	int16_t m_arrRawBoundaries_mm[STOCK_TABLE_SIZE];
+}STOCK_TABLE;
+
+/* Weighted average of the ranges since the last level change. A weight of
+ * 0x10000 is the information of a single frame with 1mm sigma.
+ */
+typedef struct {
+	int64_t  m_nWeightedRangeSum;
+	uint32_t m_nWeightSum;
+	uint8_t  m_nFrames;
+}STOCK_FILTER;
+
+typedef struct {
+	STOCK_TABLE  m_sTable;
+	STOCK_FILTER m_sFilter;
+}STOCK_ESTIMATOR;
+
+void Stock_Init(STOCK_ESTIMATOR *pEstimator, uint8_t nMaxItems);
+void Stock_ResetFilter(STOCK_ESTIMATOR *pEstimator);
+uint8_t Stock_Filter(STOCK_ESTIMATOR *pEstimator, int16_t nRange_mm, uint16_t nSigma_mm, uint16_t nSignalRate, uint8_t *pLeftItems);
+uint8_t Stock_Estimate(const STOCK_ESTIMATOR *pEstimator, int16_t nRawDistance);
+void Stock_GetWindow(const STOCK_ESTIMATOR *pEstimator, uint8_t nLeftItems, int16_t *pLow, int16_t *pHigh);
+int16_t Stock_PolyfitRawDistance(int32_t nRawDistance);
+
+#endif /* INC_STOCK_H_ */
@@ -10,7 +10,56 @@
 
 #include "main.h"
 
+// Stack painting and high-water marks per call path, in the debug builds
+#ifdef DEBUG
+#define SYSTEM_STACK_MONITOR
+#endif
+
+// Bytes below the top of RAM which are painted and watched
+#define SYSTEM_STACK_MONITOR_SIZE 0x2000
+// Bytes painted below the frame of an instrumented interrupt handler
+#define SYSTEM_STACK_ISR_WINDOW   0x200
+// Left untouched below the current frame while painting
+#define SYSTEM_STACK_GUARD        0x40
+
+typedef enum {
+	STACK_PATH_CONSOLE,
+	STACK_PATH_TOF,
+	STACK_PATH_BLUENRG,
+	STACK_PATH_EEPROM,
+	STACK_PATH_ISR_SYSTICK,
+	STACK_PATH_ISR_I2C,
+	STACK_PATH_ISR_DMA,
+	STACK_PATH_ISR_EXTI,
+	STACK_PATH_ISR_UART,
+	STACK_PATHS_COUNT
+}SYSTEM_STACK_PATH;
+
+#ifdef SYSTEM_STACK_MONITOR
+// Run a main loop call and record the deepest stack address it reached
+#define SYSTEM_STACK_MEASURE(ePath, call) \
+	do { System_StackEnter(ePath); call; System_StackExit(ePath); } while (0)
+// Bracket the body of an interrupt handler
+#define SYSTEM_STACK_ISR_ENTER() uint32_t nStackIsrSp = __get_MSP(); System_StackIsrEnter(nStackIsrSp)
+#define SYSTEM_STACK_ISR_EXIT(ePath) System_StackIsrExit(ePath, nStackIsrSp)
+#else
+#define SYSTEM_STACK_MEASURE(ePath, call) call
+#define SYSTEM_STACK_ISR_ENTER()
+#define SYSTEM_STACK_ISR_EXIT(ePath)
+#endif
+
 void System_Init(void);
+void System_UpdateTimebase(void);
+uint32_t System_GetMicros(void);
+void System_DelayUs(uint32_t nDelay_us);
+void System_StackEnter(SYSTEM_STACK_PATH ePath);
+void System_StackExit(SYSTEM_STACK_PATH ePath);
+void System_StackIsrEnter(uint32_t nEntrySp);
+void System_StackIsrExit(SYSTEM_STACK_PATH ePath, uint32_t nEntrySp);
+uint32_t System_GetStackHighWaterMark(SYSTEM_STACK_PATH ePath);
+uint32_t System_GetStackPeak(void);
+uint32_t System_GetStackMonitoredSize(void);
+void System_ResetStackStats(void);
 
 
 #endif /* INC_SYSTEM_H_ */
@@ -8,8 +8,8 @@
 #ifndef TOF_TOF_H_
 #define TOF_TOF_H_
 
-#include <math.h>
 #include "vl53lx_api.h"
+#include "vl53lx_hist_map.h"
 #include "53L3A2.h"
 #include "53l3a2.h"
 #include "stm32l5xx_hal.h"
@@ -18,22 +18,46 @@
 #include "led.h"
 #include "eeprom.h"
 #include "log.h"
+#include "system.h"
+#include "i2c_bus.h"
+#include "stock.h"
+#include "hist_capture.h"
 
-#define SENSORS_SUPPORTED 1
+#define SENSORS_SUPPORTED MAX_SHELVES_COUNT
+
+/* Every VL53L3CX wakes up on the default address. The sensors are released
+ * from reset one by one and moved to the address stored in the shelf table.
+ */
+#define TOF_DEFAULT_I2C_ADDRESS 0x52
+#define TOF_BOOT_TIME_MS        2
 
 #define XNUCLEO_SENSOR_LEFT    0
 #define XNUCLEO_SENSOR_CENTER  1
 #define XNUCLEO_SENSOR_RIGHT   2
 
-#define DRINK_SIZE_MM                 55
-#define TOF_INITIAL_OFFSET_MM         100
-#define TOF_DISTANCE_BETWEEN_ITEMS_MM 20
+/* Adaptive measurement cadence. A shelf is measured fast while its distance
+ * is changing and falls back to the slow cadence once it has been stable.
+ * A shelf with an item window is parked instead - its sensor ranges on its
+ * own and raises GPIO1 only when the front item leaves the window.
+ */
+#define TOF_FAST_MEASUREMENT_PERIOD_MS   100
+#define TOF_SLOW_MEASUREMENT_PERIOD_MS   2000
+#define TOF_PARKED_MEASUREMENT_PERIOD_MS TOF_SLOW_MEASUREMENT_PERIOD_MS
+#define TOF_FAST_TIMING_BUDGET_US        33000
+#define TOF_SLOW_TIMING_BUDGET_US        100000
+#define TOF_STABLE_TIME_TO_SLOW_DOWN_MS  10000
+
+#define TOF_DATA_READY_IRQ_PRIORITY 1
 
-#define TOF_POLYFIT_COEF_A 0.9740
-#define TOF_POLYFIT_COEF_B 26.0097
+// Measurement records kept per sensor, has to be a power of 2
+#define TOF_HISTORY_SIZE 256
 
 typedef enum {
-	TOF_CENTRAL = 0,
+	TOF_CENTRAL     = 0,
+	TOF_SATELLITE_1 = 1,
+	TOF_SATELLITE_2 = 2,
+	TOF_SATELLITE_3 = 3,
+	TOF_SATELLITE_4 = 4
 }TOF_SUPPORTED_SENSORS;
 
 typedef enum {
@@ -43,11 +67,18 @@ typedef enum {
 
 typedef enum {
 	STATE_NOT_INIT,
+	STATE_BOOT_PENDING,
+	STATE_BOOTING,
+	STATE_DATA_INIT,	// Reading the NVM of the sensor, one block per pass
 	STATE_INIT_IN_PROCESS,
 	STATE_IDLE,
 	STATE_PENDING_MEASUREMENT,
 	STATE_MEASURING,
 	STATE_IGNORE_FIRST_DATA,
+	STATE_STREAMING,
+	STATE_FETCHING,
+	STATE_PROCESSING,
+	STATE_PARKED,		// Ranging against the item window on its own, waiting for GPIO1
 	STATE_ERROR
 }TOF_STATE;
 
@@ -57,25 +88,83 @@ typedef enum {
 }TOF_MEASUREMENT_PERFORMED;
 
 typedef enum {
+	TOF_MEASURING_MODE_NONE,		// Shelf not registered - its data ready pin isn't armed
 	TOF_MEASURING_MODE_INTERRUPT,
 	TOF_MEASURING_MODE_POLLING
 }TOF_MEASURING_MODE;
 
+/* Data ready event of a sensor. It is raised from the GPIO1 EXTI interrupt
+ * (or by sampling the pin when its EXTI line is owned by another peripheral)
+ * and consumed by ToF_Exec, which is the only place doing I2C work.
+ */
+typedef struct {
+	volatile uint8_t  m_bDataReady;
+	volatile uint32_t m_nTimestamp;  // us
+}TOF_DATA_READY_EVENT;
+
 typedef enum {
-	I2C_STATUS_NOT_INIT,
-	I2C_STATUS_INIT
-}I2C_STATUS;
+	TOF_CADENCE_FAST,
+	TOF_CADENCE_SLOW,
+	TOF_CADENCE_PARKED
+}TOF_CADENCE;
+
+typedef struct {
+	TOF_CADENCE m_eCadence;
+	uint8_t     m_bParkRequested;
+	uint8_t     m_nReferenceLeftItems;
+	uint32_t    m_nStableSince;
+	uint32_t    m_nLastMeasurement;
+}TOF_CADENCE_CONTROL;
+
+/* Raw distance window [m_nLow_mm, m_nHigh_mm) in which the front item has to
+ * be for the current stock. Its limits are the stock boundaries of the shelf
+ * (Stock_GetWindow).
+ */
+typedef struct {
+	int16_t m_nLow_mm;
+	int16_t m_nHigh_mm;
+}TOF_ITEM_WINDOW;
+
+/* Compact record of a consumed measurement (primary target only).
+ * Rates are in MCPS as 9.7 fixed point, sigma is in mm as 8.8 fixed point,
+ * both saturated to 0xFFFF.
+ */
+typedef struct {
+	uint32_t m_nTimestamp;  // us
+	int16_t  m_nRange_mm;
+	uint16_t m_nSigma_mm;
+	uint16_t m_nSignalRate;
+	uint16_t m_nAmbientRate;
+	uint8_t  m_nRangeStatus;
+	uint8_t  m_nStreamCount;
+}TOF_MEASUREMENT_RECORD;
+
+/* Ring of the last TOF_HISTORY_SIZE records of a sensor. m_nWritten counts
+ * all records ever written, readers keep their own cursor against it.
+ */
+typedef struct {
+	TOF_MEASUREMENT_RECORD m_arrRecords[TOF_HISTORY_SIZE];
+	volatile uint32_t      m_nWritten;
+}TOF_MEASUREMENT_HISTORY;
 
 typedef enum {
 	XNUCLEO_53L3A2 = 0,
 	CUSTOM_PCB
 }PCB_USED;
 
+void ToF_InitAll();
 void ToF_Init(TOF_SUPPORTED_SENSORS eSensor);
 void ToF_Exec();
 void ToF_InitiateMeasurement(TOF_SUPPORTED_SENSORS eSensor);
+void ToF_InitiateMeasurementAll();
 TOF_STATUS ToF_Measure(TOF_SUPPORTED_SENSORS eSensor);
-VL53LX_MultiRangingData_t* ToF_GetDistance_mm(TOF_SUPPORTED_SENSORS eSensor);
+VL53LX_PrimaryRangingData_t* ToF_GetDistance_mm(TOF_SUPPORTED_SENSORS eSensor);
 uint8_t ToF_GetLeftItems(TOF_SUPPORTED_SENSORS eSensor);
+uint32_t ToF_GetHistoryCount(TOF_SUPPORTED_SENSORS eSensor);
+uint8_t ToF_ReadHistory(TOF_SUPPORTED_SENSORS eSensor, uint32_t *pCursor, TOF_MEASUREMENT_RECORD *pRecord);
+uint8_t ToF_GetLatestRecord(TOF_SUPPORTED_SENSORS eSensor, TOF_MEASUREMENT_RECORD *pRecord);
+TOF_MEASURING_MODE ToF_GetMeasuringMode(TOF_SUPPORTED_SENSORS eSensor);
+TOF_CADENCE ToF_GetCadence(TOF_SUPPORTED_SENSORS eSensor);
+TOF_ITEM_WINDOW* ToF_GetItemWindow(TOF_SUPPORTED_SENSORS eSensor);
 
 #endif /* TOF_TOF_H_ */
@@ -31,7 +31,7 @@
 #define _VL53LX_PLATFORM_H_
 
 #include <vl53lx_platform_log.h>
-#include "VL53Lx_ll_def.h"
+#include "vl53lx_ll_def.h"
 
 #define VL53LX_IPP_API
 #include <vl53lx_platform_ipp_imports.h>
@@ -423,9 +423,189 @@ VL53LX_Error VL53LX_WaitValueMaskEx(
 		uint8_t       mask,
 		uint32_t      poll_delay_ms);
 
+
+/**
+ * @brief Resumable version of VL53LX_WaitValueMaskEx()
+ *
+ * Reads the register once and returns right away. The timeout starts with
+ * the first call and is checked on every following one, so the caller can
+ * step the wait across main loop passes instead of blocking.
+ *
+ * @param[in]   pdev          : pointer to device structure (device handle)
+ * @param[in]   timeout_ms    : timeout in [ms]
+ * @param[in]   index         : uint16_t register index value
+ * @param[in]   value         : value to wait for
+ * @param[in]   mask          : mask to be applied before comparison with value
+ * @param[out]  pdone         : set to 1 once the value has been found
+ *
+ * @return  VL53LX_ERROR_NONE     Success (check pdone)
+ * @return  VL53LX_ERROR_TIME_OUT The value has not been found in time
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+
+VL53LX_Error VL53LX_PollValueMaskEx(
+		VL53LX_Dev_t *pdev,
+		uint32_t      timeout_ms,
+		uint16_t      index,
+		uint8_t       value,
+		uint8_t       mask,
+		uint8_t      *pdone);
+
+
+/**
+ * @brief  Starts a non-blocking (DMA) read of the requested number of bytes
+ *
+ * The data is transferred into the device's own AsyncBuffer. Once the
+ * transfer has completed, the next VL53LX_ReadMulti() of the same index and
+ * count is served from that buffer instead of the bus, so the driver can be
+ * called as usual after the data has been fetched in the background.
+ * The fetched data is dropped by a VL53LX_WriteMulti() to any of its
+ * registers, to the interrupt clear (next measurement) or to the soft reset.
+ *
+ * @param[in]   pdev      : pointer to device structure (device handle)
+ * @param[in]   index     : uint16_t register index value
+ * @param[in]   count     : number of bytes to read
+ *
+ * @return   VL53LX_ERROR_NONE    Success
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+
+VL53LX_Error VL53LX_ReadMultiAsync(
+		VL53LX_Dev_t *pdev,
+		uint16_t      index,
+		uint32_t      count);
+
+
+/**
+ * @brief  Starts a non-blocking (DMA) write of the requested number of bytes
+ *
+ * The data is copied into the device's AsyncBuffer, so pdata may be reused
+ * as soon as the function returns.
+ *
+ * @param[in]   pdev      : pointer to device structure (device handle)
+ * @param[in]   index     : uint16_t register index value
+ * @param[in]   pdata     : pointer to uint8_t (byte) buffer containing the data to be written
+ * @param[in]   count     : number of bytes in the supplied byte buffer
+ *
+ * @return   VL53LX_ERROR_NONE    Success
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+
+VL53LX_Error VL53LX_WriteMultiAsync(
+		VL53LX_Dev_t *pdev,
+		uint16_t      index,
+		uint8_t      *pdata,
+		uint32_t      count);
+
+
+/**
+ * @brief  Checks the state of the last non-blocking transfer of the device
+ *
+ * @param[in]   pdev      : pointer to device structure (device handle)
+ * @param[out]  pdone     : set to 1 when the transfer is no longer in progress
+ *
+ * @return   VL53LX_ERROR_NONE    Success (or no transfer started)
+ * @return   VL53LX_ERROR_CONTROL_INTERFACE  The transfer has failed
+ */
+
+VL53LX_Error VL53LX_PollAsync(
+		VL53LX_Dev_t *pdev,
+		uint8_t      *pdone);
+
+/**
+ * @brief  Forgets the configuration registers kept in RAM
+ *
+ * Has to be called when the device is reset outside of the driver
+ * (e.g. by XSHUT). A soft reset through the driver is handled internally.
+ *
+ * @param[in]   pdev      : pointer to device structure (device handle)
+ */
+
+void VL53LX_ShadowInvalidate(
+		VL53LX_Dev_t *pdev);
+
+
+/**
+ * @brief  Per driver entry point I2C access statistics
+ *
+ * Collected when VL53LX_I2C_PROFILER is defined. The driver calls of the
+ * application are wrapped with VL53LX_PROFILED(), every register access made
+ * while the call is in progress is accounted to it.
+ */
+
+#define VL53LX_PROFILER_MAX_ENTRIES    24
+	/*!< Number of distinct entry points which can be recorded */
+#define VL53LX_PROFILER_MAX_REGISTERS  16
+	/*!< Number of distinct register indexes kept per entry point */
+
+typedef struct {
+	const char *name;
+	uint32_t    calls;
+	uint32_t    transactions;
+	uint32_t    bytes_read;
+	uint32_t    bytes_written;
+	uint32_t    total_time_us;
+	uint32_t    max_time_us;
+	uint16_t    register_count;
+	uint16_t    registers_dropped;
+	uint16_t    registers[VL53LX_PROFILER_MAX_REGISTERS];
+} VL53LX_ProfilerEntry_t;
+
+
+#ifdef VL53LX_I2C_PROFILER
+#define VL53LX_PROFILED(func, ...) \
+	(VL53LX_ProfilerBegin(#func), VL53LX_ProfilerEnd(func(__VA_ARGS__)))
+#else
+#define VL53LX_PROFILED(func, ...) func(__VA_ARGS__)
+#endif
+
+
+/**
+ * @brief  Opens the profiler scope of a driver entry point
+ *
+ * Nested scopes are accounted to the outermost one.
+ *
+ * @param[in]   name      : entry point name, has to be a string literal
+ */
+
+void VL53LX_ProfilerBegin(
+		const char   *name);
+
+
+/**
+ * @brief  Closes the profiler scope opened by VL53LX_ProfilerBegin()
+ *
+ * @param[in]   status    : status returned by the entry point
+ *
+ * @return  the status passed in, so the call can be wrapped transparently
+ */
+
+VL53LX_Error VL53LX_ProfilerEnd(
+		VL53LX_Error  status);
+
+
+/**
+ * @brief  Returns the recorded statistics of an entry point
+ *
+ * Accesses made outside of any scope are recorded in the "(unscoped)" entry.
+ *
+ * @param[in]   entry     : entry index, 0 .. VL53LX_PROFILER_MAX_ENTRIES - 1
+ *
+ * @return  pointer to the entry, NULL if the entry is not used
+ */
+
+const VL53LX_ProfilerEntry_t *VL53LX_ProfilerGetEntry(
+		uint32_t      entry);
+
+
+/**
+ * @brief  Clears all the recorded statistics
+ */
+
+void VL53LX_ProfilerReset(void);
+
 #ifdef __cplusplus
 }
 #endif
 
 #endif
-
@@ -107,5 +107,30 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define VL53LX_MAX_STRING_LENGTH 512
 	/*!< Sets the maximum string length */
 
+#define VL53LX_SHADOW_REGISTERS
+	/*!< Keeps the configuration registers in RAM - they are read from there
+	     and only the bytes which have changed are written to the device */
+
+#ifndef VL53LX_HIST_KERNELS
+#define VL53LX_HIST_KERNELS 1
+	/*!< 1 - the histogram post-processing runs the fast bin loops of
+	     vl53lx_hist_kernels.c (DSP instructions on the M33), 0 - the
+	     reference loops of the ST driver. The results are the same */
+#endif
+
+#ifndef VL53LX_HIST_MATH
+#define VL53LX_HIST_MATH 1
+	/*!< 1 - the sigma, dmax and rate maths use the square root and 64-bit
+	     division of vl53lx_hist_math.c (hardware divider and CLZ), 0 - the
+	     bit by bit square root and the divide of the compiler runtime.
+	     The results are the same */
+#endif
+
+#ifdef DEBUG
+#define VL53LX_I2C_PROFILER
+	/*!< Records the register accesses of each driver entry point,
+	     see VL53LX_ProfilerGetEntry() */
+#endif
+
 #endif  /* _VL53LX_PLATFORM_USER_CONFIG_H_ */
 
@@ -70,6 +70,7 @@
 #endif
 
 #include "vl53lx_def.h"
+#include "i2c_bus.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -77,6 +78,23 @@ extern "C"
 #endif
 
 
+/** Size of the per-device buffer used by the non-blocking transfers */
+#define VL53LX_ASYNC_BUFFER_SIZE 256
+
+/** States of the non-blocking transfer of a device */
+#define VL53LX_ASYNC_IDLE  0
+#define VL53LX_ASYNC_BUSY  1
+#define VL53LX_ASYNC_DONE  2
+#define VL53LX_ASYNC_ERROR 3
+
+/** Configuration registers mirrored in RAM (VL53LX_SHADOW_REGISTERS): the NVM
+ *  managed, static, general and timing config, 0x0001 .. 0x0070. The dynamic
+ *  config and system control carry the grouped parameter hold handshake and
+ *  the start/clear triggers, so they are always written.
+ */
+#define VL53LX_SHADOW_FIRST_INDEX 0x0001
+#define VL53LX_SHADOW_SIZE        0x0070
+
 typedef struct {
 	VL53LX_DevData_t   Data;
 	/*!< Low Level Driver data structure */
@@ -84,6 +102,7 @@ typedef struct {
 	uint8_t   comms_type;
 	uint16_t  comms_speed_khz;
 	I2C_HandleTypeDef *I2cHandle;
+	uint8_t   I2cBus;                    /*!< I2C controller of the device, see I2C_BUS_ID */
 	uint8_t   I2cDevAddr;
 	int     Present;
 	int 	Enabled;
@@ -94,6 +113,16 @@ typedef struct {
 	uint8_t RangeStatus;
 	FixPoint1616_t SignalRateRtnMegaCps;
 	VL53LX_DeviceState   device_state;  /*!< Device State */
+	uint8_t   AsyncBuffer[VL53LX_ASYNC_BUFFER_SIZE]; /*!< DMA buffer of the non-blocking transfers */
+	uint16_t  AsyncIndex;                /*!< Register index of the last non-blocking transfer */
+	uint32_t  AsyncCount;                /*!< Byte count of the last non-blocking transfer */
+	uint8_t   AsyncIsRead;               /*!< 1 if the last non-blocking transfer is a read */
+	volatile uint8_t AsyncState;         /*!< See VL53LX_ASYNC_xxx */
+	I2C_BUS_TRANSACTION AsyncTransaction; /*!< Bus manager request of the non-blocking transfer */
+	uint32_t  PollStartMs;               /*!< Start time of the pending VL53LX_PollValueMaskEx() */
+	uint8_t   PollActive;                /*!< 1 while a VL53LX_PollValueMaskEx() is pending */
+	uint8_t   ShadowRegs[VL53LX_SHADOW_SIZE]; /*!< Last known value of the configuration registers */
+	uint8_t   ShadowValid[(VL53LX_SHADOW_SIZE + 7) / 8]; /*!< 1 bit per register, set when ShadowRegs holds its value */
 } VL53LX_Dev_t;
 
 
@@ -174,6 +203,22 @@ typedef VL53LX_Dev_t* VL53LX_DEV;
 #define VL53LXDevStructGetLLResultsHandle(Dev) (&Dev->Data.llresults)
 
 
+/** Sizes of the post-processing work areas (were wArea1/wArea2 of each device) */
+#define VL53LX_WORK_AREA1_SIZE 1536
+#define VL53LX_WORK_AREA2_SIZE 512
+
+/** The work areas only live during one driver call (histogram processing,
+ *  range results before they are copied out). The driver is called from the
+ *  main loop only, so a single set is shared by all devices and just the
+ *  persistent state is kept per device.
+ */
+extern uint32_t VL53LX_SharedWorkArea1[VL53LX_WORK_AREA1_SIZE / sizeof(uint32_t)];
+extern uint32_t VL53LX_SharedWorkArea2[VL53LX_WORK_AREA2_SIZE / sizeof(uint32_t)];
+
+#define VL53LXDevStructGetWorkArea1(Dev) ((uint8_t *)VL53LX_SharedWorkArea1)
+#define VL53LXDevStructGetWorkArea2(Dev) ((uint8_t *)VL53LX_SharedWorkArea2)
+
+
 
 #ifdef __cplusplus
 }
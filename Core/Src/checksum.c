@@ -0,0 +1,30 @@
+/*
+ * checksum.c
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#include "checksum.h"
+
+/* Public function definitions  -----------------------------------------------*/
+
+/* @brief  Fletcher-16 checksum, shared by the EEPROM sensor caches and the
+ *         histogram capture frames
+ * @retval uint16_t - the second sum in the high byte, the first in the low byte
+ */
+/* ======================================================*/
+uint16_t Checksum_Fletcher16(const uint8_t *pData, uint16_t nSize)
+/* ======================================================*/
+{
+	uint16_t nSum1 = 0;
+	uint16_t nSum2 = 0;
+
+	for (uint16_t i = 0; i < nSize; i++)
+	{
+		nSum1 = (nSum1 + pData[i]) % 255;
+		nSum2 = (nSum2 + nSum1) % 255;
+	}
+
+	return (nSum2 << 8) | nSum1;
+}
@@ -11,13 +11,31 @@ static void Service_Help(uint8_t *RxBuff);
 static void Service_StartMeasurement(uint8_t *RxBuff);
 static void Service_GetDistance(uint8_t *RxBuff);
 static void Service_GetStock(uint8_t *RxBuff);
+static void Service_GetHistory(uint8_t *RxBuff);
+static void Service_GetBusStats(uint8_t *RxBuff);
+static void Service_GetDriverProfile(uint8_t *RxBuff);
+static void Service_GetStackUsage(uint8_t *RxBuff);
+static void Service_Record(uint8_t *RxBuff);
+static void Service_CaptureHistograms(uint8_t *RxBuff);
 static void Service_Unknown(uint8_t *RxBuff);
+static TOF_SUPPORTED_SENSORS GetSensorArgument(uint8_t *RxBuff);
+static void PrintRecordedFrames(void);
+
+// Streaming of the measurement records in the replay format (RECD)
+static uint8_t  g_bRecording = 0;
+static uint32_t g_arrRecordCursors[SENSORS_SUPPORTED];
 
 static const char*  UartCommands[] = {
 		"HELP",
 		"STAM",
 		"GETD",
 		"GETS",
+		"HIST",
+		"I2CS",
+		"PROF",
+		"STCK",
+		"RECD",
+		"HCAP",
 		""
 };
 
@@ -27,6 +45,12 @@ static void (*FuncPtr[])(uint8_t *RxData) =
 		&Service_StartMeasurement,
 		&Service_GetDistance,
 		&Service_GetStock,
+		&Service_GetHistory,
+		&Service_GetBusStats,
+		&Service_GetDriverProfile,
+		&Service_GetStackUsage,
+		&Service_Record,
+		&Service_CaptureHistograms,
 		&Service_Unknown
 };
 
@@ -68,6 +92,11 @@ void Console_Exec(void)
 		idx = 0;
 		ConsoleDrv_OnCommandExecuted();
 	}
+
+	if (g_bRecording)
+	{
+		PrintRecordedFrames();
+	}
 }
 
 /* Available commands  */
@@ -77,16 +106,22 @@ void Service_Help(uint8_t *RxBuff)
 {
 	ConsoleDrv_Puts(" Available commands:\r\n");
 	ConsoleDrv_Puts("  - HELP - This information\r\n");
-	ConsoleDrv_Puts("  - STAM - Initiate measurement with ToF sensor\r\n");
-	ConsoleDrv_Puts("  - GETD - Get ToF sensor measurement\r\n");
-	ConsoleDrv_Puts("  - GETS - Get left shelf items\r\n");
+	ConsoleDrv_Puts("  - STAM [n] - Initiate measurement with ToF sensor of shelf n\r\n");
+	ConsoleDrv_Puts("  - GETD [n] - Get ToF sensor measurement of shelf n\r\n");
+	ConsoleDrv_Puts("  - GETS [n] - Get left items of shelf n (all shelves if n is omitted)\r\n");
+	ConsoleDrv_Puts("  - HIST [n] - Get the last measurements of shelf n\r\n");
+	ConsoleDrv_Puts("  - I2CS - Get the I2C statistics of each bus and client\r\n");
+	ConsoleDrv_Puts("  - PROF [R] - Get the ToF driver I2C accesses per entry point (R - reset them)\r\n");
+	ConsoleDrv_Puts("  - STCK [R] - Get the stack high-water mark of each call path (R - reset them)\r\n");
+	ConsoleDrv_Puts("  - RECD - Start/stop streaming the measurements of all shelves in the replay format\r\n");
+	ConsoleDrv_Puts("  - HCAP [n|A] - Stream binary histogram frames of shelf n or all shelves (no argument - stop)\r\n");
 }
 
 /* ======================================================*/
 void Service_StartMeasurement(uint8_t *RxBuff)
 /* ======================================================*/
 {
-	if (ToF_Measure(TOF_CENTRAL) == TOF_STATUS_OK)
+	if (ToF_Measure(GetSensorArgument(RxBuff)) == TOF_STATUS_OK)
 	{
 		ConsoleDrv_Puts("Measuring in process ...");
 	}
@@ -100,21 +135,19 @@ void Service_StartMeasurement(uint8_t *RxBuff)
 void Service_GetDistance(uint8_t *RxBuff)
 /* ======================================================*/
 {
-	VL53LX_MultiRangingData_t* pData = ToF_GetDistance_mm(TOF_CENTRAL);
+	VL53LX_PrimaryRangingData_t* pData = ToF_GetDistance_mm(GetSensorArgument(RxBuff));
 
 	if (pData != NULL)
 	{
 		if (pData->NumberOfObjectsFound)
 		{
-			for (uint8_t i = 0; i < pData->NumberOfObjectsFound; i++)
-			{
-				ConsoleDrv_Puts("\n\r-----------------------\n\r");
-				ConsoleDrv_Printf("status=%d, D=%dmm, Min=%dmm, MAX=%dmm",
-						pData->RangeData[i].RangeStatus,
-						pData->RangeData[i].RangeMilliMeter,
-						pData->RangeData[i].RangeMinMilliMeter,
-						pData->RangeData[i].RangeMaxMilliMeter);
-			}
+			ConsoleDrv_Printf("\n\rMeasured at %dms, objects found: %d", pData->TimeStamp / 1000, pData->NumberOfObjectsFound);
+			ConsoleDrv_Puts("\n\r-----------------------\n\r");
+			ConsoleDrv_Printf("status=%d, D=%dmm, Min=%dmm, MAX=%dmm",
+					pData->RangeData.RangeStatus,
+					pData->RangeData.RangeMilliMeter,
+					pData->RangeData.RangeMinMilliMeter,
+					pData->RangeData.RangeMaxMilliMeter);
 			ConsoleDrv_Puts("\n\r-----------------------\n\r");
 		}
 		else
@@ -132,9 +165,249 @@ void Service_GetDistance(uint8_t *RxBuff)
 void Service_GetStock(uint8_t *RxBuff)
 /* ====================================================== */
 {
-	uint8_t nLeftItems = ToF_GetLeftItems(TOF_CENTRAL);
+	if (ConsoleDrv_GetNextArgument((char *)RxBuff) != NULL)
+	{
+		TOF_SUPPORTED_SENSORS eSensor = GetSensorArgument(RxBuff);
+		TOF_ITEM_WINDOW* pWindow      = ToF_GetItemWindow(eSensor);
+
+		ConsoleDrv_Printf("Left items: %d", ToF_GetLeftItems(eSensor));
+
+		if (pWindow != NULL)
+		{
+			TOF_CADENCE eCadence = ToF_GetCadence(eSensor);
+
+			ConsoleDrv_Printf(", front item window: %d..%dmm raw, %s ranging", pWindow->m_nLow_mm, pWindow->m_nHigh_mm,
+							  (eCadence == TOF_CADENCE_PARKED) ? "parked" : ((eCadence == TOF_CADENCE_SLOW) ? "slow" : "fast"));
+		}
+	}
+	else
+	{
+		for (uint8_t i = 0; i < EEPROM_GetTotalShelvesCount(); i++)
+		{
+			ConsoleDrv_Printf("Shelf %d left items: %d\r\n", i, ToF_GetLeftItems(i));
+		}
+	}
+}
+
+/* ====================================================== */
+void Service_GetHistory(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	TOF_SUPPORTED_SENSORS  eSensor = GetSensorArgument(RxBuff);
+	TOF_MEASUREMENT_RECORD sRecord;
+	uint32_t nCursor = ToF_GetHistoryCount(eSensor);
+
+	nCursor = (nCursor > CONSOLE_HISTORY_RECORDS) ? (nCursor - CONSOLE_HISTORY_RECORDS) : 0;
+
+	if (!ToF_ReadHistory(eSensor, &nCursor, &sRecord))
+	{
+		ConsoleDrv_Puts("There are no measurements!");
+		return;
+	}
+
+	do
+	{
+		ConsoleDrv_Printf("\n\r%dms #%d: status=%d, D=%dmm, sigma=%dmm, signal=%dkcps, ambient=%dkcps",
+				sRecord.m_nTimestamp / 1000,
+				sRecord.m_nStreamCount,
+				sRecord.m_nRangeStatus,
+				sRecord.m_nRange_mm,
+				sRecord.m_nSigma_mm >> 8,
+				(sRecord.m_nSignalRate * 1000) >> 7,
+				(sRecord.m_nAmbientRate * 1000) >> 7);
+	}
+	while (ToF_ReadHistory(eSensor, &nCursor, &sRecord));
+
+	ConsoleDrv_Puts("\n\r");
+}
+
+/* ====================================================== */
+void Service_GetBusStats(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	static const char* arrClientNames[I2C_BUS_CLIENTS_COUNT] = {"ToF", "Expander", "Display"};
+
+	for (uint8_t nBus = 0; nBus < I2C_BUSES_COUNT; nBus++)
+	{
+		if (!I2CBus_IsInitialized(nBus))
+		{
+			continue;
+		}
+
+		for (uint8_t i = 0; i < I2C_BUS_CLIENTS_COUNT; i++)
+		{
+			const I2C_BUS_CLIENT_STATS *pStats = I2CBus_GetStats(nBus, i);
+			uint32_t nAverage_us = pStats->m_nTransactions ? (pStats->m_nTotalLatency_us / pStats->m_nTransactions) : 0;
+
+			if (pStats->m_nTransactions == 0 && pStats->m_nErrors == 0)
+			{
+				continue;
+			}
+
+			ConsoleDrv_Printf("\n\rI2C%d %s: transactions=%u, bytes=%u, errors=%u, latency avg=%uus max=%uus",
+					nBus + 1,
+					arrClientNames[i],
+					pStats->m_nTransactions,
+					pStats->m_nBytes,
+					pStats->m_nErrors,
+					nAverage_us,
+					pStats->m_nMaxLatency_us);
+		}
+	}
+
+	ConsoleDrv_Puts("\n\r");
+}
+
+/* @brief Dump the register accesses recorded for each VL53LX driver call.
+ *        Available when the driver is built with VL53LX_I2C_PROFILER.
+ */
+/* ====================================================== */
+void Service_GetDriverProfile(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	char *pArgument = ConsoleDrv_GetNextArgument((char *)RxBuff);
+
+	if (VL53LX_ProfilerGetEntry(0) == NULL)
+	{
+		ConsoleDrv_Puts("The driver profiler is not enabled!\r\n");
+		return;
+	}
+
+	if (pArgument != NULL && (*pArgument == 'R' || *pArgument == 'r'))
+	{
+		VL53LX_ProfilerReset();
+		ConsoleDrv_Puts("The driver profile is cleared\r\n");
+		return;
+	}
+
+	for (uint32_t i = 0; i < VL53LX_PROFILER_MAX_ENTRIES; i++)
+	{
+		const VL53LX_ProfilerEntry_t *pEntry = VL53LX_ProfilerGetEntry(i);
+
+		if (pEntry == NULL)
+		{
+			break;
+		}
+
+		if (pEntry->transactions == 0 && pEntry->calls == 0)
+		{
+			continue;
+		}
+
+		ConsoleDrv_Printf("\n\r%s: calls=%u, transactions=%u, read=%uB, written=%uB, time avg=%uus max=%uus\n\r  registers:",
+				pEntry->name,
+				pEntry->calls,
+				pEntry->transactions,
+				pEntry->bytes_read,
+				pEntry->bytes_written,
+				pEntry->calls ? (pEntry->total_time_us / pEntry->calls) : 0,
+				pEntry->max_time_us);
+
+		for (uint16_t j = 0; j < pEntry->register_count; j++)
+		{
+			ConsoleDrv_Printf(" 0x%x", pEntry->registers[j]);
+		}
+
+		if (pEntry->registers_dropped)
+		{
+			ConsoleDrv_Printf(" (+%u more)", pEntry->registers_dropped);
+		}
+	}
+
+	ConsoleDrv_Puts("\n\r");
+}
+
+/* @brief Dump the stack high-water marks. The main loop paths are counted
+ *        from the top of RAM, the interrupts from the frame of their handler.
+ */
+/* ====================================================== */
+void Service_GetStackUsage(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	static const char* arrPathNames[STACK_PATHS_COUNT] = {"Console_Exec", "ToF_Exec", "BlueNRG_Process",
+														  "EEPROM_Exec", "SysTick ISR", "I2C ISRs", "DMA ISRs", "EXTI ISRs", "LPUART ISR"};
+	char *pArgument = ConsoleDrv_GetNextArgument((char *)RxBuff);
+
+	if (System_GetStackMonitoredSize() == 0)
+	{
+		ConsoleDrv_Puts("The stack monitor is not enabled!\r\n");
+		return;
+	}
+
+	if (pArgument != NULL && (*pArgument == 'R' || *pArgument == 'r'))
+	{
+		System_ResetStackStats();
+		ConsoleDrv_Puts("The stack high-water marks are cleared\r\n");
+		return;
+	}
+
+	for (uint8_t i = 0; i < STACK_PATHS_COUNT; i++)
+	{
+		ConsoleDrv_Printf("\n\r%s: %d bytes", arrPathNames[i], System_GetStackHighWaterMark(i));
+	}
+
+	ConsoleDrv_Printf("\n\rPeak: %d of %d monitored bytes\n\r", System_GetStackPeak(), System_GetStackMonitoredSize());
+}
+
+/* @brief Start/stop streaming the measurements of all shelves. Each shelf
+ *        is described by a line "S <shelf> <type> <initial stock> <left stock>"
+ *        and each measurement is a line "F <shelf> <timestamp us, hex>
+ *        <status> <range mm> <sigma 8.8> <signal 9.7> <ambient 9.7> <stream count>".
+ *        The captured text is read by Tools/StockReplay.
+ */
+/* ====================================================== */
+void Service_Record(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	if (g_bRecording)
+	{
+		g_bRecording = 0;
+		ConsoleDrv_Puts("\n\r# Recording stopped\n\r");
+		return;
+	}
+
+	ConsoleDrv_Puts("\n\r# Recording started");
+
+	for (uint8_t i = 0; i < EEPROM_GetTotalShelvesCount() && i < SENSORS_SUPPORTED; i++)
+	{
+		ConsoleDrv_Printf("\n\rS %d %d %d %d", i, EEPROM_GetShelfType(i), EEPROM_GetShelfInitialStock(i), EEPROM_GetShelfLeftStock(i));
+		g_arrRecordCursors[i] = ToF_GetHistoryCount(i);
+	}
+
+	g_bRecording = 1;
+}
+
+/* @brief Start/stop the binary histogram capture (see hist_capture.h for the
+ *        frame format). Stopping prints how many frames have been sent and
+ *        dropped.
+ */
+/* ====================================================== */
+void Service_CaptureHistograms(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	char *pArgument = ConsoleDrv_GetNextArgument((char *)RxBuff);
+	const HIST_CAPTURE_STATS *pStats = HistCapture_GetStats();
+
+	if (pArgument == NULL)
+	{
+		HistCapture_Stop();
+		ConsoleDrv_Printf("\n\rHistogram capture stopped: %u frames (%u bytes) sent, %u dropped\n\r",
+				pStats->m_nFrames, pStats->m_nBytes, pStats->m_nDropped);
+		return;
+	}
 
-	ConsoleDrv_Printf("Left items: %d", nLeftItems);
+	if (*pArgument == 'A' || *pArgument == 'a')
+	{
+		HistCapture_Start((1 << SENSORS_SUPPORTED) - 1);
+	}
+	else if (ConsoleDrv_ConvertArgumentToDigit(pArgument) < SENSORS_SUPPORTED)
+	{
+		HistCapture_Start(1 << ConsoleDrv_ConvertArgumentToDigit(pArgument));
+	}
+	else
+	{
+		ConsoleDrv_Puts("Wrong shelf index!\r\n");
+	}
 }
 
 /* ====================================================== */
@@ -143,4 +416,45 @@ void Service_Unknown(uint8_t *RxBuff)
 {
 	ConsoleDrv_Puts(" Unknown Command!\r\n");
 }
+
+/* @brief Get the shelf index passed after the command (e.g. "GETD 2").
+ *        The central sensor is used when no index is given.
+ */
+/* ====================================================== */
+TOF_SUPPORTED_SENSORS GetSensorArgument(uint8_t *RxBuff)
+/* ====================================================== */
+{
+	char *pArgument = ConsoleDrv_GetNextArgument((char *)RxBuff);
+
+	if (pArgument == NULL)
+	{
+		return TOF_CENTRAL;
+	}
+
+	return (TOF_SUPPORTED_SENSORS)ConsoleDrv_ConvertArgumentToDigit(pArgument);
+}
+
+// @brief Print the measurements recorded since the last call (RECD)
+/* ====================================================== */
+void PrintRecordedFrames(void)
+/* ====================================================== */
+{
+	TOF_MEASUREMENT_RECORD sRecord;
+
+	for (uint8_t i = 0; i < EEPROM_GetTotalShelvesCount() && i < SENSORS_SUPPORTED; i++)
+	{
+		while (ToF_ReadHistory(i, &g_arrRecordCursors[i], &sRecord))
+		{
+			ConsoleDrv_Printf("\n\rF %d %x %d %d %d %d %d %d",
+					i,
+					sRecord.m_nTimestamp,
+					sRecord.m_nRangeStatus,
+					sRecord.m_nRange_mm,
+					sRecord.m_nSigma_mm,
+					sRecord.m_nSignalRate,
+					sRecord.m_nAmbientRate,
+					sRecord.m_nStreamCount);
+		}
+	}
+}
 /* ======================================================*/
@@ -116,6 +116,56 @@ void ConsoleDrv_Putc(uint8_t Symbol)
 	}
 }
 
+/* @brief  Queue a block of data for transmission without waiting for room
+ *         in the FIFO - the block is either queued whole or not at all.
+ * @retval uint8_t - 1 if the data is queued
+ */
+/* ======================================================*/
+uint8_t ConsoleDrv_Write(const uint8_t *pData, uint16_t nSize)
+/* ======================================================*/
+{
+	uint32_t nPrimask = __get_PRIMASK();
+	uint16_t nUsed;
+
+	__disable_irq();
+
+	nUsed = g_bFifoFull ? FIFO_SIZE : ((g_nTxFifoPushPointer + FIFO_SIZE - g_nTxFifoPullPointer) % FIFO_SIZE);
+
+	if (nSize == 0 || nSize > (FIFO_SIZE - nUsed))
+	{
+		__set_PRIMASK(nPrimask);
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < nSize; i++)
+	{
+		g_arrTxFifo[g_nTxFifoPushPointer++] = pData[i];
+
+		if (g_nTxFifoPushPointer == FIFO_SIZE)
+			g_nTxFifoPushPointer = 0;
+	}
+
+	if (g_nTxFifoPushPointer == g_nTxFifoPullPointer)
+	{
+		g_bFifoFull = 1;
+	}
+
+	// The transmission continues from the FIFO in HAL_UART_TxCpltCallback
+	if (!g_bUartTxBusy)
+	{
+		HAL_UART_Transmit_IT(&g_UartDrv, (g_arrTxFifo + g_nTxFifoPullPointer++), 1);
+		g_bFifoFull   = 0;
+		g_bUartTxBusy = 1;
+
+		if (g_nTxFifoPullPointer == FIFO_SIZE)
+			g_nTxFifoPullPointer = 0;
+	}
+
+	__set_PRIMASK(nPrimask);
+
+	return 1;
+}
+
 /* ======================================================*/
 void ConsoleDrv_Puts(char *Message)
 /* ======================================================*/
@@ -142,7 +192,7 @@ void ConsoleDrv_Printf(char *Message, ...)
 	va_list arguments;
 	va_start(arguments, Message);
 	int iArg = 0;
-	char iStr[10];
+	char iStr[12];		// "-2147483648"
 	char chArg = 0;
 	char *strArg = 0;
 
@@ -160,13 +210,19 @@ void ConsoleDrv_Printf(char *Message, ...)
 
 			case 'd':
 				iArg = va_arg(arguments, int);
-				sprintf(iStr, "%d", iArg);
+				snprintf(iStr, sizeof(iStr), "%d", iArg);
+				ConsoleDrv_Puts(iStr);
+				break;
+
+			case 'u':
+				iArg = va_arg(arguments, int);
+				snprintf(iStr, sizeof(iStr), "%u", (unsigned int)iArg);
 				ConsoleDrv_Puts(iStr);
 				break;
 
 			case 'x':
 				iArg = va_arg(arguments, int);
-				sprintf(iStr, "%x", iArg);
+				snprintf(iStr, sizeof(iStr), "%x", iArg);
 				ConsoleDrv_Puts(iStr);
 				break;
 
@@ -201,7 +257,7 @@ int ConsoleDrv_GetMessageLength(char *Message)
 }
 
 /* ======================================================*/
-char* ConsoleDrv(char *Message)
+char* ConsoleDrv_GetNextArgument(char *Message)
 /* ======================================================*/
 {
 	char *StrPtr = NULL;
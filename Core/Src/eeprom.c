@@ -29,14 +29,38 @@
  * Shelf n type          - 1 Byte
  * Shelf n initial stock - 1 Byte
  * -------------------------------
+ * Shelf 1 I2C bus       - 1 Byte (0 - I2C1 ... 3 - I2C4)
+ * ......
+ * Shelf 5 I2C bus       - 1 Byte
+ * -------------------------------
+ * Address 256 - 1535 : ToF sensor caches, 256 Bytes per shelf
+ * -------------------------------
+ * Cache Id              - 2 Bytes (0xCACE)
+ * Data size             - 2 Bytes
+ * Sensor UID            - 8 Bytes
+ * Data checksum         - 2 Bytes (Fletcher-16)
+ * Reserved              - 2 Bytes
+ * Data                  - up to 240 Bytes
+ * -------------------------------
  ********************************************************************************/
 
+#include <string.h>
 #include "eeprom.h"
+#include "checksum.h"
+#include "led.h"
+#include "log.h"
 
 
 static EEPROM_SHELF_INFO g_arrShelves[MAX_SHELVES_COUNT];
 static uint8_t           g_nShelvesCount = 0;
 
+// Sensor cache writes, one page per EEPROM_Exec call
+static EEPROM_CACHE_WRITE g_arrCacheWrites[MAX_SHELVES_COUNT];
+// Cleared when a sensor cache write fails - the cache isn't written again until the next boot
+static uint8_t            g_bCacheWritable = 1;
+
+static uint8_t  ReadBlock(uint16_t nAddress, uint8_t *pData, uint16_t nSize);
+
 
 /* @brief  Initialize the EEPROM - setting the low-level driver. */
 // ===========================================================
@@ -68,6 +92,7 @@ void EEPROM_ReadAll()
 				{
 					g_arrShelves[idx].m_eShelfType    = (SHELF_TYPES)arrEepromPage[idx * 4 + 3];
 					g_arrShelves[idx].m_nI2cAddress   = arrEepromPage[idx * 4 + 4];
+					g_arrShelves[idx].m_nI2cBus       = arrEepromPage[SHELF_I2C_BUS_ADDRESS + idx];
 					g_arrShelves[idx].m_nInitialStock = arrEepromPage[idx * 4 + 5];
 					g_arrShelves[idx].m_nLeftStock    = arrEepromPage[idx * 4 + 6];
 				}
@@ -145,6 +170,7 @@ void EEPROM_RegisterNewShelf(EEPROM_SHELF_INFO *pShelf)
 	{
 		g_arrShelves[g_nShelvesCount].m_eShelfType    = pShelf->m_eShelfType;
 		g_arrShelves[g_nShelvesCount].m_nI2cAddress   = pShelf->m_nI2cAddress;
+		g_arrShelves[g_nShelvesCount].m_nI2cBus       = pShelf->m_nI2cBus;
 		g_arrShelves[g_nShelvesCount].m_nInitialStock = pShelf->m_nInitialStock;
 		g_arrShelves[g_nShelvesCount].m_nLeftStock    = pShelf->m_nLeftStock;
 
@@ -155,7 +181,8 @@ void EEPROM_RegisterNewShelf(EEPROM_SHELF_INFO *pShelf)
 		arrShelfData[2] = g_arrShelves[g_nShelvesCount].m_nInitialStock;
 		arrShelfData[3] = g_arrShelves[g_nShelvesCount].m_nLeftStock;
 
-		if (M95640_WritePage((g_nShelvesCount * 4 + 3), arrShelfData, 4) == M95640_OK)
+		if (M95640_WritePage((g_nShelvesCount * 4 + 3), arrShelfData, 4) == M95640_OK &&
+			M95640_WritePage(SHELF_I2C_BUS_ADDRESS + g_nShelvesCount, &g_arrShelves[g_nShelvesCount].m_nI2cBus, 1) == M95640_OK)
 		{
 			// Shelf written successfully!
 			g_nShelvesCount++;
@@ -204,3 +231,191 @@ uint8_t EEPROM_GetTotalShelvesCount()
 	return g_nShelvesCount;
 }
 // ===========================================================
+
+/* @brief  Read the cached data of the ToF sensor of a shelf
+ * @param  nUid - UID of the sensor, the cache is used only if it matches
+ * @retval uint8_t - 1 if pData has been filled with a valid copy, 0 otherwise
+ */
+// ===========================================================
+uint8_t EEPROM_ReadSensorCache(uint8_t nIndex, uint64_t nUid, uint8_t *pData, uint16_t nSize)
+// ===========================================================
+{
+	uint8_t  arrHeader[SENSOR_CACHE_HEADER_SIZE];
+	uint16_t nAddress = SENSOR_CACHE_STARTING_ADDRESS + nIndex * SENSOR_CACHE_SLOT_SIZE;
+	uint64_t nCachedUid = 0;
+
+	// A cache which is being written is not valid yet
+	if (nIndex >= MAX_SHELVES_COUNT || nSize > (SENSOR_CACHE_SLOT_SIZE - SENSOR_CACHE_HEADER_SIZE) ||
+		g_arrCacheWrites[nIndex].m_bPending)
+	{
+		return 0;
+	}
+
+	if (!ReadBlock(nAddress, arrHeader, SENSOR_CACHE_HEADER_SIZE) ||
+		arrHeader[0] != 0xCA || arrHeader[1] != 0xCE ||
+		(arrHeader[2] | (arrHeader[3] << 8)) != nSize)
+	{
+		return 0;
+	}
+
+	for (uint8_t idx = 0; idx < 8; idx++)
+	{
+		nCachedUid |= (uint64_t)arrHeader[idx + 4] << (idx * 8);
+	}
+
+	// The sensor has been replaced - the cache belongs to another one
+	if (nCachedUid != nUid)
+	{
+		return 0;
+	}
+
+	if (!ReadBlock(nAddress + SENSOR_CACHE_HEADER_SIZE, pData, nSize))
+	{
+		return 0;
+	}
+
+	return (Checksum_Fletcher16(pData, nSize) == (arrHeader[12] | (arrHeader[13] << 8)));
+}
+
+/* @brief  Queue the data of the ToF sensor of a shelf for its cache. The data
+ *         is copied and written by EEPROM_Exec, one page per call.
+ * @retval uint8_t - 1 if the write has been queued, 0 otherwise
+ */
+// ===========================================================
+uint8_t EEPROM_WriteSensorCache(uint8_t nIndex, uint64_t nUid, uint8_t *pData, uint16_t nSize)
+// ===========================================================
+{
+	EEPROM_CACHE_WRITE *pWrite;
+	uint16_t            nChecksum = Checksum_Fletcher16(pData, nSize);
+
+	if (nIndex >= MAX_SHELVES_COUNT || nSize == 0 || nSize > (SENSOR_CACHE_SLOT_SIZE - SENSOR_CACHE_HEADER_SIZE) ||
+		!g_bCacheWritable)
+	{
+		return 0;
+	}
+
+	pWrite = &g_arrCacheWrites[nIndex];
+
+	pWrite->m_arrData[0] = 0xCA;
+	pWrite->m_arrData[1] = 0xCE;
+	pWrite->m_arrData[2] = (uint8_t)nSize;
+	pWrite->m_arrData[3] = (uint8_t)(nSize >> 8);
+
+	for (uint8_t idx = 0; idx < 8; idx++)
+	{
+		pWrite->m_arrData[idx + 4] = (uint8_t)(nUid >> (idx * 8));
+	}
+
+	pWrite->m_arrData[12] = (uint8_t)nChecksum;
+	pWrite->m_arrData[13] = (uint8_t)(nChecksum >> 8);
+	pWrite->m_arrData[14] = 0xFF;
+	pWrite->m_arrData[15] = 0xFF;
+
+	memcpy(&pWrite->m_arrData[SENSOR_CACHE_HEADER_SIZE], pData, nSize);
+
+	/* The data goes first, so an interrupted write leaves a header which
+	 * doesn't match the data and the cache is not used.
+	 */
+	pWrite->m_nNext    = SENSOR_CACHE_HEADER_SIZE;
+	pWrite->m_nEnd     = SENSOR_CACHE_HEADER_SIZE + nSize;
+	pWrite->m_bPending = 1;
+
+	return 1;
+}
+
+/* @brief  This function is called in the main loop. It writes one page of the
+ *         pending sensor cache writes, so the loop is stalled for a single page
+ *         write (about 12 ms) instead of a whole cache. A failed write is an
+ *         EEPROM error (red LED) - the pending writes are dropped and the cache
+ *         is not written again until the next boot.
+ */
+// ===========================================================
+void EEPROM_Exec()
+// ===========================================================
+{
+	for (uint8_t i = 0; i < MAX_SHELVES_COUNT; i++)
+	{
+		EEPROM_CACHE_WRITE *pWrite = &g_arrCacheWrites[i];
+
+		if (!pWrite->m_bPending)
+		{
+			continue;
+		}
+
+		uint16_t      nAddress = SENSOR_CACHE_STARTING_ADDRESS + i * SENSOR_CACHE_SLOT_SIZE + pWrite->m_nNext;
+		uint16_t      nChunk   = M95640_PAGE_SIZE_BYTES - (nAddress % M95640_PAGE_SIZE_BYTES);
+		M95640_STATUS eStatus;
+
+		if (nChunk > (pWrite->m_nEnd - pWrite->m_nNext))
+		{
+			nChunk = pWrite->m_nEnd - pWrite->m_nNext;
+		}
+
+		eStatus = M95640_WritePage(nAddress, &pWrite->m_arrData[pWrite->m_nNext], nChunk);
+
+		// The BLE module is using the SPI - the page is written on the next call
+		if (eStatus == M95640_ERROR_SPI_BUSY)
+		{
+			return;
+		}
+
+		if (eStatus != M95640_OK)
+		{
+			g_bCacheWritable = 0;
+
+			for (uint8_t idx = 0; idx < MAX_SHELVES_COUNT; idx++)
+			{
+				g_arrCacheWrites[idx].m_bPending = 0;
+			}
+
+			LEDs_SetLEDState(RED_LED, LED_ON);
+			Log_SetLogType(LOG_TYPE_ERROR);
+			Log_SetLogError(ERROR_EEPROM);
+			return;
+		}
+
+		pWrite->m_nNext += nChunk;
+
+		if (pWrite->m_nNext == pWrite->m_nEnd)
+		{
+			if (pWrite->m_nEnd == SENSOR_CACHE_HEADER_SIZE)
+			{
+				pWrite->m_bPending = 0;
+			}
+			else
+			{
+				pWrite->m_nNext = 0;
+				pWrite->m_nEnd  = SENSOR_CACHE_HEADER_SIZE;
+			}
+		}
+
+		return;
+	}
+}
+
+// @brief  Read a block of data which could span several EEPROM pages
+// ===========================================================
+static uint8_t ReadBlock(uint16_t nAddress, uint8_t *pData, uint16_t nSize)
+// ===========================================================
+{
+	while (nSize > 0)
+	{
+		uint16_t nChunk = M95640_PAGE_SIZE_BYTES - (nAddress % M95640_PAGE_SIZE_BYTES);
+
+		if (nChunk > nSize)
+		{
+			nChunk = nSize;
+		}
+
+		if (M95640_ReadPage(nAddress, pData, nChunk) != M95640_OK)
+		{
+			return 0;
+		}
+
+		nAddress += nChunk;
+		pData    += nChunk;
+		nSize    -= nChunk;
+	}
+
+	return 1;
+}
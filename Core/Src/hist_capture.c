@@ -0,0 +1,209 @@
+/*
+ * hist_capture.c
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#include "hist_capture.h"
+#include "console_drv.h"
+#include "checksum.h"
+
+/* Private data  ---------------------------------------------------------*/
+
+static uint8_t            g_nHistCaptureMask = 0;
+static uint32_t           g_nHistCaptureSequence;
+static HIST_CAPTURE_STATS g_sHistCaptureStats;
+static uint8_t            g_arrHistCaptureFrame[HIST_CAPTURE_FRAME_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint8_t* PutU8(uint8_t *pBuffer, uint8_t nValue);
+static uint8_t* PutU16(uint8_t *pBuffer, uint16_t nValue);
+static uint8_t* PutU24(uint8_t *pBuffer, uint32_t nValue);
+static uint8_t* PutU32(uint8_t *pBuffer, uint32_t nValue);
+
+/* Public function definitions  -----------------------------------------------*/
+
+/* @brief Start capturing the sensors of the mask (bit n - shelf n). The
+ *        statistics and the sequence start over.
+ */
+/* ======================================================*/
+void HistCapture_Start(uint8_t nSensorMask)
+/* ======================================================*/
+{
+	g_nHistCaptureSequence         = 0;
+	g_sHistCaptureStats.m_nFrames  = 0;
+	g_sHistCaptureStats.m_nDropped = 0;
+	g_sHistCaptureStats.m_nBytes   = 0;
+	g_nHistCaptureMask             = nSensorMask;
+}
+
+/* ======================================================*/
+void HistCapture_Stop(void)
+/* ======================================================*/
+{
+	g_nHistCaptureMask = 0;
+}
+
+/* ======================================================*/
+uint8_t HistCapture_IsEnabled(uint8_t nSensor)
+/* ======================================================*/
+{
+	return (nSensor < 8) && (g_nHistCaptureMask & (1 << nSensor));
+}
+
+/* @brief Serialize the histogram and the range results of a measurement and
+ *        queue the frame on the console UART. The frame is dropped when the
+ *        UART is behind.
+ */
+/* ======================================================*/
+void HistCapture_Frame(uint8_t nSensor, uint32_t nTimestamp, const VL53LX_histogram_bin_data_t *pHistogram, const VL53LX_range_results_t *pResults)
+/* ======================================================*/
+{
+	uint8_t *pBuffer = g_arrHistCaptureFrame + HIST_CAPTURE_HEADER_SIZE;
+	uint8_t  nBins   = pHistogram->VL53LX_p_021;
+	uint8_t  nTargets;
+	uint16_t nPayloadSize;
+	uint16_t nFrameSize;
+
+	if (!HistCapture_IsEnabled(nSensor))
+	{
+		return;
+	}
+
+	if (nBins > VL53LX_HISTOGRAM_BUFFER_SIZE)
+	{
+		nBins = VL53LX_HISTOGRAM_BUFFER_SIZE;
+	}
+
+	nTargets = (pResults->active_results < VL53LX_MAX_RANGE_RESULTS) ? pResults->active_results : VL53LX_MAX_RANGE_RESULTS;
+
+	// Histogram
+	pBuffer = PutU8(pBuffer, pHistogram->result__stream_count);
+	pBuffer = PutU8(pBuffer, pHistogram->result__range_status);
+	pBuffer = PutU8(pBuffer, pHistogram->VL53LX_p_019);
+	pBuffer = PutU8(pBuffer, nBins);
+	pBuffer = PutU8(pBuffer, pHistogram->number_of_ambient_bins);
+	pBuffer = PutU8(pBuffer, pHistogram->VL53LX_p_005);
+	pBuffer = PutU8(pBuffer, pHistogram->phasecal_result__vcsel_start);
+
+	for (uint8_t i = 0; i < VL53LX_MAX_BIN_SEQUENCE_LENGTH; i++)
+	{
+		pBuffer = PutU8(pBuffer, pHistogram->bin_seq[i]);
+	}
+	for (uint8_t i = 0; i < VL53LX_MAX_BIN_SEQUENCE_LENGTH; i++)
+	{
+		pBuffer = PutU8(pBuffer, pHistogram->bin_rep[i]);
+	}
+
+	pBuffer = PutU16(pBuffer, pHistogram->vcsel_width);
+	pBuffer = PutU16(pBuffer, pHistogram->VL53LX_p_015);
+	pBuffer = PutU16(pBuffer, pHistogram->zero_distance_phase);
+	pBuffer = PutU16(pBuffer, pHistogram->phasecal_result__reference_phase);
+	pBuffer = PutU16(pBuffer, pHistogram->result__dss_actual_effective_spads);
+	pBuffer = PutU32(pBuffer, pHistogram->total_periods_elapsed);
+	pBuffer = PutU32(pBuffer, pHistogram->peak_duration_us);
+	pBuffer = PutU32(pBuffer, pHistogram->woi_duration_us);
+
+	// The sensor reports 24-bit bins
+	for (uint8_t i = 0; i < nBins; i++)
+	{
+		pBuffer = PutU24(pBuffer, (uint32_t)pHistogram->bin_data[i]);
+	}
+
+	// Range results
+	pBuffer = PutU8(pBuffer, pResults->stream_count);
+	pBuffer = PutU8(pBuffer, pResults->device_status);
+	pBuffer = PutU8(pBuffer, nTargets);
+	pBuffer = PutU16(pBuffer, (uint16_t)pResults->wrap_dmax_mm);
+
+	for (uint8_t i = 0; i < nTargets; i++)
+	{
+		const VL53LX_range_data_t *pTarget = &pResults->VL53LX_p_003[i];
+
+		pBuffer = PutU16(pBuffer, (uint16_t)pTarget->median_range_mm);
+		pBuffer = PutU16(pBuffer, (uint16_t)pTarget->min_range_mm);
+		pBuffer = PutU16(pBuffer, (uint16_t)pTarget->max_range_mm);
+		pBuffer = PutU8(pBuffer, pTarget->range_status);
+		pBuffer = PutU16(pBuffer, pTarget->VL53LX_p_002);
+		pBuffer = PutU16(pBuffer, pTarget->peak_signal_count_rate_mcps);
+		pBuffer = PutU16(pBuffer, pTarget->ambient_count_rate_mcps);
+	}
+
+	nPayloadSize = pBuffer - (g_arrHistCaptureFrame + HIST_CAPTURE_HEADER_SIZE);
+
+	// Header
+	pBuffer = g_arrHistCaptureFrame;
+	pBuffer = PutU8(pBuffer, HIST_CAPTURE_SYNC_0);
+	pBuffer = PutU8(pBuffer, HIST_CAPTURE_SYNC_1);
+	pBuffer = PutU8(pBuffer, HIST_CAPTURE_VERSION);
+	pBuffer = PutU8(pBuffer, nSensor);
+	pBuffer = PutU16(pBuffer, nPayloadSize);
+	pBuffer = PutU16(pBuffer, (uint16_t)g_sHistCaptureStats.m_nDropped);
+	pBuffer = PutU32(pBuffer, g_nHistCaptureSequence++);
+	pBuffer = PutU32(pBuffer, nTimestamp);
+
+	nFrameSize = HIST_CAPTURE_HEADER_SIZE + nPayloadSize;
+	PutU16(g_arrHistCaptureFrame + nFrameSize, Checksum_Fletcher16(g_arrHistCaptureFrame, nFrameSize));
+	nFrameSize += 2;
+
+	if (ConsoleDrv_Write(g_arrHistCaptureFrame, nFrameSize))
+	{
+		g_sHistCaptureStats.m_nFrames++;
+		g_sHistCaptureStats.m_nBytes += nFrameSize;
+	}
+	else
+	{
+		g_sHistCaptureStats.m_nDropped++;
+	}
+}
+
+// @brief Get the sent/dropped frames since the start of the capture
+/* ======================================================*/
+const HIST_CAPTURE_STATS* HistCapture_GetStats(void)
+/* ======================================================*/
+{
+	return &g_sHistCaptureStats;
+}
+
+/* Private function definitions  -----------------------------------------------*/
+
+/* ======================================================*/
+static uint8_t* PutU8(uint8_t *pBuffer, uint8_t nValue)
+/* ======================================================*/
+{
+	*pBuffer++ = nValue;
+
+	return pBuffer;
+}
+
+/* ======================================================*/
+static uint8_t* PutU16(uint8_t *pBuffer, uint16_t nValue)
+/* ======================================================*/
+{
+	*pBuffer++ = (uint8_t)nValue;
+	*pBuffer++ = (uint8_t)(nValue >> 8);
+
+	return pBuffer;
+}
+
+/* ======================================================*/
+static uint8_t* PutU24(uint8_t *pBuffer, uint32_t nValue)
+/* ======================================================*/
+{
+	*pBuffer++ = (uint8_t)nValue;
+	*pBuffer++ = (uint8_t)(nValue >> 8);
+	*pBuffer++ = (uint8_t)(nValue >> 16);
+
+	return pBuffer;
+}
+
+/* ======================================================*/
+static uint8_t* PutU32(uint8_t *pBuffer, uint32_t nValue)
+/* ======================================================*/
+{
+	pBuffer = PutU16(pBuffer, (uint16_t)nValue);
+
+	return PutU16(pBuffer, (uint16_t)(nValue >> 16));
+}
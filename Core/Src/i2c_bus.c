@@ -0,0 +1,609 @@
+/*
+ * i2c_bus.c
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#include <string.h>
+#include "i2c_bus.h"
+
+/* The ToF sensors can be spread over I2C1-I2C4 (see the shelf table), each
+ * controller with its own DMA channels, so the histogram readouts of sensors
+ * on different buses run in parallel. I2C1 is also shared by the GPIO
+ * expanders and the 7-segment display of the X-NUCLEO-53L3A2.
+ * The bus manager owns the controllers and on each of them arbitrates
+ * between the clients at transaction boundaries:
+ *  - non-blocking (DMA) transactions are queued and granted by priority,
+ *  - blocking transfers are done between I2CBus_Acquire/I2CBus_Release,
+ *  - a started transaction or transfer always runs to its end, the priority
+ *    only decides who gets the bus next.
+ */
+
+#define I2C_BUS_NO_OWNER   (-1)
+#define I2C_BUS_NO_WAITING (-1)
+
+typedef struct {
+	I2C_TypeDef         *m_pInstance;
+	DMA_Channel_TypeDef *m_pDmaRxChannel;
+	uint32_t             m_nDmaRxRequest;
+	IRQn_Type            m_eDmaRxIRQ;
+	DMA_Channel_TypeDef *m_pDmaTxChannel;
+	uint32_t             m_nDmaTxRequest;
+	IRQn_Type            m_eDmaTxIRQ;
+}I2C_BUS_HW_CONFIG;
+
+typedef struct {
+	I2C_HandleTypeDef    m_hI2C;
+	DMA_HandleTypeDef    m_hDmaRx;
+	DMA_HandleTypeDef    m_hDmaTx;
+	uint8_t              m_bInitialized;
+
+	I2C_BUS_TRANSACTION* m_arrQueue[I2C_BUS_QUEUE_SIZE];
+	volatile uint8_t     m_nQueued;
+
+	I2C_BUS_TRANSACTION* volatile m_pActive;
+	volatile int8_t      m_nOwner;
+	volatile int8_t      m_nWaitPriority;
+
+	I2C_BUS_CLIENT_STATS m_arrStats[I2C_BUS_CLIENTS_COUNT];
+}I2C_BUS_CONTEXT;
+
+/* Private data  ---------------------------------------------------------*/
+static const I2C_BUS_HW_CONFIG g_arrI2CBusConfig[I2C_BUSES_COUNT] = {
+		{I2C1, DMA1_Channel1, DMA_REQUEST_I2C1_RX, DMA1_Channel1_IRQn, DMA1_Channel2, DMA_REQUEST_I2C1_TX, DMA1_Channel2_IRQn},
+		{I2C2, DMA1_Channel3, DMA_REQUEST_I2C2_RX, DMA1_Channel3_IRQn, DMA1_Channel4, DMA_REQUEST_I2C2_TX, DMA1_Channel4_IRQn},
+		{I2C3, DMA1_Channel5, DMA_REQUEST_I2C3_RX, DMA1_Channel5_IRQn, DMA1_Channel6, DMA_REQUEST_I2C3_TX, DMA1_Channel6_IRQn},
+		{I2C4, DMA1_Channel7, DMA_REQUEST_I2C4_RX, DMA1_Channel7_IRQn, DMA1_Channel8, DMA_REQUEST_I2C4_TX, DMA1_Channel8_IRQn}};
+
+static I2C_BUS_CONTEXT g_arrI2CBuses[I2C_BUSES_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static void I2C_Init(I2C_BUS_ID eBus);
+static void DMA_Init(I2C_BUS_ID eBus);
+static I2C_BUS_CONTEXT* GetBusContext(I2C_HandleTypeDef *hi2c);
+static int8_t GetHighestQueuedPriority(I2C_BUS_CONTEXT *pBus);
+static void StartNext(I2C_BUS_CONTEXT *pBus);
+static void StartTransfer(I2C_BUS_CONTEXT *pBus, I2C_BUS_TRANSACTION *pTransaction);
+static void OnTransferComplete(I2C_BUS_CONTEXT *pBus, uint8_t bError);
+static void UpdateLatency(I2C_BUS_CLIENT_STATS *pStats, uint32_t nRequestTimestamp);
+
+/* Exported functions definitions ---------------------------------------------*/
+/* @brief Initialize the selected I2C controller and its DMA channels.
+ *        Every client calls it, the peripheral is initialized only once.
+ */
+/* ======================================================*/
+void I2CBus_Init(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	I2C_BUS_CONTEXT *pBus;
+
+	if (eBus >= I2C_BUSES_COUNT || g_arrI2CBuses[eBus].m_bInitialized)
+	{
+		return;
+	}
+
+	pBus                  = &g_arrI2CBuses[eBus];
+	pBus->m_nQueued       = 0;
+	pBus->m_pActive       = nullptr;
+	pBus->m_nOwner        = I2C_BUS_NO_OWNER;
+	pBus->m_nWaitPriority = I2C_BUS_NO_WAITING;
+
+	I2C_Init(eBus);
+	DMA_Init(eBus);
+	pBus->m_bInitialized = 1;
+}
+
+/* ======================================================*/
+uint8_t I2CBus_IsInitialized(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	return (eBus < I2C_BUSES_COUNT) ? g_arrI2CBuses[eBus].m_bInitialized : 0;
+}
+
+/* @brief  Queue a non-blocking transaction on its bus. It is started right away if the bus is free.
+ * @retval I2C_BUS_STATUS - I2C_BUS_STATUS_BUSY if the queue is full
+ */
+/* ======================================================*/
+I2C_BUS_STATUS I2CBus_Submit(I2C_BUS_TRANSACTION *pTransaction)
+/* ======================================================*/
+{
+	I2C_BUS_CONTEXT *pBus;
+	uint32_t nPrimask;
+
+	if (pTransaction == nullptr || pTransaction->m_nSize == 0 || pTransaction->m_eClient >= I2C_BUS_CLIENTS_COUNT ||
+		!I2CBus_IsInitialized(pTransaction->m_eBus) ||
+		pTransaction->m_eState == I2C_TRANSACTION_QUEUED || pTransaction->m_eState == I2C_TRANSACTION_ACTIVE)
+	{
+		return I2C_BUS_STATUS_ERROR;
+	}
+
+	pBus = &g_arrI2CBuses[pTransaction->m_eBus];
+
+	pTransaction->m_nRequestTimestamp = System_GetMicros();
+
+	nPrimask = __get_PRIMASK();
+	__disable_irq();
+	if (pBus->m_nQueued >= I2C_BUS_QUEUE_SIZE)
+	{
+		__set_PRIMASK(nPrimask);
+		return I2C_BUS_STATUS_BUSY;
+	}
+	pTransaction->m_eState              = I2C_TRANSACTION_QUEUED;
+	pBus->m_arrQueue[pBus->m_nQueued++] = pTransaction;
+	__set_PRIMASK(nPrimask);
+
+	StartNext(pBus);
+
+	return I2C_BUS_STATUS_OK;
+}
+
+/* @brief  Get exclusive access to the bus for blocking transfers.
+ *         The transfer in progress is completed first, as well as the queued
+ *         transactions with the same or higher priority. The queued ones with
+ *         lower priority wait until the bus is released.
+ * @retval I2C_BUS_STATUS - I2C_BUS_STATUS_BUSY if the bus has not been granted in time
+ */
+/* ======================================================*/
+I2C_BUS_STATUS I2CBus_Acquire(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient, I2C_BUS_PRIORITY ePriority)
+/* ======================================================*/
+{
+	uint32_t nRequestTimestamp = System_GetMicros();
+	uint32_t nStart            = HAL_GetTick();
+	uint32_t nPrimask;
+	I2C_BUS_CONTEXT *pBus;
+
+	if (eClient >= I2C_BUS_CLIENTS_COUNT || !I2CBus_IsInitialized(eBus))
+	{
+		return I2C_BUS_STATUS_ERROR;
+	}
+
+	pBus                  = &g_arrI2CBuses[eBus];
+	pBus->m_nWaitPriority = ePriority;
+
+	while (1)
+	{
+		nPrimask = __get_PRIMASK();
+		__disable_irq();
+		if (pBus->m_pActive == nullptr && pBus->m_nOwner == I2C_BUS_NO_OWNER &&
+			GetHighestQueuedPriority(pBus) < (int8_t)ePriority)
+		{
+			pBus->m_nOwner        = eClient;
+			pBus->m_nWaitPriority = I2C_BUS_NO_WAITING;
+			__set_PRIMASK(nPrimask);
+			break;
+		}
+		__set_PRIMASK(nPrimask);
+
+		if ((HAL_GetTick() - nStart) > I2C_BUS_ACQUIRE_TIMEOUT_MS)
+		{
+			pBus->m_nWaitPriority = I2C_BUS_NO_WAITING;
+			pBus->m_arrStats[eClient].m_nErrors++;
+			StartNext(pBus);
+			return I2C_BUS_STATUS_BUSY;
+		}
+	}
+
+	pBus->m_arrStats[eClient].m_nTransactions++;
+	UpdateLatency(&pBus->m_arrStats[eClient], nRequestTimestamp);
+
+	return I2C_BUS_STATUS_OK;
+}
+
+/* @brief Release the bus acquired by I2CBus_Acquire and start the next queued transaction */
+/* ======================================================*/
+void I2CBus_Release(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient)
+/* ======================================================*/
+{
+	if (eBus >= I2C_BUSES_COUNT || g_arrI2CBuses[eBus].m_nOwner != (int8_t)eClient)
+	{
+		return;
+	}
+
+	g_arrI2CBuses[eBus].m_nOwner = I2C_BUS_NO_OWNER;
+	StartNext(&g_arrI2CBuses[eBus]);
+}
+
+/* @brief Blocking transmit, the bus has to be acquired by the client */
+/* ======================================================*/
+HAL_StatusTypeDef I2CBus_Transmit(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient, uint16_t nDevAddr, uint8_t *pData, uint16_t nSize, uint32_t nTimeout)
+/* ======================================================*/
+{
+	HAL_StatusTypeDef eStatus;
+	I2C_BUS_CONTEXT *pBus;
+
+	if (eBus >= I2C_BUSES_COUNT || eClient >= I2C_BUS_CLIENTS_COUNT || g_arrI2CBuses[eBus].m_nOwner != (int8_t)eClient)
+	{
+		return HAL_BUSY;
+	}
+
+	pBus    = &g_arrI2CBuses[eBus];
+	eStatus = HAL_I2C_Master_Transmit(&pBus->m_hI2C, nDevAddr, pData, nSize, nTimeout);
+
+	if (eStatus == HAL_OK)
+	{
+		pBus->m_arrStats[eClient].m_nBytes += nSize;
+	}
+	else
+	{
+		pBus->m_arrStats[eClient].m_nErrors++;
+	}
+
+	return eStatus;
+}
+
+/* @brief Blocking receive, the bus has to be acquired by the client */
+/* ======================================================*/
+HAL_StatusTypeDef I2CBus_Receive(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient, uint16_t nDevAddr, uint8_t *pData, uint16_t nSize, uint32_t nTimeout)
+/* ======================================================*/
+{
+	HAL_StatusTypeDef eStatus;
+	I2C_BUS_CONTEXT *pBus;
+
+	if (eBus >= I2C_BUSES_COUNT || eClient >= I2C_BUS_CLIENTS_COUNT || g_arrI2CBuses[eBus].m_nOwner != (int8_t)eClient)
+	{
+		return HAL_BUSY;
+	}
+
+	pBus    = &g_arrI2CBuses[eBus];
+	eStatus = HAL_I2C_Master_Receive(&pBus->m_hI2C, nDevAddr, pData, nSize, nTimeout);
+
+	if (eStatus == HAL_OK)
+	{
+		pBus->m_arrStats[eClient].m_nBytes += nSize;
+	}
+	else
+	{
+		pBus->m_arrStats[eClient].m_nErrors++;
+	}
+
+	return eStatus;
+}
+
+/* @brief  Check whether a client with the given priority would get the bus
+ *         right away - it is free and nothing of the same or higher priority
+ *         is queued.
+ * @retval uint8_t - 1 if the bus is available
+ */
+/* ======================================================*/
+uint8_t I2CBus_IsAvailable(I2C_BUS_ID eBus, I2C_BUS_PRIORITY ePriority)
+/* ======================================================*/
+{
+	uint8_t  bAvailable;
+	uint32_t nPrimask;
+	I2C_BUS_CONTEXT *pBus;
+
+	if (!I2CBus_IsInitialized(eBus))
+	{
+		return 0;
+	}
+
+	pBus     = &g_arrI2CBuses[eBus];
+	nPrimask = __get_PRIMASK();
+	__disable_irq();
+	bAvailable = (pBus->m_nOwner == I2C_BUS_NO_OWNER) && (pBus->m_pActive == nullptr) &&
+				 (GetHighestQueuedPriority(pBus) < (int8_t)ePriority);
+	__set_PRIMASK(nPrimask);
+
+	return bAvailable;
+}
+
+/* ======================================================*/
+const I2C_BUS_CLIENT_STATS* I2CBus_GetStats(I2C_BUS_ID eBus, I2C_BUS_CLIENT eClient)
+/* ======================================================*/
+{
+	const I2C_BUS_CLIENT_STATS *pStats = nullptr;
+
+	if (eBus < I2C_BUSES_COUNT && eClient < I2C_BUS_CLIENTS_COUNT)
+	{
+		pStats = &g_arrI2CBuses[eBus].m_arrStats[eClient];
+	}
+
+	return pStats;
+}
+
+/* ======================================================*/
+void I2CBus_ResetStats(void)
+/* ======================================================*/
+{
+	uint32_t nPrimask = __get_PRIMASK();
+
+	__disable_irq();
+	for (uint8_t i = 0; i < I2C_BUSES_COUNT; i++)
+	{
+		memset(g_arrI2CBuses[i].m_arrStats, 0, sizeof(g_arrI2CBuses[i].m_arrStats));
+	}
+	__set_PRIMASK(nPrimask);
+}
+
+/* ======================================================*/
+I2C_HandleTypeDef* I2CBus_GetHandle(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	return (eBus < I2C_BUSES_COUNT) ? &g_arrI2CBuses[eBus].m_hI2C : nullptr;
+}
+
+/* ======================================================*/
+DMA_HandleTypeDef* I2CBus_GetDmaRxHandle(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	return (eBus < I2C_BUSES_COUNT) ? &g_arrI2CBuses[eBus].m_hDmaRx : nullptr;
+}
+
+/* ======================================================*/
+DMA_HandleTypeDef* I2CBus_GetDmaTxHandle(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	return (eBus < I2C_BUSES_COUNT) ? &g_arrI2CBuses[eBus].m_hDmaTx : nullptr;
+}
+
+
+/* Private function definitions  -----------------------------------------------*/
+/**
+ * @brief I2C Initialization Function
+ * @param eBus - the I2C controller
+ * @retval None
+ */
+/* ======================================================*/
+static void I2C_Init(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	I2C_HandleTypeDef *pI2C = &g_arrI2CBuses[eBus].m_hI2C;
+
+	pI2C->Instance = g_arrI2CBusConfig[eBus].m_pInstance;
+	pI2C->Init.Timing = 0x2050133E;
+	pI2C->Init.OwnAddress1 = 0;
+	pI2C->Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+	pI2C->Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+	pI2C->Init.OwnAddress2 = 0;
+	pI2C->Init.OwnAddress2Masks = I2C_OA2_NOMASK;
+	pI2C->Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+	pI2C->Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+
+	if (HAL_I2C_Init(pI2C) != HAL_OK)
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
+	/** Configure Analogue filter
+	 */
+	if (HAL_I2CEx_ConfigAnalogFilter(pI2C, I2C_ANALOGFILTER_ENABLE) != HAL_OK)
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
+
+	if (HAL_I2CEx_ConfigDigitalFilter(pI2C, 0) != HAL_OK)
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
+}
+
+/* @brief DMA channels of the selected I2C controller, used by the non-blocking transactions */
+/* ======================================================*/
+static void DMA_Init(I2C_BUS_ID eBus)
+/* ======================================================*/
+{
+	const I2C_BUS_HW_CONFIG *pConfig = &g_arrI2CBusConfig[eBus];
+	I2C_BUS_CONTEXT         *pBus    = &g_arrI2CBuses[eBus];
+
+	__HAL_RCC_DMAMUX1_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	pBus->m_hDmaRx.Instance                 = pConfig->m_pDmaRxChannel;
+	pBus->m_hDmaRx.Init.Request             = pConfig->m_nDmaRxRequest;
+	pBus->m_hDmaRx.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+	pBus->m_hDmaRx.Init.PeriphInc           = DMA_PINC_DISABLE;
+	pBus->m_hDmaRx.Init.MemInc              = DMA_MINC_ENABLE;
+	pBus->m_hDmaRx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	pBus->m_hDmaRx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+	pBus->m_hDmaRx.Init.Mode                = DMA_NORMAL;
+	pBus->m_hDmaRx.Init.Priority            = DMA_PRIORITY_LOW;
+
+	if (HAL_DMA_Init(&pBus->m_hDmaRx) != HAL_OK)
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
+	__HAL_LINKDMA(&pBus->m_hI2C, hdmarx, pBus->m_hDmaRx);
+
+	pBus->m_hDmaTx.Instance                 = pConfig->m_pDmaTxChannel;
+	pBus->m_hDmaTx.Init.Request             = pConfig->m_nDmaTxRequest;
+	pBus->m_hDmaTx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+	pBus->m_hDmaTx.Init.PeriphInc           = DMA_PINC_DISABLE;
+	pBus->m_hDmaTx.Init.MemInc              = DMA_MINC_ENABLE;
+	pBus->m_hDmaTx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	pBus->m_hDmaTx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+	pBus->m_hDmaTx.Init.Mode                = DMA_NORMAL;
+	pBus->m_hDmaTx.Init.Priority            = DMA_PRIORITY_LOW;
+
+	if (HAL_DMA_Init(&pBus->m_hDmaTx) != HAL_OK)
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
+	__HAL_LINKDMA(&pBus->m_hI2C, hdmatx, pBus->m_hDmaTx);
+
+	HAL_NVIC_SetPriority(pConfig->m_eDmaRxIRQ, I2C_BUS_DMA_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(pConfig->m_eDmaRxIRQ);
+	HAL_NVIC_SetPriority(pConfig->m_eDmaTxIRQ, I2C_BUS_DMA_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(pConfig->m_eDmaTxIRQ);
+}
+
+/* ======================================================*/
+static I2C_BUS_CONTEXT* GetBusContext(I2C_HandleTypeDef *hi2c)
+/* ======================================================*/
+{
+	for (uint8_t i = 0; i < I2C_BUSES_COUNT; i++)
+	{
+		if (hi2c == &g_arrI2CBuses[i].m_hI2C)
+		{
+			return &g_arrI2CBuses[i];
+		}
+	}
+
+	return nullptr;
+}
+
+/* @brief  Has to be called with the interrupts disabled
+ * @retval int8_t - the highest priority in the queue, -1 if the queue is empty
+ */
+/* ======================================================*/
+static int8_t GetHighestQueuedPriority(I2C_BUS_CONTEXT *pBus)
+/* ======================================================*/
+{
+	int8_t nPriority = -1;
+
+	for (uint8_t i = 0; i < pBus->m_nQueued; i++)
+	{
+		if ((int8_t)pBus->m_arrQueue[i]->m_ePriority > nPriority)
+		{
+			nPriority = pBus->m_arrQueue[i]->m_ePriority;
+		}
+	}
+
+	return nPriority;
+}
+
+/* @brief Grant the free bus to the queued transaction with the highest priority
+ *        (the oldest one of them). The transaction is left in the queue when a
+ *        blocking client with a higher priority is waiting for the bus.
+ *        Called from the main loop and from the interrupt context.
+ */
+/* ======================================================*/
+static void StartNext(I2C_BUS_CONTEXT *pBus)
+/* ======================================================*/
+{
+	I2C_BUS_TRANSACTION *pTransaction;
+	uint8_t  nNext    = 0;
+	uint32_t nPrimask = __get_PRIMASK();
+
+	__disable_irq();
+	if (pBus->m_pActive != nullptr || pBus->m_nOwner != I2C_BUS_NO_OWNER || pBus->m_nQueued == 0)
+	{
+		__set_PRIMASK(nPrimask);
+		return;
+	}
+
+	for (uint8_t i = 1; i < pBus->m_nQueued; i++)
+	{
+		if (pBus->m_arrQueue[i]->m_ePriority > pBus->m_arrQueue[nNext]->m_ePriority)
+		{
+			nNext = i;
+		}
+	}
+
+	pTransaction = pBus->m_arrQueue[nNext];
+	if ((int8_t)pTransaction->m_ePriority < pBus->m_nWaitPriority)
+	{
+		__set_PRIMASK(nPrimask);
+		return;
+	}
+
+	for (uint8_t i = nNext; i + 1 < pBus->m_nQueued; i++)
+	{
+		pBus->m_arrQueue[i] = pBus->m_arrQueue[i + 1];
+	}
+	pBus->m_nQueued--;
+
+	pTransaction->m_eState = I2C_TRANSACTION_ACTIVE;
+	pBus->m_pActive        = pTransaction;
+	__set_PRIMASK(nPrimask);
+
+	pBus->m_arrStats[pTransaction->m_eClient].m_nTransactions++;
+	UpdateLatency(&pBus->m_arrStats[pTransaction->m_eClient], pTransaction->m_nRequestTimestamp);
+
+	StartTransfer(pBus, pTransaction);
+}
+
+/* @brief Start the DMA transfer of the active transaction */
+/* ======================================================*/
+static void StartTransfer(I2C_BUS_CONTEXT *pBus, I2C_BUS_TRANSACTION *pTransaction)
+/* ======================================================*/
+{
+	HAL_StatusTypeDef eStatus;
+
+	if (pTransaction->m_bRead)
+	{
+		eStatus = HAL_I2C_Mem_Read_DMA(&pBus->m_hI2C, pTransaction->m_nDevAddr, pTransaction->m_nMemAddr,
+									   pTransaction->m_nMemAddrSize, pTransaction->m_pData, pTransaction->m_nSize);
+	}
+	else
+	{
+		eStatus = HAL_I2C_Mem_Write_DMA(&pBus->m_hI2C, pTransaction->m_nDevAddr, pTransaction->m_nMemAddr,
+										pTransaction->m_nMemAddrSize, pTransaction->m_pData, pTransaction->m_nSize);
+	}
+
+	if (eStatus != HAL_OK)
+	{
+		OnTransferComplete(pBus, 1);
+	}
+}
+
+/* @brief Complete the active transaction and grant the bus to the next one */
+/* ======================================================*/
+static void OnTransferComplete(I2C_BUS_CONTEXT *pBus, uint8_t bError)
+/* ======================================================*/
+{
+	I2C_BUS_TRANSACTION  *pTransaction;
+	I2C_BUS_CLIENT_STATS *pStats;
+
+	if (pBus == nullptr || pBus->m_pActive == nullptr)
+	{
+		return;
+	}
+
+	pTransaction = pBus->m_pActive;
+	pStats       = &pBus->m_arrStats[pTransaction->m_eClient];
+
+	if (!bError)
+	{
+		pStats->m_nBytes += pTransaction->m_nSize;
+	}
+	else
+	{
+		pStats->m_nErrors++;
+	}
+
+	pTransaction->m_eState = bError ? I2C_TRANSACTION_ERROR : I2C_TRANSACTION_DONE;
+	pBus->m_pActive        = nullptr;
+
+	if (pTransaction->m_pCallback != nullptr)
+	{
+		pTransaction->m_pCallback(pTransaction);
+	}
+
+	StartNext(pBus);
+}
+
+/* ======================================================*/
+static void UpdateLatency(I2C_BUS_CLIENT_STATS *pStats, uint32_t nRequestTimestamp)
+/* ======================================================*/
+{
+	uint32_t nLatency_us = System_GetMicros() - nRequestTimestamp;
+
+	pStats->m_nTotalLatency_us += nLatency_us;
+	if (nLatency_us > pStats->m_nMaxLatency_us)
+	{
+		pStats->m_nMaxLatency_us = nLatency_us;
+	}
+}
+
+/* ======================================================*/
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+/* ======================================================*/
+{
+	OnTransferComplete(GetBusContext(hi2c), 0);
+}
+
+/* ======================================================*/
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+/* ======================================================*/
+{
+	OnTransferComplete(GetBusContext(hi2c), 0);
+}
+
+/* ======================================================*/
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+/* ======================================================*/
+{
+	HAL_GPIO_WritePin(LED_RED_GPIO_Port, LED_RED_Pin, GPIO_PIN_SET);
+	OnTransferComplete(GetBusContext(hi2c), 1);
+}
+/* ======================================================*/
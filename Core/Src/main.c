@@ -27,15 +27,16 @@ int main(void)
 	EEPROM_ReadAll();
 	// Initialize BLE module
 	BlueNRG_Init();
-	// Initialize ToF sensor
-	ToF_Init(TOF_CENTRAL);
+	// Initialize the ToF sensors of all registered shelves
+	ToF_InitAll();
 	// Initialize system console
 	Console_Init();
 
 	while (1)
 	{
-		Console_Exec();
-		ToF_Exec();
-		BlueNRG_Process();
+		SYSTEM_STACK_MEASURE(STACK_PATH_CONSOLE, Console_Exec());
+		SYSTEM_STACK_MEASURE(STACK_PATH_TOF, ToF_Exec());
+		SYSTEM_STACK_MEASURE(STACK_PATH_BLUENRG, BlueNRG_Process());
+		SYSTEM_STACK_MEASURE(STACK_PATH_EEPROM, EEPROM_Exec());
 	}
 }
@@ -168,6 +168,99 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c)
 
 		/* USER CODE END I2C1_MspInit 1 */
 	}
+	else if(hi2c->Instance==I2C2)
+	{
+		/** Initializes the peripherals clock
+		 */
+		PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_I2C2;
+		PeriphClkInit.I2c2ClockSelection = RCC_I2C2CLKSOURCE_PCLK1;
+		if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
+		{
+			LEDs_SetLEDState(RED_LED, LED_ON);
+		}
+
+		__HAL_RCC_GPIOF_CLK_ENABLE();
+		/**I2C2 GPIO Configuration
+    PF1     ------> I2C2_SCL
+    PF0     ------> I2C2_SDA
+		 */
+		GPIO_InitStruct.Pin = GPIO_PIN_0|GPIO_PIN_1;
+		GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
+		GPIO_InitStruct.Pull = GPIO_PULLUP;
+		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+		GPIO_InitStruct.Alternate = GPIO_AF4_I2C2;
+		HAL_GPIO_Init(GPIOF, &GPIO_InitStruct);
+
+		/* Peripheral clock enable */
+		__HAL_RCC_I2C2_CLK_ENABLE();
+		/* I2C2 interrupt Init */
+		HAL_NVIC_SetPriority(I2C2_EV_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(I2C2_EV_IRQn);
+		HAL_NVIC_SetPriority(I2C2_ER_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(I2C2_ER_IRQn);
+	}
+	else if(hi2c->Instance==I2C3)
+	{
+		/** Initializes the peripherals clock
+		 */
+		PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_I2C3;
+		PeriphClkInit.I2c3ClockSelection = RCC_I2C3CLKSOURCE_PCLK1;
+		if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
+		{
+			LEDs_SetLEDState(RED_LED, LED_ON);
+		}
+
+		__HAL_RCC_GPIOC_CLK_ENABLE();
+		/**I2C3 GPIO Configuration
+    PC0     ------> I2C3_SCL
+    PC1     ------> I2C3_SDA
+		 */
+		GPIO_InitStruct.Pin = GPIO_PIN_0|GPIO_PIN_1;
+		GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
+		GPIO_InitStruct.Pull = GPIO_PULLUP;
+		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+		GPIO_InitStruct.Alternate = GPIO_AF4_I2C3;
+		HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
+
+		/* Peripheral clock enable */
+		__HAL_RCC_I2C3_CLK_ENABLE();
+		/* I2C3 interrupt Init */
+		HAL_NVIC_SetPriority(I2C3_EV_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(I2C3_EV_IRQn);
+		HAL_NVIC_SetPriority(I2C3_ER_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(I2C3_ER_IRQn);
+	}
+	else if(hi2c->Instance==I2C4)
+	{
+		/** Initializes the peripherals clock
+		 */
+		PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_I2C4;
+		PeriphClkInit.I2c4ClockSelection = RCC_I2C4CLKSOURCE_PCLK1;
+		if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit) != HAL_OK)
+		{
+			LEDs_SetLEDState(RED_LED, LED_ON);
+		}
+
+		__HAL_RCC_GPIOD_CLK_ENABLE();
+		/**I2C4 GPIO Configuration
+    PD12     ------> I2C4_SCL
+    PD13     ------> I2C4_SDA
+		 */
+		GPIO_InitStruct.Pin = GPIO_PIN_12|GPIO_PIN_13;
+		GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
+		GPIO_InitStruct.Pull = GPIO_PULLUP;
+		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+		GPIO_InitStruct.Alternate = GPIO_AF4_I2C4;
+		HAL_GPIO_Init(GPIOD, &GPIO_InitStruct);
+
+		/* Peripheral clock enable */
+		__HAL_RCC_I2C4_CLK_ENABLE();
+		/* I2C4 interrupt Init */
+		HAL_NVIC_SetPriority(I2C4_EV_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(I2C4_EV_IRQn);
+		HAL_NVIC_SetPriority(I2C4_ER_IRQn, 0, 0);
+		HAL_NVIC_EnableIRQ(I2C4_ER_IRQn);
+	}
 }
 
 /**
@@ -199,6 +292,51 @@ void HAL_I2C_MspDeInit(I2C_HandleTypeDef* hi2c)
 
 		/* USER CODE END I2C1_MspDeInit 1 */
 	}
+	else if(hi2c->Instance==I2C2)
+	{
+		/* Peripheral clock disable */
+		__HAL_RCC_I2C2_CLK_DISABLE();
+
+		/**I2C2 GPIO Configuration
+    PF1     ------> I2C2_SCL
+    PF0     ------> I2C2_SDA
+		 */
+		HAL_GPIO_DeInit(GPIOF, GPIO_PIN_0|GPIO_PIN_1);
+
+		/* I2C2 interrupt DeInit */
+		HAL_NVIC_DisableIRQ(I2C2_EV_IRQn);
+		HAL_NVIC_DisableIRQ(I2C2_ER_IRQn);
+	}
+	else if(hi2c->Instance==I2C3)
+	{
+		/* Peripheral clock disable */
+		__HAL_RCC_I2C3_CLK_DISABLE();
+
+		/**I2C3 GPIO Configuration
+    PC0     ------> I2C3_SCL
+    PC1     ------> I2C3_SDA
+		 */
+		HAL_GPIO_DeInit(GPIOC, GPIO_PIN_0|GPIO_PIN_1);
+
+		/* I2C3 interrupt DeInit */
+		HAL_NVIC_DisableIRQ(I2C3_EV_IRQn);
+		HAL_NVIC_DisableIRQ(I2C3_ER_IRQn);
+	}
+	else if(hi2c->Instance==I2C4)
+	{
+		/* Peripheral clock disable */
+		__HAL_RCC_I2C4_CLK_DISABLE();
+
+		/**I2C4 GPIO Configuration
+    PD12     ------> I2C4_SCL
+    PD13     ------> I2C4_SDA
+		 */
+		HAL_GPIO_DeInit(GPIOD, GPIO_PIN_12|GPIO_PIN_13);
+
+		/* I2C4 interrupt DeInit */
+		HAL_NVIC_DisableIRQ(I2C4_EV_IRQn);
+		HAL_NVIC_DisableIRQ(I2C4_ER_IRQn);
+	}
 
 }
 
@@ -26,6 +26,8 @@
 #include "led.h"
 #include "console_drv.h"
 #include "tof.h"
+#include "system.h"
+#include "i2c_bus.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 /* USER CODE END Includes */
@@ -192,11 +194,14 @@ void SysTick_Handler(void)
 	static uint16_t nBLEStatusLedCntr = 0;
 	static uint16_t m_nSystemStatusLedPeriodCntr = 0;
 	static uint16_t m_nToFMeasurementCntr = 0;
+	SYSTEM_STACK_ISR_ENTER();
+
+	System_UpdateTimebase();
 
 	if (++m_nToFMeasurementCntr == 100)
 	{
 		m_nToFMeasurementCntr = 0;
-		ToF_InitiateMeasurement(TOF_CENTRAL);
+		ToF_InitiateMeasurementAll();
 	}
 
 	if (++m_nSystemStatusLedPeriodCntr == 500)
@@ -226,6 +231,8 @@ void SysTick_Handler(void)
 			nBLEStatusLedCntr = 0;
 		}
 	}
+
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_SYSTICK);
 	/* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -236,45 +243,339 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32l5xx.s).                    */
 /******************************************************************************/
 
+/**
+ * @brief This function handles EXTI line0 interrupt.
+ */
+void EXTI0_IRQHandler(void)
+{
+	/* USER CODE BEGIN EXTI0_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END EXTI0_IRQn 0 */
+	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0);
+	/* USER CODE BEGIN EXTI0_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
+	/* USER CODE END EXTI0_IRQn 1 */
+}
+
+/**
+ * @brief This function handles EXTI line1 interrupt.
+ */
+void EXTI1_IRQHandler(void)
+{
+	/* USER CODE BEGIN EXTI1_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END EXTI1_IRQn 0 */
+	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_1);
+	/* USER CODE BEGIN EXTI1_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
+	/* USER CODE END EXTI1_IRQn 1 */
+}
+
+/**
+ * @brief This function handles EXTI line2 interrupt.
+ */
+void EXTI2_IRQHandler(void)
+{
+	/* USER CODE BEGIN EXTI2_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END EXTI2_IRQn 0 */
+	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_2);
+	/* USER CODE BEGIN EXTI2_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
+	/* USER CODE END EXTI2_IRQn 1 */
+}
+
 /**
  * @brief This function handles EXTI line3 interrupt.
  */
 void EXTI3_IRQHandler(void)
 {
 	/* USER CODE BEGIN EXTI3_IRQn 0 */
-
+	SYSTEM_STACK_ISR_ENTER();
 	/* USER CODE END EXTI3_IRQn 0 */
 	HAL_EXTI_IRQHandler(&H_EXTI_3);
 	/* USER CODE BEGIN EXTI3_IRQn 1 */
-
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
 	/* USER CODE END EXTI3_IRQn 1 */
 }
 
+/**
+ * @brief This function handles EXTI line4 interrupt.
+ */
+void EXTI4_IRQHandler(void)
+{
+	/* USER CODE BEGIN EXTI4_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END EXTI4_IRQn 0 */
+	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_4);
+	/* USER CODE BEGIN EXTI4_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
+	/* USER CODE END EXTI4_IRQn 1 */
+}
+
+/**
+ * @brief This function handles EXTI line5 interrupt.
+ */
+void EXTI5_IRQHandler(void)
+{
+	/* USER CODE BEGIN EXTI5_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END EXTI5_IRQn 0 */
+	HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_5);
+	/* USER CODE BEGIN EXTI5_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
+	/* USER CODE END EXTI5_IRQn 1 */
+}
+
 /**
  * @brief This function handles EXTI line13 interrupt.
  */
 void EXTI13_IRQHandler(void)
 {
 	/* USER CODE BEGIN EXTI13_IRQn 0 */
-
+	SYSTEM_STACK_ISR_ENTER();
 	/* USER CODE END EXTI13_IRQn 0 */
 	HAL_EXTI_IRQHandler(&H_EXTI_13);
 	/* USER CODE BEGIN EXTI13_IRQn 1 */
-
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_EXTI);
 	/* USER CODE END EXTI13_IRQn 1 */
 }
 
+/**
+ * @brief This function handles DMA1 channel1 global interrupt.
+ */
+void DMA1_Channel1_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel1_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel1_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaRxHandle(I2C_BUS_1));
+	/* USER CODE BEGIN DMA1_Channel1_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel1_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel2 global interrupt.
+ */
+void DMA1_Channel2_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel2_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel2_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaTxHandle(I2C_BUS_1));
+	/* USER CODE BEGIN DMA1_Channel2_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel2_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C1 event interrupt / I2C1 wake-up interrupt through EXTI line 23.
+ */
+void I2C1_EV_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C1_EV_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C1_EV_IRQn 0 */
+	HAL_I2C_EV_IRQHandler(I2CBus_GetHandle(I2C_BUS_1));
+	/* USER CODE BEGIN I2C1_EV_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C1_EV_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C1 error interrupt.
+ */
+void I2C1_ER_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C1_ER_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C1_ER_IRQn 0 */
+	HAL_I2C_ER_IRQHandler(I2CBus_GetHandle(I2C_BUS_1));
+	/* USER CODE BEGIN I2C1_ER_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C1_ER_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel3 global interrupt.
+ */
+void DMA1_Channel3_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel3_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel3_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaRxHandle(I2C_BUS_2));
+	/* USER CODE BEGIN DMA1_Channel3_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel3_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel4 global interrupt.
+ */
+void DMA1_Channel4_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel4_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel4_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaTxHandle(I2C_BUS_2));
+	/* USER CODE BEGIN DMA1_Channel4_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel4_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel5 global interrupt.
+ */
+void DMA1_Channel5_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel5_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel5_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaRxHandle(I2C_BUS_3));
+	/* USER CODE BEGIN DMA1_Channel5_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel5_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel6 global interrupt.
+ */
+void DMA1_Channel6_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel6_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel6_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaTxHandle(I2C_BUS_3));
+	/* USER CODE BEGIN DMA1_Channel6_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel6_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel7 global interrupt.
+ */
+void DMA1_Channel7_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel7_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel7_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaRxHandle(I2C_BUS_4));
+	/* USER CODE BEGIN DMA1_Channel7_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel7_IRQn 1 */
+}
+
+/**
+ * @brief This function handles DMA1 channel8 global interrupt.
+ */
+void DMA1_Channel8_IRQHandler(void)
+{
+	/* USER CODE BEGIN DMA1_Channel8_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END DMA1_Channel8_IRQn 0 */
+	HAL_DMA_IRQHandler(I2CBus_GetDmaTxHandle(I2C_BUS_4));
+	/* USER CODE BEGIN DMA1_Channel8_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_DMA);
+	/* USER CODE END DMA1_Channel8_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C2 event interrupt.
+ */
+void I2C2_EV_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C2_EV_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C2_EV_IRQn 0 */
+	HAL_I2C_EV_IRQHandler(I2CBus_GetHandle(I2C_BUS_2));
+	/* USER CODE BEGIN I2C2_EV_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C2_EV_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C2 error interrupt.
+ */
+void I2C2_ER_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C2_ER_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C2_ER_IRQn 0 */
+	HAL_I2C_ER_IRQHandler(I2CBus_GetHandle(I2C_BUS_2));
+	/* USER CODE BEGIN I2C2_ER_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C2_ER_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C3 event interrupt.
+ */
+void I2C3_EV_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C3_EV_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C3_EV_IRQn 0 */
+	HAL_I2C_EV_IRQHandler(I2CBus_GetHandle(I2C_BUS_3));
+	/* USER CODE BEGIN I2C3_EV_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C3_EV_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C3 error interrupt.
+ */
+void I2C3_ER_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C3_ER_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C3_ER_IRQn 0 */
+	HAL_I2C_ER_IRQHandler(I2CBus_GetHandle(I2C_BUS_3));
+	/* USER CODE BEGIN I2C3_ER_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C3_ER_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C4 event interrupt.
+ */
+void I2C4_EV_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C4_EV_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C4_EV_IRQn 0 */
+	HAL_I2C_EV_IRQHandler(I2CBus_GetHandle(I2C_BUS_4));
+	/* USER CODE BEGIN I2C4_EV_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C4_EV_IRQn 1 */
+}
+
+/**
+ * @brief This function handles I2C4 error interrupt.
+ */
+void I2C4_ER_IRQHandler(void)
+{
+	/* USER CODE BEGIN I2C4_ER_IRQn 0 */
+	SYSTEM_STACK_ISR_ENTER();
+	/* USER CODE END I2C4_ER_IRQn 0 */
+	HAL_I2C_ER_IRQHandler(I2CBus_GetHandle(I2C_BUS_4));
+	/* USER CODE BEGIN I2C4_ER_IRQn 1 */
+	SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_I2C);
+	/* USER CODE END I2C4_ER_IRQn 1 */
+}
+
 /**
   * @brief This function handles LPUART1 global interrupt / LPUART1 wake-up interrupt through EXTI line 31.
   */
 void LPUART1_IRQHandler(void)
 {
   /* USER CODE BEGIN LPUART1_IRQn 0 */
-
+  SYSTEM_STACK_ISR_ENTER();
   /* USER CODE END LPUART1_IRQn 0 */
   HAL_UART_IRQHandler((UART_HandleTypeDef* )ConsoleDrv_GetUartHandleTypeDef());
   /* USER CODE BEGIN LPUART1_IRQn 1 */
-
+  SYSTEM_STACK_ISR_EXIT(STACK_PATH_ISR_UART);
   /* USER CODE END LPUART1_IRQn 1 */
 }
 
@@ -0,0 +1,232 @@
+/*
+ * stock.c
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#include "stock.h"
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint8_t CountBoundariesBelow(const STOCK_TABLE *pTable, int32_t nRawDistance);
+
+/* Public function definitions  -----------------------------------------------*/
+
+/* @brief Build the raw distance boundaries of the stock of a shelf and reset
+ *        its filter. The stock is the initial one less the removed items,
+ *        rounded to the nearest item position after the polynomial fit - the
+ *        boundary of k+1 removed items is half way between item k and k+1.
+ */
+/* ======================================================*/
+void Stock_Init(STOCK_ESTIMATOR *pEstimator, uint8_t nMaxItems)
+/* ======================================================*/
+{
+	const int32_t nItemPitch_mm = DRINK_SIZE_MM + TOF_DISTANCE_BETWEEN_ITEMS_MM;
+	STOCK_TABLE  *pTable        = &pEstimator->m_sTable;
+
+	pTable->m_nMaxItems        = nMaxItems;
+	pTable->m_nBoundariesCount = (nMaxItems < STOCK_TABLE_SIZE) ? nMaxItems : STOCK_TABLE_SIZE;
+
+	for (uint8_t k = 0; k < pTable->m_nBoundariesCount; k++)
+	{
+		// Fitted distance from which round() gives k+1 removed items (never exactly half way)
+		int32_t nBoundary_mm = TOF_INITIAL_OFFSET_MM + ((2 * k + 1) * nItemPitch_mm + 1) / 2;
+		// Invert the fit, then settle on the first raw distance which reaches the boundary
+		int32_t nRaw_mm = (((int64_t)nBoundary_mm << STOCK_POLYFIT_Q_BITS) - STOCK_POLYFIT_COEF_B_Q20) / STOCK_POLYFIT_COEF_A_Q20;
+
+		while (Stock_PolyfitRawDistance(nRaw_mm) >= nBoundary_mm)
+		{
+			nRaw_mm--;
+		}
+
+		while (Stock_PolyfitRawDistance(nRaw_mm) < nBoundary_mm)
+		{
+			nRaw_mm++;
+		}
+
+		pTable->m_arrRawBoundaries_mm[k] = nRaw_mm;
+	}
+
+	Stock_ResetFilter(pEstimator);
+}
+
+// @brief Forget the ranges averaged so far
+/* ======================================================*/
+void Stock_ResetFilter(STOCK_ESTIMATOR *pEstimator)
+/* ======================================================*/
+{
+	pEstimator->m_sFilter.m_nWeightedRangeSum = 0;
+	pEstimator->m_sFilter.m_nWeightSum        = 0;
+	pEstimator->m_sFilter.m_nFrames           = 0;
+}
+
+/* @brief  Add a valid measurement to the stock filter of a shelf.
+ *         Sigma is in mm as 8.8 fixed point and the signal rate is in MCPS
+ *         as 9.7 fixed point. Internally the variances are in mm^2 as 16.16
+ *         fixed point and the averaged range is in mm as 24.8 fixed point.
+ * @retval uint8_t - 1 when the stock in pLeftItems is confirmed
+ */
+/* ======================================================*/
+uint8_t Stock_Filter(STOCK_ESTIMATOR *pEstimator, int16_t nRange_mm, uint16_t nSigma_mm, uint16_t nSignalRate, uint8_t *pLeftItems)
+/* ======================================================*/
+{
+	const uint32_t     nSignalRef = STOCK_FILTER_SIGNAL_REF_MCPS << 7;
+	const STOCK_TABLE *pTable     = &pEstimator->m_sTable;
+	STOCK_FILTER      *pFilter    = &pEstimator->m_sFilter;
+
+	// Sigma is limited to 1/16mm, so a single frame weighs at most 0x1000000
+	uint32_t nSigma    = (nSigma_mm > 0x10) ? nSigma_mm : 0x10;
+	uint32_t nSignal   = (nSignalRate < nSignalRef) ? nSignalRate : nSignalRef;
+	uint32_t nWeight   = (uint32_t)((((uint64_t)1 << 32) / (nSigma * nSigma)) * nSignal / nSignalRef);
+	int32_t  nRange    = (int32_t)nRange_mm << 8;
+	int32_t  nAverage;
+	uint64_t nVariance;
+	uint8_t  nRemovedItems;
+
+	// No usable signal
+	if (nWeight == 0)
+	{
+		return 0;
+	}
+
+	if (pFilter->m_nWeightSum > 0)
+	{
+		int64_t  nDeviation = nRange - (int32_t)(pFilter->m_nWeightedRangeSum / pFilter->m_nWeightSum);
+		uint64_t nGate      = (((uint64_t)1 << 32) / nWeight + ((uint64_t)1 << 32) / pFilter->m_nWeightSum) * (STOCK_FILTER_GATE_SIGMAS * STOCK_FILTER_GATE_SIGMAS);
+
+		// The distance has moved (an item was taken or put back) - start over from this frame
+		if ((uint64_t)(nDeviation * nDeviation) > nGate)
+		{
+			Stock_ResetFilter(pEstimator);
+		}
+	}
+
+	// Keep the filter responsive to slow drift
+	if (pFilter->m_nWeightSum > STOCK_FILTER_MAX_WEIGHT)
+	{
+		pFilter->m_nWeightedRangeSum /= 2;
+		pFilter->m_nWeightSum        /= 2;
+	}
+
+	pFilter->m_nWeightedRangeSum += (int64_t)nWeight * nRange;
+	pFilter->m_nWeightSum        += nWeight;
+
+	if (pFilter->m_nFrames < UINT8_MAX)
+	{
+		pFilter->m_nFrames++;
+	}
+
+	if (pFilter->m_nFrames < STOCK_FILTER_MIN_FRAMES)
+	{
+		return 0;
+	}
+
+	nAverage      = (int32_t)(pFilter->m_nWeightedRangeSum / pFilter->m_nWeightSum);
+	nVariance     = ((uint64_t)1 << 32) / pFilter->m_nWeightSum;
+	nRemovedItems = CountBoundariesBelow(pTable, nAverage >> 8);
+
+	// The average has to be confidently inside the range of distances of its stock
+	if (nRemovedItems > 0)
+	{
+		int64_t nMargin = nAverage - ((int32_t)pTable->m_arrRawBoundaries_mm[nRemovedItems - 1] << 8);
+
+		if ((uint64_t)(nMargin * nMargin) < nVariance * (STOCK_FILTER_CONFIDENCE_SIGMAS * STOCK_FILTER_CONFIDENCE_SIGMAS))
+		{
+			return 0;
+		}
+	}
+	if (nRemovedItems < pTable->m_nBoundariesCount)
+	{
+		int64_t nMargin = ((int32_t)pTable->m_arrRawBoundaries_mm[nRemovedItems] << 8) - nAverage;
+
+		if ((uint64_t)(nMargin * nMargin) < nVariance * (STOCK_FILTER_CONFIDENCE_SIGMAS * STOCK_FILTER_CONFIDENCE_SIGMAS))
+		{
+			return 0;
+		}
+	}
+
+	*pLeftItems = pTable->m_nMaxItems - nRemovedItems;
+
+	return 1;
+}
+
+/* @brief  Get the stock of a drink shelf for a single raw measured distance
+ * @retval uint8_t - left items
+ */
+/* ======================================================*/
+uint8_t Stock_Estimate(const STOCK_ESTIMATOR *pEstimator, int16_t nRawDistance)
+/* ======================================================*/
+{
+	return pEstimator->m_sTable.m_nMaxItems - CountBoundariesBelow(&pEstimator->m_sTable, nRawDistance);
+}
+
+/* @brief Raw distance window [*pLow, *pHigh) of a stock - the boundaries of
+ *        the table at which the stock changes. The open sides are INT16_MIN
+ *        and INT16_MAX.
+ */
+/* ======================================================*/
+void Stock_GetWindow(const STOCK_ESTIMATOR *pEstimator, uint8_t nLeftItems, int16_t *pLow, int16_t *pHigh)
+/* ======================================================*/
+{
+	const STOCK_TABLE *pTable = &pEstimator->m_sTable;
+	uint8_t nRemovedItems     = (nLeftItems < pTable->m_nMaxItems) ? pTable->m_nMaxItems - nLeftItems : 0;
+
+	if (nRemovedItems > pTable->m_nBoundariesCount)
+	{
+		nRemovedItems = pTable->m_nBoundariesCount;
+	}
+
+	*pLow  = (nRemovedItems > 0) ? pTable->m_arrRawBoundaries_mm[nRemovedItems - 1] : INT16_MIN;
+	*pHigh = (nRemovedItems < pTable->m_nBoundariesCount) ? pTable->m_arrRawBoundaries_mm[nRemovedItems] : INT16_MAX;
+}
+
+/*
+ * @brief  This function fits the measured distance with a polynomial in order to get the real distance
+ * @param  nRawDistance - measured distance by the ToF sensor
+ * @retval int16_t - polynomial fitted distance in [mm.] units
+ */
+/* ======================================================*/
+int16_t Stock_PolyfitRawDistance(int32_t nRawDistance)
+/* ======================================================*/
+{
+	int64_t nDistance = (int64_t)nRawDistance * STOCK_POLYFIT_COEF_A_Q20 + STOCK_POLYFIT_COEF_B_Q20;
+
+	// Truncate towards zero, as the conversion from floating point did
+	if (nDistance < 0)
+	{
+		return (int16_t)-(-nDistance >> STOCK_POLYFIT_Q_BITS);
+	}
+
+	return (int16_t)(nDistance >> STOCK_POLYFIT_Q_BITS);
+}
+
+/* Private function definitions  -----------------------------------------------*/
+
+/* @brief  Count the stock boundaries up to a raw distance - these are the
+ *         removed items
+ * @retval uint8_t - removed items
+ */
+/* ======================================================*/
+static uint8_t CountBoundariesBelow(const STOCK_TABLE *pTable, int32_t nRawDistance)
+/* ======================================================*/
+{
+	uint8_t nLow  = 0;
+	uint8_t nHigh = pTable->m_nBoundariesCount;
+
+	while (nLow < nHigh)
+	{
+		uint8_t nMiddle = (nLow + nHigh) / 2;
+
+		if (pTable->m_arrRawBoundaries_mm[nMiddle] <= nRawDistance)
+		{
+			nLow = nMiddle + 1;
+		}
+		else
+		{
+			nHigh = nMiddle;
+		}
+	}
+
+	return nLow;
+}
@@ -5,14 +5,54 @@
  *      Author: Denislav Trifonov
  */
 
+#include <string.h>
 #include "system.h"
+#include "hw_resources.h"
 
 static void SystemClock_Config(void);
 static void GPIO_Init();
+static void Timebase_Init(void);
+static void Stack_Init(void);
+
+/* Microsecond timebase. The DWT cycle counter wraps every few tens of seconds,
+ * so the elapsed cycles are turned into whole microseconds plus a remainder
+ * of cycles on every read and at least once per SysTick. It all stays in 32
+ * bits - no 64-bit division on the ISR paths.
+ */
+static uint32_t          g_nTimebaseCyclesPerUs = 1;
+static volatile uint32_t g_nTimebaseLastCycles  = 0;
+static volatile uint32_t g_nTimebaseCycles      = 0;	// Not a whole microsecond yet
+static volatile uint32_t g_nTimebaseMicros      = 0;
+
+/* Stack monitor. The unused stack is filled with a pattern at startup, the
+ * lowest overwritten word after a call gives the depth it reached. The main
+ * loop paths are measured from the top of RAM and include the interrupts which
+ * fired meanwhile, the interrupt paths are measured from the handler's frame.
+ */
+#ifdef SYSTEM_STACK_MONITOR
+#define STACK_PAINT_PATTERN 0xC5A5C5A5
+
+extern uint32_t _estack;
+extern uint32_t _end;
+extern uint32_t _Min_Heap_Size;
+
+static uint32_t          *g_pStackFloor = nullptr;
+static uint32_t           g_arrStackHighWaterMark[STACK_PATHS_COUNT];
+static uint32_t           g_nStackPeak = 0;
+static volatile SYSTEM_STACK_PATH g_eStackActivePath = STACK_PATHS_COUNT;
+
+static void Stack_Record(SYSTEM_STACK_PATH ePath, uint32_t nDepth);
+static uint32_t* Stack_GetIsrWindow(uint32_t nEntrySp);
+static uint32_t* Stack_FindDeepest(uint32_t *pFrom, uint32_t *pTo);
+static void Stack_Paint(uint32_t *pFrom, uint32_t *pTo);
+#endif
 
 /*@brief Initialize low-level system resources - clock and HAL libraries */
 void System_Init()
 {
+	// Paint the stack before anything deep runs on it
+	Stack_Init();
+
 	/* Reset of all peripherals, Initializes the Flash interface and the Systick. */
 	HAL_Init();
 
@@ -22,6 +62,9 @@ void System_Init()
 	/* Configure the system clock */
 	SystemClock_Config();
 
+	/* Start the microsecond timebase */
+	Timebase_Init();
+
 	__HAL_RCC_USART1_CLK_ENABLE();
 	__HAL_RCC_LPUART1_CLK_ENABLE();
 }
@@ -81,6 +124,260 @@ void SystemClock_Config(void)
 	}
 }
 
+/*@brief Account the DWT cycles elapsed since the last update. It has to be
+ *        called more often than the cycle counter wraps (SysTick does it).
+ */
+void System_UpdateTimebase(void)
+{
+	uint32_t nPrimask = __get_PRIMASK();
+	uint32_t nCycles;
+	uint32_t nMicros;
+
+	__disable_irq();
+	nCycles                = DWT->CYCCNT;
+	g_nTimebaseCycles     += nCycles - g_nTimebaseLastCycles;
+	g_nTimebaseLastCycles  = nCycles;
+
+	nMicros                = g_nTimebaseCycles / g_nTimebaseCyclesPerUs;
+	g_nTimebaseMicros     += nMicros;
+	g_nTimebaseCycles     -= nMicros * g_nTimebaseCyclesPerUs;
+	__set_PRIMASK(nPrimask);
+}
+
+/*@brief  Get the time since boot in microseconds
+ * @retval uint32_t - microseconds, wrapping around every ~71 minutes
+ */
+uint32_t System_GetMicros(void)
+{
+	uint32_t nPrimask = __get_PRIMASK();
+	uint32_t nMicros;
+
+	__disable_irq();
+	System_UpdateTimebase();
+	nMicros = g_nTimebaseMicros;
+	__set_PRIMASK(nPrimask);
+
+	return nMicros;
+}
+
+/*@brief Busy wait for the given number of microseconds */
+void System_DelayUs(uint32_t nDelay_us)
+{
+	uint32_t nStart = System_GetMicros();
+
+	while ((System_GetMicros() - nStart) < nDelay_us)
+	{
+	}
+}
+
+/*@brief Mark the main loop call which is about to run on the stack */
+void System_StackEnter(SYSTEM_STACK_PATH ePath)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	g_eStackActivePath = ePath;
+#endif
+}
+
+/*@brief Record the stack depth reached by the main loop call and paint the
+ *        used part again for the next call
+ */
+void System_StackExit(SYSTEM_STACK_PATH ePath)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	uint32_t *pTop     = (uint32_t *)(__get_MSP() - SYSTEM_STACK_GUARD);
+	uint32_t *pDeepest = Stack_FindDeepest(g_pStackFloor, pTop);
+
+	Stack_Record(ePath, (uint32_t)&_estack - (uint32_t)pDeepest);
+	g_eStackActivePath = STACK_PATHS_COUNT;
+
+	Stack_Paint(pDeepest, pTop);
+#endif
+}
+
+/*@brief Paint a window below the frame of an interrupt handler, so
+ *        System_StackIsrExit can find how deep the handler went. What the
+ *        interrupted call left there is accounted to it first.
+ */
+void System_StackIsrEnter(uint32_t nEntrySp)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	uint32_t *pFrom    = Stack_GetIsrWindow(nEntrySp);
+	uint32_t *pTop     = (uint32_t *)(__get_MSP() - SYSTEM_STACK_GUARD);
+	uint32_t *pDeepest = Stack_FindDeepest(pFrom, pTop);
+
+	if (pDeepest < pTop && g_eStackActivePath < STACK_PATHS_COUNT)
+	{
+		Stack_Record(g_eStackActivePath, (uint32_t)&_estack - (uint32_t)pDeepest);
+	}
+
+	Stack_Paint(pFrom, pTop);
+#else
+	(void)nEntrySp;
+#endif
+}
+
+/*@brief Record the stack used by an interrupt handler below its frame. The
+ *        resolution is SYSTEM_STACK_GUARD - the part next to the frame isn't painted.
+ */
+void System_StackIsrExit(SYSTEM_STACK_PATH ePath, uint32_t nEntrySp)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	uint32_t *pDeepest = Stack_FindDeepest(Stack_GetIsrWindow(nEntrySp),
+											(uint32_t *)(__get_MSP() - SYSTEM_STACK_GUARD));
+
+	Stack_Record(ePath, nEntrySp - (uint32_t)pDeepest);
+
+	if ((uint32_t)&_estack - (uint32_t)pDeepest > g_nStackPeak)
+	{
+		g_nStackPeak = (uint32_t)&_estack - (uint32_t)pDeepest;
+	}
+#else
+	(void)ePath;
+	(void)nEntrySp;
+#endif
+}
+
+/*@brief  Get the deepest stack usage seen on a path
+ * @retval uint32_t - bytes from the top of RAM (main loop paths) or
+ *         from the handler's frame (interrupt paths)
+ */
+uint32_t System_GetStackHighWaterMark(SYSTEM_STACK_PATH ePath)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	return (ePath < STACK_PATHS_COUNT) ? g_arrStackHighWaterMark[ePath] : 0;
+#else
+	return 0;
+#endif
+}
+
+/*@brief  Get the deepest stack usage seen on any path
+ * @retval uint32_t - bytes from the top of RAM
+ */
+uint32_t System_GetStackPeak(void)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	return g_nStackPeak;
+#else
+	return 0;
+#endif
+}
+
+/*@brief  Get the size of the painted part of the stack. A peak equal to it
+ *         means the stack went deeper than it can be measured.
+ * @retval uint32_t - bytes, 0 if the monitor is not built in
+ */
+uint32_t System_GetStackMonitoredSize(void)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	return (uint32_t)&_estack - (uint32_t)g_pStackFloor;
+#else
+	return 0;
+#endif
+}
+
+/*@brief Clear the high-water marks, the stack stays painted */
+void System_ResetStackStats(void)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	uint32_t nPrimask = __get_PRIMASK();
+
+	__disable_irq();
+	memset(g_arrStackHighWaterMark, 0, sizeof(g_arrStackHighWaterMark));
+	g_nStackPeak = 0;
+	__set_PRIMASK(nPrimask);
+#endif
+}
+
+/**
+ * @brief Paint the unused part of the stack, at most SYSTEM_STACK_MONITOR_SIZE
+ *        bytes and never into the heap
+ * @retval None
+ */
+static void Stack_Init(void)
+{
+#ifdef SYSTEM_STACK_MONITOR
+	uint32_t nFloor   = (uint32_t)&_estack - SYSTEM_STACK_MONITOR_SIZE;
+	uint32_t nHeapEnd = (uint32_t)&_end + (uint32_t)&_Min_Heap_Size;
+
+	g_pStackFloor = (uint32_t *)(((nFloor > nHeapEnd) ? nFloor : nHeapEnd) & ~3UL);
+
+	Stack_Paint(g_pStackFloor, (uint32_t *)(__get_MSP() - SYSTEM_STACK_GUARD));
+#endif
+}
+
+#ifdef SYSTEM_STACK_MONITOR
+/**
+ * @brief Update the high-water mark of a path and the overall peak
+ * @retval None
+ */
+static void Stack_Record(SYSTEM_STACK_PATH ePath, uint32_t nDepth)
+{
+	if (nDepth > g_arrStackHighWaterMark[ePath])
+	{
+		g_arrStackHighWaterMark[ePath] = nDepth;
+	}
+
+	if (ePath < STACK_PATH_ISR_SYSTICK && nDepth > g_nStackPeak)
+	{
+		g_nStackPeak = nDepth;
+	}
+}
+
+/**
+ * @brief Get the start of the window painted below an interrupt frame
+ * @retval uint32_t* - the lowest word of the window
+ */
+static uint32_t* Stack_GetIsrWindow(uint32_t nEntrySp)
+{
+	uint32_t *pFrom = (uint32_t *)(nEntrySp - SYSTEM_STACK_ISR_WINDOW);
+
+	return (pFrom < g_pStackFloor) ? g_pStackFloor : pFrom;
+}
+
+/**
+ * @brief Find the lowest word which isn't painted
+ * @retval uint32_t* - the word, pTo if the whole range is painted
+ */
+static uint32_t* Stack_FindDeepest(uint32_t *pFrom, uint32_t *pTo)
+{
+	while (pFrom < pTo && *pFrom == STACK_PAINT_PATTERN)
+	{
+		pFrom++;
+	}
+
+	return pFrom;
+}
+
+/**
+ * @brief Fill the range with the paint pattern
+ * @retval None
+ */
+static void Stack_Paint(uint32_t *pFrom, uint32_t *pTo)
+{
+	while (pFrom < pTo)
+	{
+		*pFrom++ = STACK_PAINT_PATTERN;
+	}
+}
+#endif
+
+/**
+ * @brief Enable the DWT cycle counter used as microsecond timebase
+ * @retval None
+ */
+static void Timebase_Init(void)
+{
+	g_nTimebaseCyclesPerUs = SystemCoreClock / 1000000;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT       = 0;
+	DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+	g_nTimebaseLastCycles = 0;
+	g_nTimebaseCycles     = 0;
+	g_nTimebaseMicros     = 0;
+}
+
 /**
  * @brief GPIO Initialization Function
  * @param None
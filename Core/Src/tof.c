@@ -8,430 +8,1007 @@
 #include "tof.h"
 
 /* Private data  ---------------------------------------------------------*/
-static I2C_HandleTypeDef hi2c1;
-static I2C_STATUS g_eI2cStatus                = I2C_STATUS_NOT_INIT;
 
 static TOF_STATE g_eToFSensorState[SENSORS_SUPPORTED] = {STATE_NOT_INIT};
 
+/* Data ready (GPIO1) pins of the sensors. The first one is the VL53L3CX
+ * mounted on the X-NUCLEO-53L3A2 board (PC3, or PC1 when the board is set up
+ * with VL53L3A2_GPIO1_C_OPTION), the rest are wired on the custom PCB.
+ * GPIO1 is active low (open drain), so the data ready interrupt is on the
+ * falling edge and the pin is pulled up - an unpopulated slot doesn't float.
+ */
 static GPIO_InitTypeDef g_arrToFGPIOs[SENSORS_SUPPORTED] = {
-		{GPIO_PIN_3, GPIO_MODE_INPUT, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0}};
+		{VL53L3A2_GPIO1_C_GPIO_PIN, GPIO_MODE_IT_FALLING, GPIO_PULLUP, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_0, GPIO_MODE_IT_FALLING, GPIO_PULLUP, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_2, GPIO_MODE_IT_FALLING, GPIO_PULLUP, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_4, GPIO_MODE_IT_FALLING, GPIO_PULLUP, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_5, GPIO_MODE_IT_FALLING, GPIO_PULLUP, GPIO_SPEED_FREQ_LOW, 0}};
 
 static GPIO_TypeDef* g_arrToFPorts[SENSORS_SUPPORTED] =
-{GPIOC};
+{VL53L3A2_GPIO1_C_GPIO_PORT, GPIOG, GPIOE, GPIOE, GPIOE};
+
+static IRQn_Type g_arrToFIRQs[SENSORS_SUPPORTED] =
+{VL53L3A2_GPIO1_C_INTx, EXTI0_IRQn, EXTI2_IRQn, EXTI4_IRQn, EXTI5_IRQn};
+
+static TOF_MEASURING_MODE   g_arrToFMeasuringMode[SENSORS_SUPPORTED];
+static TOF_DATA_READY_EVENT g_arrToFDataReady[SENSORS_SUPPORTED];
+
+// State to continue from when the histogram fetch of a sensor completes
+static TOF_STATE g_arrToFFetchOrigin[SENSORS_SUPPORTED];
+
+// Latched histograms waiting for post-processing
+static uint8_t   g_arrToFProcessingPending[SENSORS_SUPPORTED];
+static TOF_STATE g_arrToFLatchedOrigin[SENSORS_SUPPORTED];
+static uint32_t  g_arrToFLatchedTimestamp[SENSORS_SUPPORTED];
+
+// Stream count of the last consumed measurement, used to drop stale frames
+static uint8_t g_arrToFLastStreamCount[SENSORS_SUPPORTED];
+static uint8_t g_arrToFStreamCountValid[SENSORS_SUPPORTED];
+
+// Time of the last XSHUT change of a sensor which is being booted
+static uint32_t g_arrToFBootTimestamp[SENSORS_SUPPORTED];
+
+// Data init of a booted sensor - the next step and the UID which keys its cache
+static uint8_t  g_arrToFInitStep[SENSORS_SUPPORTED];
+static uint64_t g_arrToFUid[SENSORS_SUPPORTED];
+static uint8_t  g_arrToFUidValid[SENSORS_SUPPORTED];
+
+static TOF_CADENCE_CONTROL g_arrToFCadence[SENSORS_SUPPORTED];
+static TOF_ITEM_WINDOW     g_arrToFItemWindow[SENSORS_SUPPORTED];
+static STOCK_ESTIMATOR     g_arrToFStock[SENSORS_SUPPORTED];
 
 static GPIO_InitTypeDef g_arrToFXShutDownPin[SENSORS_SUPPORTED] = {
-		{GPIO_PIN_14, GPIO_MODE_OUTPUT_PP, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0}};
+		{GPIO_PIN_14, GPIO_MODE_OUTPUT_PP, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_15, GPIO_MODE_OUTPUT_PP, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_7,  GPIO_MODE_OUTPUT_PP, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_8,  GPIO_MODE_OUTPUT_PP, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0},
+		{GPIO_PIN_10, GPIO_MODE_OUTPUT_PP, GPIO_NOPULL, GPIO_SPEED_FREQ_LOW, 0}};
 
 static GPIO_TypeDef* g_arrToFXShutDownPorts[SENSORS_SUPPORTED] =
-{GPIOF};
+{GPIOF, GPIOF, GPIOE, GPIOE, GPIOE};
 
 static VL53LX_Dev_t g_ToFSensorDriverData[SENSORS_SUPPORTED];
-static VL53LX_MultiRangingData_t g_ToFSensorMeasurementData[SENSORS_SUPPORTED];
+static VL53LX_PrimaryRangingData_t g_ToFSensorMeasurementData[SENSORS_SUPPORTED];
+
+static TOF_MEASUREMENT_HISTORY   g_arrToFHistory[SENSORS_SUPPORTED];
 
 static uint8_t g_arrLeftItems[SENSORS_SUPPORTED];
 static TOF_MEASUREMENT_PERFORMED g_arrToFSensorsMeasurementPerformed[SENSORS_SUPPORTED];
 
 /* Private function prototypes -----------------------------------------------*/
-static void I2C_Init(void);
 static void GPIO_Init(TOF_SUPPORTED_SENSORS eSensor);
-static void CalculateLeftShelfItems(TOF_SUPPORTED_SENSORS eSensor);
-static int16_t PolyfitRawDistance(int16_t nRawDistance);
+static uint8_t IsExtiLineFree(GPIO_TypeDef *pPort, uint16_t nPin);
+static uint8_t IsExtiLineRoutedTo(GPIO_TypeDef *pPort, uint16_t nPin);
+static void SampleDataReadyPins(void);
+static uint8_t ServiceSensor(TOF_SUPPORTED_SENSORS eSensor);
+static uint8_t ServiceBoot(TOF_SUPPORTED_SENSORS eSensor);
+static void FinishInit(TOF_SUPPORTED_SENSORS eSensor);
+static void ServiceDataInit(TOF_SUPPORTED_SENSORS eSensor);
+static void StartRanging(TOF_SUPPORTED_SENSORS eSensor);
+static void ProcessFetchedData(TOF_SUPPORTED_SENSORS eSensor, TOF_STATE eState);
+static void ProcessLatchedData(TOF_SUPPORTED_SENSORS eSensor);
+static uint8_t IsFreshFrame(TOF_SUPPORTED_SENSORS eSensor);
+static void RecordMeasurement(TOF_SUPPORTED_SENSORS eSensor);
+static uint16_t CompressFixPoint1616(FixPoint1616_t nValue, uint8_t nFractionalBits);
+static void CalculateLeftShelfItems(TOF_SUPPORTED_SENSORS eSensor, const TOF_MEASUREMENT_RECORD *pRecord);
+static void UpdateCadence(TOF_SUPPORTED_SENSORS eSensor, const TOF_MEASUREMENT_RECORD *pRecord);
+static void UpdateItemWindow(TOF_SUPPORTED_SENSORS eSensor);
+static void SetCadence(TOF_SUPPORTED_SENSORS eSensor, TOF_CADENCE eCadence);
+static void Park(TOF_SUPPORTED_SENSORS eSensor);
+static void Unpark(TOF_SUPPORTED_SENSORS eSensor);
 
 /* Public function definitions  -----------------------------------------------*/
 
-// @brief initialize selected ToF sensor
+/* @brief Initialize the ToF sensors of all shelves registered in the EEPROM.
+ *        All sensors are held in reset first and then released one at a time
+ *        by ToF_Exec, so that each of them could be moved from the default
+ *        I2C address to the address stored in its shelf record.
+ */
+/* ======================================================*/
+void ToF_InitAll()
+/* ======================================================*/
+{
+	uint8_t nShelvesCount = EEPROM_GetTotalShelvesCount();
+
+	// The data ready pins are armed only for the registered shelves, by ToF_Init
+	for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
+	{
+		HAL_GPIO_Init(g_arrToFXShutDownPorts[i], &g_arrToFXShutDownPin[i]);
+		HAL_GPIO_WritePin(g_arrToFXShutDownPorts[i], g_arrToFXShutDownPin[i].Pin, GPIO_PIN_RESET);
+	}
+
+	for (uint8_t i = 0; i < nShelvesCount && i < SENSORS_SUPPORTED; i++)
+	{
+		ToF_Init(i);
+	}
+}
+
+/* @brief Initialize selected ToF sensor.
+ *        Sensors which are not initialized yet have to be held in reset,
+ *        because the selected one is accessed on the default I2C address.
+ */
+/* ======================================================*/
+void ToF_Init(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	EEPROM_SHELF_INFO *arrShelfInfo = EEPROM_GetShelf(eSensor);
+	I2C_BUS_ID         eBus;
+
+	if (eSensor >= SENSORS_SUPPORTED || arrShelfInfo == nullptr)
+	{
+		return;
+	}
+
+	g_arrToFStreamCountValid[eSensor]            = 0;
+	g_arrToFSensorsMeasurementPerformed[eSensor] = MEASUREMENT_NOT_PERFORMED;
+
+	// The item geometry of the shelf doesn't change, so the stock boundaries are computed once
+	Stock_Init(&g_arrToFStock[eSensor], EEPROM_GetShelfInitialStock(eSensor));
+
+	// Initialize the VL53L3CX GPIO pin
+	GPIO_Init(eSensor);
+
+	// The sensor can be on any of the I2C controllers, as set in its shelf record
+	eBus = (arrShelfInfo->m_nI2cBus < I2C_BUSES_COUNT) ? (I2C_BUS_ID)arrShelfInfo->m_nI2cBus : I2C_BUS_1;
+	I2CBus_Init(eBus);
+
+	g_ToFSensorDriverData[eSensor].I2cBus     = eBus;
+	g_ToFSensorDriverData[eSensor].I2cHandle  = I2CBus_GetHandle(eBus);
+	g_ToFSensorDriverData[eSensor].I2cDevAddr = TOF_DEFAULT_I2C_ADDRESS;
+
+	// The sensor is released from reset and booted by ToF_Exec
+	HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_RESET);
+	g_arrToFBootTimestamp[eSensor] = HAL_GetTick();
+	g_eToFSensorState[eSensor]     = STATE_BOOT_PENDING;
+}
+
+/* @brief: This function is called in the main loop.
+ *         On each I2C bus it services the first sensor (in round-robin order)
+ *         which has work to be done, so a single pass never reads out more
+ *         than one sensor per bus and the buses work in parallel.
+ */
+/* ======================================================*/
+void ToF_Exec()
+/* ======================================================*/
+{
+	static uint8_t m_nNextSensor = 0;
+
+	static uint8_t m_nNextProcessed = 0;
+
+	uint8_t arrBusServiced[I2C_BUSES_COUNT] = {0};
+	uint8_t bServiced = 0;
+
+	SampleDataReadyPins();
+
+	for (uint8_t n = 0; n < SENSORS_SUPPORTED; n++)
+	{
+		uint8_t    i    = (m_nNextSensor + n) % SENSORS_SUPPORTED;
+		I2C_BUS_ID eBus = (I2C_BUS_ID)g_ToFSensorDriverData[i].I2cBus;
+
+		// While a histogram fetch is in progress the bus can't be used by the other sensors on it
+		if (arrBusServiced[eBus] || g_eToFSensorState[i] == STATE_NOT_INIT ||
+			!I2CBus_IsAvailable(eBus, I2C_BUS_PRIORITY_NORMAL))
+		{
+			continue;
+		}
+
+		if (ServiceSensor(i))
+		{
+			arrBusServiced[eBus] = 1;
+
+			if (!bServiced)
+			{
+				m_nNextSensor = (i + 1) % SENSORS_SUPPORTED;
+				bServiced     = 1;
+			}
+		}
+	}
+
+	if (bServiced)
+	{
+		return;
+	}
+
+	// Idle slice - post-process one of the latched histograms
+	for (uint8_t n = 0; n < SENSORS_SUPPORTED; n++)
+	{
+		uint8_t i = (m_nNextProcessed + n) % SENSORS_SUPPORTED;
+
+		if (g_arrToFProcessingPending[i])
+		{
+			ProcessLatchedData(i);
+			m_nNextProcessed = (i + 1) % SENSORS_SUPPORTED;
+			break;
+		}
+	}
+}
+
+/* ======================================================*/
+TOF_STATUS ToF_Measure(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	TOF_STATUS eStatus = TOF_STATUS_OK;
+
+	if (eSensor >= SENSORS_SUPPORTED)
+	{
+		eStatus = TOF_STATUS_ERROR;
+	}
+	else if ((g_eToFSensorState[eSensor] == STATE_IDLE || g_eToFSensorState[eSensor] == STATE_PENDING_MEASUREMENT) &&
+			 !I2CBus_IsAvailable((I2C_BUS_ID)g_ToFSensorDriverData[eSensor].I2cBus, I2C_BUS_PRIORITY_NORMAL))
+	{
+		// A histogram fetch is using the bus - ToF_Exec starts the measurement when it is done
+		g_eToFSensorState[eSensor] = STATE_PENDING_MEASUREMENT;
+	}
+	else if (g_eToFSensorState[eSensor] == STATE_IDLE || g_eToFSensorState[eSensor] == STATE_PENDING_MEASUREMENT)
+	{
+		g_arrToFDataReady[eSensor].m_bDataReady = 0;
+
+		/* The last measurement has already been latched and processed, the sensor
+		 * only has to be re-armed. On the fast cadence it keeps streaming, on the
+		 * slow one the first measurement (when the distance is changing) is ignored.
+		 */
+		if (!VL53LX_PROFILED(VL53LX_ClearInterruptAndStartMeasurement, &g_ToFSensorDriverData[eSensor]))
+		{
+			g_eToFSensorState[eSensor] = (g_arrToFCadence[eSensor].m_eCadence == TOF_CADENCE_FAST) ?
+										 STATE_STREAMING : STATE_IGNORE_FIRST_DATA;
+		}
+		else
+		{
+			eStatus                    = TOF_STATUS_ERROR;
+			g_eToFSensorState[eSensor] = STATE_ERROR;
+		}
+	}
+	else
+	{
+		eStatus = TOF_STATUS_ERROR;
+	}
+
+	return eStatus;
+}
+
+/* ======================================================*/
+VL53LX_PrimaryRangingData_t* ToF_GetDistance_mm(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	VL53LX_PrimaryRangingData_t* pData = NULL;
+
+	if (eSensor < SENSORS_SUPPORTED &&
+		(g_eToFSensorState[eSensor] == STATE_IDLE || g_eToFSensorState[eSensor] == STATE_STREAMING ||
+		 g_eToFSensorState[eSensor] == STATE_PARKED))
+	{
+		pData = &g_ToFSensorMeasurementData[eSensor];
+	}
+
+	return pData;
+}
+
+/* ======================================================*/
+uint8_t ToF_GetLeftItems(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	if (eSensor < SENSORS_SUPPORTED)
+	{
+		return g_arrLeftItems[eSensor];
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+// @brief Get the number of records written to the history of the sensor since boot
+/* ======================================================*/
+uint32_t ToF_GetHistoryCount(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	return (eSensor < SENSORS_SUPPORTED) ? g_arrToFHistory[eSensor].m_nWritten : 0;
+}
+
+/* @brief  Read the next record from the history of the sensor. A cursor which
+ *         has fallen behind the ring is moved to the oldest record still kept.
+ * @param  pCursor - reader's position, 0 to start from the oldest record
+ * @retval uint8_t - 1 if a record has been read, 0 if there are no new records
+ */
+/* ======================================================*/
+uint8_t ToF_ReadHistory(TOF_SUPPORTED_SENSORS eSensor, uint32_t *pCursor, TOF_MEASUREMENT_RECORD *pRecord)
+/* ======================================================*/
+{
+	TOF_MEASUREMENT_HISTORY *pHistory;
+	uint32_t nWritten;
+
+	if (eSensor >= SENSORS_SUPPORTED || pCursor == NULL || pRecord == NULL)
+	{
+		return 0;
+	}
+
+	pHistory = &g_arrToFHistory[eSensor];
+
+	do
+	{
+		nWritten = pHistory->m_nWritten;
+
+		if (*pCursor == nWritten)
+		{
+			return 0;
+		}
+
+		if ((nWritten - *pCursor) > TOF_HISTORY_SIZE)
+		{
+			*pCursor = nWritten - TOF_HISTORY_SIZE;
+		}
+
+		*pRecord = pHistory->m_arrRecords[*pCursor & (TOF_HISTORY_SIZE - 1)];
+	}
+	// The record has been overwritten while being copied
+	while ((pHistory->m_nWritten - *pCursor) > TOF_HISTORY_SIZE);
+
+	(*pCursor)++;
+
+	return 1;
+}
+
+/* @brief  Get the last consumed measurement of the sensor
+ * @retval uint8_t - 1 if the sensor has a record, 0 otherwise
+ */
+/* ======================================================*/
+uint8_t ToF_GetLatestRecord(TOF_SUPPORTED_SENSORS eSensor, TOF_MEASUREMENT_RECORD *pRecord)
+/* ======================================================*/
+{
+	uint32_t nCursor;
+
+	if (eSensor >= SENSORS_SUPPORTED || g_arrToFHistory[eSensor].m_nWritten == 0)
+	{
+		return 0;
+	}
+
+	nCursor = g_arrToFHistory[eSensor].m_nWritten - 1;
+
+	return ToF_ReadHistory(eSensor, &nCursor, pRecord);
+}
+
+/* ======================================================*/
+TOF_MEASURING_MODE ToF_GetMeasuringMode(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	if (eSensor < SENSORS_SUPPORTED)
+	{
+		return g_arrToFMeasuringMode[eSensor];
+	}
+	else
+	{
+		return TOF_MEASURING_MODE_NONE;
+	}
+}
+
+/* ======================================================*/
+TOF_CADENCE ToF_GetCadence(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	if (eSensor < SENSORS_SUPPORTED)
+	{
+		return g_arrToFCadence[eSensor].m_eCadence;
+	}
+	else
+	{
+		return TOF_CADENCE_FAST;
+	}
+}
+
+/* ======================================================*/
+TOF_ITEM_WINDOW* ToF_GetItemWindow(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	TOF_ITEM_WINDOW* pWindow = NULL;
+
+	if (eSensor < SENSORS_SUPPORTED)
+	{
+		pWindow = &g_arrToFItemWindow[eSensor];
+	}
+
+	return pWindow;
+}
+
+/* ======================================================*/
+void ToF_InitiateMeasurement(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	if (eSensor < SENSORS_SUPPORTED)
+	{
+		if (g_eToFSensorState[eSensor] == STATE_IDLE)
+		{
+			g_eToFSensorState[eSensor] = STATE_PENDING_MEASUREMENT;
+		}
+	}
+}
+
+
+/* @brief Initiate the measurement of every sensor whose cadence period has
+ *        elapsed. It is called periodically (every TOF_FAST_MEASUREMENT_PERIOD_MS).
+ */
+/* ======================================================*/
+void ToF_InitiateMeasurementAll()
+/* ======================================================*/
+{
+	uint32_t nNow = HAL_GetTick();
+
+	for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
+	{
+		uint32_t nPeriod = (g_arrToFCadence[i].m_eCadence == TOF_CADENCE_SLOW) ?
+						   TOF_SLOW_MEASUREMENT_PERIOD_MS : TOF_FAST_MEASUREMENT_PERIOD_MS;
+
+		if (g_eToFSensorState[i] == STATE_IDLE && (nNow - g_arrToFCadence[i].m_nLastMeasurement) >= nPeriod)
+		{
+			g_arrToFCadence[i].m_nLastMeasurement = nNow;
+			ToF_InitiateMeasurement(i);
+		}
+	}
+}
+
+
+/* Private function definitions  -----------------------------------------------*/
+/* @brief  Run one step of the state machine of the selected sensor
+ * @retval uint8_t - 1 if the sensor has been accessed, 0 if there was nothing to do
+ */
+/* ======================================================*/
+static uint8_t ServiceSensor(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	uint8_t   bServiced = 0;
+	TOF_STATE eState    = g_eToFSensorState[eSensor];
+
+	if (eState == STATE_BOOT_PENDING || eState == STATE_BOOTING)
+	{
+		bServiced = ServiceBoot(eSensor);
+	}
+
+	else if (eState == STATE_DATA_INIT)
+	{
+		ServiceDataInit(eSensor);
+		bServiced = 1;
+	}
+
+	else if (eState == STATE_PENDING_MEASUREMENT)
+	{
+		ToF_Measure(eSensor);
+		bServiced = 1;
+	}
+
+	// The shelf has been stable - park it once its last histogram has been processed
+	else if ((eState == STATE_IDLE || eState == STATE_STREAMING) &&
+			 g_arrToFCadence[eSensor].m_bParkRequested && !g_arrToFProcessingPending[eSensor])
+	{
+		Park(eSensor);
+		bServiced = 1;
+	}
+
+	// GPIO1 of a parked sensor - the front item has left its window
+	else if (eState == STATE_PARKED && g_arrToFDataReady[eSensor].m_bDataReady)
+	{
+		g_arrToFDataReady[eSensor].m_bDataReady = 0;
+		Unpark(eSensor);
+		bServiced = 1;
+	}
+
+	/* ToF sensor is initializing, ignoring its first data (when the distance is changing),
+	 * performing measurement or streaming. Check if data ready event has occurred and
+	 * start fetching the histogram in the background.
+	 */
+	else if ((eState == STATE_INIT_IN_PROCESS || eState == STATE_IGNORE_FIRST_DATA ||
+			  eState == STATE_MEASURING || eState == STATE_STREAMING) &&
+			 g_arrToFDataReady[eSensor].m_bDataReady)
+	{
+		bServiced = 1;
+		g_arrToFDataReady[eSensor].m_bDataReady = 0;
+
+		// The previous histogram has to be processed before the next one is latched
+		if (g_arrToFProcessingPending[eSensor])
+		{
+			ProcessLatchedData(eSensor);
+		}
+
+		if (VL53LX_PROFILED(VL53LX_ReadMultiAsync, &g_ToFSensorDriverData[eSensor],
+								  VL53LX_HISTOGRAM_BIN_DATA_I2C_INDEX,
+								  VL53LX_HISTOGRAM_BIN_DATA_I2C_SIZE_BYTES))
+		{
+			g_eToFSensorState[eSensor] = STATE_ERROR;
+		}
+		else
+		{
+			g_arrToFFetchOrigin[eSensor]      = eState;
+			g_arrToFLatchedTimestamp[eSensor] = g_arrToFDataReady[eSensor].m_nTimestamp;
+			g_eToFSensorState[eSensor]        = STATE_FETCHING;
+		}
+	}
+
+	else if (eState == STATE_FETCHING)
+	{
+		uint8_t bDone = 0;
+
+		if (VL53LX_PollAsync(&g_ToFSensorDriverData[eSensor], &bDone))
+		{
+			bServiced = 1;
+			g_eToFSensorState[eSensor] = STATE_ERROR;
+		}
+		else if (bDone)
+		{
+			bServiced = 1;
+			ProcessFetchedData(eSensor, g_arrToFFetchOrigin[eSensor]);
+		}
+	}
+
+	return bServiced;
+}
+
+/* @brief  Step the boot of the selected sensor. Only one sensor at a time is
+ *         released from reset, as all of them boot at the default address.
+ * @retval uint8_t - 1 if the sensor has been accessed, 0 if there was nothing to do
+ */
+/* ======================================================*/
+static uint8_t ServiceBoot(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	uint32_t nNow    = HAL_GetTick();
+	uint8_t  bBooted = 0;
+
+	// Give the sensor time to settle after the last XSHUT change
+	if ((nNow - g_arrToFBootTimestamp[eSensor]) < TOF_BOOT_TIME_MS)
+	{
+		return 0;
+	}
+
+	if (g_eToFSensorState[eSensor] == STATE_BOOT_PENDING)
+	{
+		// Only one sensor per bus can be on the default address
+		for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
+		{
+			if (g_eToFSensorState[i] == STATE_BOOTING &&
+				g_ToFSensorDriverData[i].I2cBus == g_ToFSensorDriverData[eSensor].I2cBus)
+			{
+				return 0;
+			}
+		}
+
+		HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_SET);
+		// The sensor comes out of reset with its default register values
+		VL53LX_ShadowInvalidate(&g_ToFSensorDriverData[eSensor]);
+		g_arrToFBootTimestamp[eSensor] = nNow;
+		g_eToFSensorState[eSensor]     = STATE_BOOTING;
+	}
+	else if (VL53LX_PROFILED(VL53LX_CheckDeviceBooted, &g_ToFSensorDriverData[eSensor], &bBooted))
+	{
+		// The sensor doesn't answer - keep it in reset, so it doesn't block the others
+		LEDs_SetLEDState(RED_LED, LED_ON);
+		HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_RESET);
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+	}
+	else if (bBooted)
+	{
+		FinishInit(eSensor);
+	}
+
+	return 1;
+}
+
+/* @brief Finish the boot of a sensor - move it to its own address and queue
+ *        the initialization of its driver data
+ */
 /* ======================================================*/
-void ToF_Init(TOF_SUPPORTED_SENSORS eSensor)
+static void FinishInit(TOF_SUPPORTED_SENSORS eSensor)
 /* ======================================================*/
 {
 	uint8_t nDummyByte  = 0;
 
 	EEPROM_SHELF_INFO *arrShelfInfo = EEPROM_GetShelf(eSensor);
 
-	g_eToFSensorState[eSensor]                   = STATE_INIT_IN_PROCESS;
-	g_arrToFSensorsMeasurementPerformed[eSensor] = MEASUREMENT_NOT_PERFORMED;
+	// Check the I2C communication with VL53L3CX
+	VL53LX_PROFILED(VL53LX_RdByte, &g_ToFSensorDriverData[eSensor], 0x010F, &nDummyByte);
+	if (nDummyByte != 0xEA)
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
 
-	// Initialize the VL53L3CX GPIO pin
-	GPIO_Init(eSensor);
+	VL53LX_PROFILED(VL53LX_RdByte, &g_ToFSensorDriverData[eSensor], 0x0110, &nDummyByte);
 
-	/* Initialize I2C communication.
-	 * This function is going to be executed only once
-	 * because each VL53L3CX sensor is connected to the MCU
-	 * via same I2C interface.
-	 */
-	if (g_eI2cStatus == I2C_STATUS_NOT_INIT)
+	if (nDummyByte != 0xAA)
 	{
-		g_eI2cStatus = I2C_STATUS_INIT;
-		I2C_Init();
+		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	g_ToFSensorDriverData[eSensor].I2cHandle  = &hi2c1;
-	g_ToFSensorDriverData[eSensor].I2cDevAddr = arrShelfInfo->m_nI2cAddress;
+	/* Move the sensor to its own address. If this fails the sensor is put back
+	 * in reset - otherwise it would answer instead of the next sensor.
+	 */
+	if (arrShelfInfo->m_nI2cAddress != TOF_DEFAULT_I2C_ADDRESS)
+	{
+		if (VL53LX_PROFILED(VL53LX_SetDeviceAddress, &g_ToFSensorDriverData[eSensor], arrShelfInfo->m_nI2cAddress))
+		{
+			LEDs_SetLEDState(RED_LED, LED_ON);
+			HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_RESET);
+			g_eToFSensorState[eSensor] = STATE_ERROR;
+			return;
+		}
 
-	HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_RESET);
-	HAL_Delay(2);
-	HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_SET);
-	HAL_Delay(2);
+		g_ToFSensorDriverData[eSensor].I2cDevAddr = arrShelfInfo->m_nI2cAddress;
+	}
 
-	// Check the I2C communication with VL53L3CX
-	VL53LX_RdByte(&g_ToFSensorDriverData[eSensor], 0x010F, &nDummyByte);
-	if (nDummyByte != 0xEA)
+	if (VL53LX_PROFILED(VL53LX_StopMeasurement, &g_ToFSensorDriverData[eSensor]))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	VL53LX_RdByte(&g_ToFSensorDriverData[eSensor], 0x0110, &nDummyByte);
+	g_arrToFInitStep[eSensor]  = 0;
+	g_eToFSensorState[eSensor] = STATE_DATA_INIT;
+}
 
-	if (nDummyByte != 0xAA)
+/* @brief  Step the initialization of the driver data of a sensor. The part-to-part
+ *         data decoded from the sensor NVM is cached in the EEPROM and reused while
+ *         the UID of the sensor matches, otherwise the NVM is read one block per
+ *         call and the cache updated.
+ */
+/* ======================================================*/
+static void ServiceDataInit(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	static VL53LX_p2p_data_t m_P2PData;
+
+	VL53LX_DEV pDev  = &g_ToFSensorDriverData[eSensor];
+	uint8_t    nStep = g_arrToFInitStep[eSensor]++;
+	uint8_t    bDone = 0;
+
+	if (nStep == 0)
 	{
-		LEDs_SetLEDState(RED_LED, LED_ON);
+		// Without the UID the NVM is read, but the cache is neither used nor written
+		g_arrToFUidValid[eSensor] = !VL53LX_PROFILED(VL53LX_GetUID, pDev, &g_arrToFUid[eSensor]);
+
+		if (g_arrToFUidValid[eSensor] &&
+			EEPROM_ReadSensorCache(eSensor, g_arrToFUid[eSensor], (uint8_t *)&m_P2PData, sizeof(m_P2PData)))
+		{
+			if (VL53LX_PROFILED(VL53LX_DataInitFromP2PData, pDev, &m_P2PData))
+			{
+				LEDs_SetLEDState(RED_LED, LED_ON);
+			}
+
+			StartRanging(eSensor);
+		}
+
+		return;
 	}
 
-	if (VL53LX_StopMeasurement(&g_ToFSensorDriverData[eSensor]))
+	// A sensor which fails the NVM read is kept in reset, as after a failed boot
+	if (VL53LX_PROFILED(VL53LX_ReadP2PDataStep, pDev, nStep - 1, &bDone))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
+		HAL_GPIO_WritePin(g_arrToFXShutDownPorts[eSensor], g_arrToFXShutDownPin[eSensor].Pin, GPIO_PIN_RESET);
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+		return;
 	}
 
-	if (VL53LX_WaitDeviceBooted(&g_ToFSensorDriverData[eSensor]))
+	if (!bDone)
 	{
-		LEDs_SetLEDState(RED_LED, LED_ON);
+		return;
 	}
 
-	if (VL53LX_DataInit(&g_ToFSensorDriverData[eSensor]))
+	VL53LX_GetP2PData(pDev, &m_P2PData);
+
+	if (VL53LX_PROFILED(VL53LX_DataInitFromP2PData, pDev, &m_P2PData))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
+	else if (g_arrToFUidValid[eSensor])
+	{
+		// Written in the background by EEPROM_Exec
+		EEPROM_WriteSensorCache(eSensor, g_arrToFUid[eSensor], (uint8_t *)&m_P2PData, sizeof(m_P2PData));
+	}
+
+	StartRanging(eSensor);
+}
+
+/* @brief Configure a sensor with initialized driver data and start ranging */
+/* ======================================================*/
+static void StartRanging(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	g_eToFSensorState[eSensor] = STATE_INIT_IN_PROCESS;
 
 	VL53LX_CalibrationData_t CalibrationData;
-	VL53LX_GetCalibrationData(&g_ToFSensorDriverData[eSensor], &CalibrationData);
+	VL53LX_PROFILED(VL53LX_GetCalibrationData, &g_ToFSensorDriverData[eSensor], &CalibrationData);
 
-	if (VL53LX_SetCalibrationData(&g_ToFSensorDriverData[eSensor], &CalibrationData))
+	if (VL53LX_PROFILED(VL53LX_SetCalibrationData, &g_ToFSensorDriverData[eSensor], &CalibrationData))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	if (VL53LX_SetDistanceMode(&g_ToFSensorDriverData[eSensor], 1))
+	if (VL53LX_PROFILED(VL53LX_SetDistanceMode, &g_ToFSensorDriverData[eSensor], 1))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	if (VL53LX_SetTuningParameter(&g_ToFSensorDriverData[eSensor], VL53LX_TUNINGPARM_PHASECAL_PATCH_POWER, 2))
+	// Every shelf starts with fast ranging until it is found to be stable
+	g_arrToFCadence[eSensor].m_eCadence     = TOF_CADENCE_SLOW;
+	g_arrToFCadence[eSensor].m_nStableSince = HAL_GetTick();
+	SetCadence(eSensor, TOF_CADENCE_FAST);
+
+	if (VL53LX_PROFILED(VL53LX_SetTuningParameter, &g_ToFSensorDriverData[eSensor], VL53LX_TUNINGPARM_PHASECAL_PATCH_POWER, 2))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	if (VL53LX_SmudgeCorrectionEnable(&g_ToFSensorDriverData[eSensor], VL53LX_SMUDGE_CORRECTION_CONTINUOUS))
+	if (VL53LX_PROFILED(VL53LX_SmudgeCorrectionEnable, &g_ToFSensorDriverData[eSensor], VL53LX_SMUDGE_CORRECTION_CONTINUOUS))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	if (VL53LX_StartMeasurement(&g_ToFSensorDriverData[eSensor]))
+	if (VL53LX_PROFILED(VL53LX_StartMeasurement, &g_ToFSensorDriverData[eSensor]))
 	{
 		LEDs_SetLEDState(RED_LED, LED_ON);
 	}
 
-	for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
-	{
-		g_arrLeftItems[i] = 0;
-	}
+	g_arrLeftItems[eSensor] = 0;
+	UpdateItemWindow(eSensor);
 }
 
-/* @brief: This function is called in the main loop.
- *         It implements the device driver state machine
+/* @brief Latch the fetched histogram and re-arm the sensor right away, so
+ *        the next measurement integrates while this one waits for its
+ *        post-processing. The last measurement is latched without re-arming,
+ *        a stream stops once the sensor has fallen back to the slow cadence.
+ * @param eState - the state in which the data ready event has been received
  */
 /* ======================================================*/
-void ToF_Exec()
+static void ProcessFetchedData(TOF_SUPPORTED_SENSORS eSensor, TOF_STATE eState)
 /* ======================================================*/
 {
-	for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
+	if (VL53LX_PROFILED(VL53LX_FetchMultiRangingData, &g_ToFSensorDriverData[eSensor]))
 	{
-		// ToF sensor is not initialized
-		if (g_eToFSensorState[i] == STATE_NOT_INIT || g_eToFSensorState[i] == STATE_ERROR)
-		{
-			continue;
-		}
-
-		// ToF sensor is initializing
-		else if (g_eToFSensorState[i] == STATE_INIT_IN_PROCESS)
-		{
-			// Check if interrupt has occurred
-			if (HAL_GPIO_ReadPin(g_arrToFPorts[i], g_arrToFGPIOs[i].Pin) == GPIO_PIN_RESET)
-			{
-				if(!VL53LX_GetMultiRangingData(&g_ToFSensorDriverData[i], &g_ToFSensorMeasurementData[i]))
-				{
-					// Perform measurement which has to be ignored
-					if (!VL53LX_ClearInterruptAndStartMeasurement(&g_ToFSensorDriverData[i]))
-					{
-						g_eToFSensorState[i] = STATE_IGNORE_FIRST_DATA;
-					}
-					else
-					{
-						g_eToFSensorState[i] = STATE_ERROR;
-					}
-				}
-				else
-				{
-					g_eToFSensorState[i] = STATE_ERROR;
-				}
-			}
-		}
-
-		// First data needs to be ignored (when the distance is changing)
-		else if (g_eToFSensorState[i] == STATE_IGNORE_FIRST_DATA)
-		{
-			// Check if interrupt has occurred
-			if (HAL_GPIO_ReadPin(g_arrToFPorts[i], g_arrToFGPIOs[i].Pin) == GPIO_PIN_RESET)
-			{
-				if(!VL53LX_GetMultiRangingData(&g_ToFSensorDriverData[i], &g_ToFSensorMeasurementData[i]))
-				{
-					// Perform measurement which has to be ignored
-					if (!VL53LX_ClearInterruptAndStartMeasurement(&g_ToFSensorDriverData[i]))
-					{
-						g_eToFSensorState[i] = STATE_MEASURING;
-					}
-					else
-					{
-						g_eToFSensorState[i] = STATE_ERROR;
-					}
-				}
-				else
-				{
-					g_eToFSensorState[i] = STATE_ERROR;
-				}
-			}
-		}
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+		return;
+	}
 
-		else if (g_eToFSensorState[i] == STATE_PENDING_MEASUREMENT)
-		{
-			ToF_Measure(i);
-		}
+	g_arrToFProcessingPending[eSensor] = 1;
+	g_arrToFLatchedOrigin[eSensor]     = eState;
 
-		// ToF sensor is performing measurement
-		else if (g_eToFSensorState[i] == STATE_MEASURING)
-		{
-			// Check if interrupt has occurred
-			if (HAL_GPIO_ReadPin(g_arrToFPorts[i], g_arrToFGPIOs[i].Pin) == GPIO_PIN_RESET)
-			{
-				if(!VL53LX_GetMultiRangingData(&g_ToFSensorDriverData[i], &g_ToFSensorMeasurementData[i]))
-				{
-					g_eToFSensorState[i] = STATE_IDLE;
-					CalculateLeftShelfItems(i);
-				}
-				else
-				{
-					g_eToFSensorState[i] = STATE_ERROR;
-				}
-			}
-		}
+	if (eState == STATE_MEASURING ||
+		(eState == STATE_STREAMING && g_arrToFCadence[eSensor].m_eCadence != TOF_CADENCE_FAST))
+	{
+		g_eToFSensorState[eSensor] = STATE_PROCESSING;
+	}
+	else if (VL53LX_PROFILED(VL53LX_ClearInterruptAndStartMeasurement, &g_ToFSensorDriverData[eSensor]))
+	{
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+	}
+	else
+	{
+		g_eToFSensorState[eSensor] = (eState == STATE_IGNORE_FIRST_DATA) ? STATE_MEASURING : STATE_STREAMING;
 	}
 }
 
+/* @brief Run the histogram post-processing of the latched measurement.
+ *        The result of an ignored measurement is only used to keep the
+ *        driver's history (crosstalk, merging) up to date, every other fresh
+ *        measurement - including each frame of a stream - is consumed.
+ */
 /* ======================================================*/
-TOF_STATUS ToF_Measure(TOF_SUPPORTED_SENSORS eSensor)
+static void ProcessLatchedData(TOF_SUPPORTED_SENSORS eSensor)
 /* ======================================================*/
 {
-	TOF_STATUS eStatus = TOF_STATUS_OK;
+	g_arrToFProcessingPending[eSensor] = 0;
+
+	// Only the closest target is used, so the other ones are not converted
+	if (VL53LX_PROFILED(VL53LX_ProcessPrimaryRangingData, &g_ToFSensorDriverData[eSensor], &g_ToFSensorMeasurementData[eSensor]))
+	{
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+		return;
+	}
+
+	if (g_eToFSensorState[eSensor] == STATE_PROCESSING)
+	{
+		g_eToFSensorState[eSensor] = STATE_IDLE;
+	}
 
-	if (g_eToFSensorState[eSensor] == STATE_IDLE || g_eToFSensorState[eSensor] == STATE_PENDING_MEASUREMENT)
+	if (g_arrToFLatchedOrigin[eSensor] != STATE_IGNORE_FIRST_DATA && IsFreshFrame(eSensor))
 	{
-		if(!VL53LX_GetMultiRangingData(&g_ToFSensorDriverData[eSensor], &g_ToFSensorMeasurementData[eSensor]))
+		TOF_MEASUREMENT_RECORD sRecord;
+
+		g_ToFSensorMeasurementData[eSensor].TimeStamp = g_arrToFLatchedTimestamp[eSensor];
+
+		// The range results are only valid until the next post-processing, so the frame is captured right away
+		if (HistCapture_IsEnabled(eSensor))
 		{
-			if (!VL53LX_ClearInterruptAndStartMeasurement(&g_ToFSensorDriverData[eSensor]))
-			{
-				g_eToFSensorState[eSensor] = STATE_IGNORE_FIRST_DATA;
-			}
-			else
+			VL53LX_histogram_bin_data_t *pHistogram;
+			VL53LX_range_results_t      *pResults;
+
+			if (VL53LX_GetProcessedHistogramData(&g_ToFSensorDriverData[eSensor], &pHistogram, &pResults) == VL53LX_ERROR_NONE)
 			{
-				eStatus                    = TOF_STATUS_ERROR;
-				g_eToFSensorState[eSensor] = STATE_ERROR;
+				HistCapture_Frame(eSensor, g_arrToFLatchedTimestamp[eSensor], pHistogram, pResults);
 			}
 		}
-		else
-		{
-			g_eToFSensorState[eSensor] = STATE_ERROR;
-		}
-	}
-	else
-	{
-		eStatus = TOF_STATUS_ERROR;
-	}
 
-	return eStatus;
+		RecordMeasurement(eSensor);
+		ToF_GetLatestRecord(eSensor, &sRecord);
+		CalculateLeftShelfItems(eSensor, &sRecord);
+		UpdateCadence(eSensor, &sRecord);
+	}
 }
 
+/* @brief  Check the stream count of the processed measurement against the last
+ *         consumed one, so the same frame is never consumed twice
+ * @retval uint8_t - 1 if the measurement has not been consumed yet
+ */
 /* ======================================================*/
-VL53LX_MultiRangingData_t* ToF_GetDistance_mm(TOF_SUPPORTED_SENSORS eSensor)
+static uint8_t IsFreshFrame(TOF_SUPPORTED_SENSORS eSensor)
 /* ======================================================*/
 {
-	VL53LX_MultiRangingData_t* pData = NULL;
+	uint8_t nStreamCount = g_ToFSensorMeasurementData[eSensor].StreamCount;
 
-	if (g_eToFSensorState[eSensor] == STATE_IDLE)
+	if (g_arrToFStreamCountValid[eSensor] && g_arrToFLastStreamCount[eSensor] == nStreamCount)
 	{
-		pData = &g_ToFSensorMeasurementData[eSensor];
+		return 0;
 	}
 
-	return pData;
+	g_arrToFLastStreamCount[eSensor]  = nStreamCount;
+	g_arrToFStreamCountValid[eSensor] = 1;
+
+	return 1;
 }
 
+
+/* @brief Configure the XSHUT pin and the data ready pin of the selected sensor.
+ *        The data ready pin is connected to its EXTI line unless the line is
+ *        already routed to another port - e.g. PC3 shares EXTI3 with the
+ *        BlueNRG IRQ on PA3. Such sensor falls back to polling of the pin.
+ */
 /* ======================================================*/
-uint8_t ToF_GetLeftItems(TOF_SUPPORTED_SENSORS eSensor)
+static void GPIO_Init(TOF_SUPPORTED_SENSORS eSensor)
 /* ======================================================*/
 {
-	if (eSensor < SENSORS_SUPPORTED)
+	GPIO_InitTypeDef GPIO_InitStruct = g_arrToFGPIOs[eSensor];
+
+	if (IsExtiLineFree(g_arrToFPorts[eSensor], GPIO_InitStruct.Pin))
 	{
-		return g_arrLeftItems[eSensor];
+		g_arrToFMeasuringMode[eSensor] = TOF_MEASURING_MODE_INTERRUPT;
+		HAL_GPIO_Init(g_arrToFPorts[eSensor], &GPIO_InitStruct);
+
+		HAL_NVIC_SetPriority(g_arrToFIRQs[eSensor], TOF_DATA_READY_IRQ_PRIORITY, 0);
+		HAL_NVIC_EnableIRQ(g_arrToFIRQs[eSensor]);
 	}
 	else
 	{
-		return 0;
+		g_arrToFMeasuringMode[eSensor] = TOF_MEASURING_MODE_POLLING;
+		GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+		HAL_GPIO_Init(g_arrToFPorts[eSensor], &GPIO_InitStruct);
 	}
+
+	HAL_GPIO_Init(g_arrToFXShutDownPorts[eSensor], &g_arrToFXShutDownPin[eSensor]);
 }
 
+/* @brief  Check if the EXTI line of a pin is unused or already routed to the pin's port
+ * @retval uint8_t - 1 if the line could be used for the pin
+ */
 /* ======================================================*/
-void ToF_InitiateMeasurement(TOF_SUPPORTED_SENSORS eSensor)
+static uint8_t IsExtiLineFree(GPIO_TypeDef *pPort, uint16_t nPin)
 /* ======================================================*/
 {
-	if (eSensor < SENSORS_SUPPORTED)
+	return ((EXTI->IMR1 & nPin) == 0U || IsExtiLineRoutedTo(pPort, nPin));
+}
+
+/* @brief  Check if the EXTI line of a pin is routed to the pin's port
+ * @retval uint8_t - 1 if the line belongs to the pin
+ */
+/* ======================================================*/
+static uint8_t IsExtiLineRoutedTo(GPIO_TypeDef *pPort, uint16_t nPin)
+/* ======================================================*/
+{
+	uint32_t nLine   = POSITION_VAL(nPin);
+	uint32_t nSource = (EXTI->EXTICR[nLine >> 2U] >> (8U * (nLine & 0x03U))) & 0xFFU;
+
+	return (nSource == GPIO_GET_INDEX(pPort));
+}
+
+/* @brief Raise data ready events of the sensors which could not use EXTI.
+ *        GPIO1 stays low until the interrupt is cleared, so the pin is only
+ *        sampled while the sensor is expected to produce data.
+ */
+/* ======================================================*/
+static void SampleDataReadyPins(void)
+/* ======================================================*/
+{
+	for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
 	{
-		if (g_eToFSensorState[eSensor] == STATE_IDLE)
+		TOF_STATE eState = g_eToFSensorState[i];
+
+		if (g_arrToFMeasuringMode[i] == TOF_MEASURING_MODE_POLLING &&
+			(eState == STATE_INIT_IN_PROCESS || eState == STATE_IGNORE_FIRST_DATA ||
+			 eState == STATE_MEASURING || eState == STATE_STREAMING || eState == STATE_PARKED) &&
+			!g_arrToFDataReady[i].m_bDataReady &&
+			HAL_GPIO_ReadPin(g_arrToFPorts[i], g_arrToFGPIOs[i].Pin) == GPIO_PIN_RESET)
 		{
-			g_eToFSensorState[eSensor] = STATE_PENDING_MEASUREMENT;
+			g_arrToFDataReady[i].m_nTimestamp = System_GetMicros();
+			g_arrToFDataReady[i].m_bDataReady = 1;
 		}
 	}
 }
 
-
-/* Private function definitions  -----------------------------------------------*/
-/**
- * @brief I2C1 Initialization Function
- * @param None
- * @retval None
- */
+// @brief Append the primary target of the last consumed measurement to the history of the sensor
 /* ======================================================*/
-static void I2C_Init(void)
+static void RecordMeasurement(TOF_SUPPORTED_SENSORS eSensor)
 /* ======================================================*/
 {
-	hi2c1.Instance = I2C1;
-	hi2c1.Init.Timing = 0x2050133E;
-	hi2c1.Init.OwnAddress1 = 0;
-	hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
-	hi2c1.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
-	hi2c1.Init.OwnAddress2 = 0;
-	hi2c1.Init.OwnAddress2Masks = I2C_OA2_NOMASK;
-	hi2c1.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
-	hi2c1.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+	VL53LX_PrimaryRangingData_t *pData    = &g_ToFSensorMeasurementData[eSensor];
+	TOF_MEASUREMENT_HISTORY     *pHistory = &g_arrToFHistory[eSensor];
+	TOF_MEASUREMENT_RECORD      *pRecord  = &pHistory->m_arrRecords[pHistory->m_nWritten & (TOF_HISTORY_SIZE - 1)];
+
+	pRecord->m_nTimestamp   = pData->TimeStamp;
+	pRecord->m_nStreamCount = pData->StreamCount;
 
-	if (HAL_I2C_Init(&hi2c1) != HAL_OK)
+	if (pData->NumberOfObjectsFound)
 	{
-		LEDs_SetLEDState(RED_LED, LED_ON);
+		pRecord->m_nRange_mm    = pData->RangeData.RangeMilliMeter;
+		pRecord->m_nSigma_mm    = CompressFixPoint1616(pData->RangeData.SigmaMilliMeter, 8);
+		pRecord->m_nSignalRate  = CompressFixPoint1616(pData->RangeData.SignalRateRtnMegaCps, 7);
+		pRecord->m_nAmbientRate = CompressFixPoint1616(pData->RangeData.AmbientRateRtnMegaCps, 7);
+		pRecord->m_nRangeStatus = pData->RangeData.RangeStatus;
 	}
-	/** Configure Analogue filter
-	 */
-	if (HAL_I2CEx_ConfigAnalogFilter(&hi2c1, I2C_ANALOGFILTER_ENABLE) != HAL_OK)
+	else
 	{
-		LEDs_SetLEDState(RED_LED, LED_ON);
+		pRecord->m_nRange_mm    = 0;
+		pRecord->m_nSigma_mm    = 0;
+		pRecord->m_nSignalRate  = 0;
+		pRecord->m_nAmbientRate = 0;
+		pRecord->m_nRangeStatus = VL53LX_RANGESTATUS_NONE;
 	}
 
-	if (HAL_I2CEx_ConfigDigitalFilter(&hi2c1, 0) != HAL_OK)
-	{
-		LEDs_SetLEDState(RED_LED, LED_ON);
-	}
+	pHistory->m_nWritten++;
 }
 
+// @brief Convert a 16.16 fixed point value to a saturated 16 bit one with the given fractional bits
 /* ======================================================*/
-void GPIO_Init(TOF_SUPPORTED_SENSORS eSensor)
+static uint16_t CompressFixPoint1616(FixPoint1616_t nValue, uint8_t nFractionalBits)
 /* ======================================================*/
 {
-	HAL_GPIO_Init(g_arrToFPorts[eSensor], &g_arrToFGPIOs[eSensor]);
-	HAL_GPIO_Init(g_arrToFXShutDownPorts[eSensor], &g_arrToFXShutDownPin[eSensor]);
+	uint32_t nCompressed = nValue >> (16 - nFractionalBits);
+
+	return (nCompressed > UINT16_MAX) ? UINT16_MAX : (uint16_t)nCompressed;
 }
 
 // @brief Calculate left items on the corresponding shelf
 /* ======================================================*/
-void CalculateLeftShelfItems(TOF_SUPPORTED_SENSORS eSensor)
+void CalculateLeftShelfItems(TOF_SUPPORTED_SENSORS eSensor, const TOF_MEASUREMENT_RECORD *pRecord)
 /* ======================================================*/
 {
-	static uint8_t m_arrShelvesLeftItems[SENSORS_SUPPORTED];
-	static uint8_t m_nDebounceCounters[SENSORS_SUPPORTED];
-
-	VL53LX_MultiRangingData_t* pData = ToF_GetDistance_mm(eSensor);
-	int16_t nMeasuredDistanceRaw_mm     = 0;
-	int16_t nMeasuredDistance_mm        = 0;
-
-	if (pData != NULL)
+	if (pRecord != NULL)
 	{
-		if (pData->RangeData[0].RangeStatus == VL53LX_RANGESTATUS_RANGE_VALID)
+		if (pRecord->m_nRangeStatus == VL53LX_RANGESTATUS_RANGE_VALID)
 		{
-			/* Check the measured distance and based on this determine how many items are left
-			 * In order to say that a measurement is valid, 3 consecutive measurements has to be the
-			 * in the same measurement area.
+			/* Check the measured distance and based on this determine how many items are left.
+			 * The distance is averaged over the consecutive measurements, a new stock is
+			 * accepted when the average is far enough from its boundaries.
 			 */
 			uint8_t shelfLeftItems;
-			float shelfRemovedItems;
-			nMeasuredDistanceRaw_mm = pData->RangeData[eSensor].RangeMilliMeter;
-			nMeasuredDistance_mm    = PolyfitRawDistance(nMeasuredDistanceRaw_mm);
 			SHELF_TYPES eShelfType  = EEPROM_GetShelfType(eSensor);
-			uint8_t eShelfMaxItems  = EEPROM_GetShelfInitialStock(eSensor);
 
 			if (eShelfType == DRINK)
 			{
-				if (nMeasuredDistance_mm < TOF_INITIAL_OFFSET_MM)
-				{
-					shelfLeftItems = eShelfMaxItems;
-				}
-				else if (nMeasuredDistance_mm > ((eShelfMaxItems) * (DRINK_SIZE_MM + TOF_DISTANCE_BETWEEN_ITEMS_MM) + TOF_INITIAL_OFFSET_MM))
-				{
-					shelfLeftItems = 0;
-				}
-				else
+				if (Stock_Filter(&g_arrToFStock[eSensor], pRecord->m_nRange_mm, pRecord->m_nSigma_mm, pRecord->m_nSignalRate, &shelfLeftItems) && g_arrLeftItems[eSensor] != shelfLeftItems)
 				{
-					shelfRemovedItems = round(((float)(nMeasuredDistance_mm - TOF_INITIAL_OFFSET_MM) / (DRINK_SIZE_MM + TOF_DISTANCE_BETWEEN_ITEMS_MM)));
-					shelfLeftItems = eShelfMaxItems - shelfRemovedItems;//((nMeasuredDistance_mm - TOF_INITIAL_OFFSET_MM) / (DRINK_SIZE_MM + TOF_DISTANCE_BETWEEN_ITEMS_MM));
+					g_arrLeftItems[eSensor] = shelfLeftItems;
+					UpdateItemWindow(eSensor);
 
-					if (shelfLeftItems < 0)
-					{
-						shelfLeftItems = 0;
-					}
-					if (shelfLeftItems > eShelfMaxItems)
+					/* Check the first ToF measurement. If the left stock value is different from the one
+					 * written in the EEPROM (before device turn off), raise a warning!
+					 */
+					if (g_arrToFSensorsMeasurementPerformed[eSensor] == MEASUREMENT_NOT_PERFORMED)
 					{
-						shelfLeftItems = eShelfMaxItems;
-					}
-				}
+						g_arrToFSensorsMeasurementPerformed[eSensor] = MEASUREMENT_PERFORMED;
 
-				if (g_arrLeftItems[eSensor] != shelfLeftItems)
-				{
-					if (m_arrShelvesLeftItems[eSensor] == shelfLeftItems)
-					{
-						if (++m_nDebounceCounters[eSensor] == 3)
+						if (shelfLeftItems > EEPROM_GetShelfLeftStock(eSensor))
 						{
-							g_arrLeftItems[eSensor]      = shelfLeftItems;
-							m_nDebounceCounters[eSensor] = 0;
-
-							/* Check the first ToF measurement. If the left stock value is different from the one
-							 * written in the EEPROM (before device turn off), raise a warning!
-							 */
-							if (g_arrToFSensorsMeasurementPerformed[eSensor] == MEASUREMENT_NOT_PERFORMED)
-							{
-								g_arrToFSensorsMeasurementPerformed[eSensor] = MEASUREMENT_PERFORMED;
-
-								if (shelfLeftItems > EEPROM_GetShelfLeftStock(eSensor))
-								{
-									Log_SetLogType(LOG_TYPE_WARNING);
-									Log_SetLogWarning(WARNING_STOCK_ADDED);
-								}
-
-								else if (shelfLeftItems < EEPROM_GetShelfLeftStock(eSensor))
-								{
-									Log_SetLogType(LOG_TYPE_WARNING);
-									Log_SetLogWarning(WARNING_STOCK_TAKEN);
-								}
-							}
+							Log_SetLogType(LOG_TYPE_WARNING);
+							Log_SetLogWarning(WARNING_STOCK_ADDED);
+						}
+
+						else if (shelfLeftItems < EEPROM_GetShelfLeftStock(eSensor))
+						{
+							Log_SetLogType(LOG_TYPE_WARNING);
+							Log_SetLogWarning(WARNING_STOCK_TAKEN);
 						}
-					}
-					else
-					{
-						m_arrShelvesLeftItems[eSensor] = shelfLeftItems;
-						m_nDebounceCounters[eSensor]   = 0;
 					}
 				}
 			}
@@ -439,24 +1016,155 @@ void CalculateLeftShelfItems(TOF_SUPPORTED_SENSORS eSensor)
 	}
 }
 
-/*
- * @brief  This function fits the measured distance with a polynomial in order to get the real distance
- * @param  nRawDistance - measured distance by the ToF sensor
- * @retval int16_t - polynomial fitted distance in [mm.] units
+/* @brief Switch the sensor to fast ranging as soon as the front item leaves
+ *        its item window or the stock changes. After it has been stable for
+ *        TOF_STABLE_TIME_TO_SLOW_DOWN_MS a shelf with an item window is parked
+ *        (ServiceSensor), any other falls back to slow ranging.
+ */
+/* ======================================================*/
+static void UpdateCadence(TOF_SUPPORTED_SENSORS eSensor, const TOF_MEASUREMENT_RECORD *pRecord)
+/* ======================================================*/
+{
+	TOF_CADENCE_CONTROL *pCadence = &g_arrToFCadence[eSensor];
+	TOF_ITEM_WINDOW     *pWindow  = &g_arrToFItemWindow[eSensor];
+	uint32_t nNow = HAL_GetTick();
+
+	if (pRecord->m_nRangeStatus != VL53LX_RANGESTATUS_RANGE_VALID)
+	{
+		return;
+	}
+
+	// Something has crossed an item boundary (an item is being taken or put back) or the stock has changed
+	if (pRecord->m_nRange_mm < pWindow->m_nLow_mm || pRecord->m_nRange_mm >= pWindow->m_nHigh_mm ||
+		pCadence->m_nReferenceLeftItems != g_arrLeftItems[eSensor])
+	{
+		pCadence->m_nReferenceLeftItems = g_arrLeftItems[eSensor];
+		pCadence->m_nStableSince        = nNow;
+		pCadence->m_bParkRequested      = 0;
+		SetCadence(eSensor, TOF_CADENCE_FAST);
+	}
+	else if ((nNow - pCadence->m_nStableSince) >= TOF_STABLE_TIME_TO_SLOW_DOWN_MS)
+	{
+		if (pWindow->m_nLow_mm != INT16_MIN || pWindow->m_nHigh_mm != INT16_MAX)
+		{
+			pCadence->m_bParkRequested = (pCadence->m_eCadence == TOF_CADENCE_FAST);
+		}
+		else
+		{
+			SetCadence(eSensor, TOF_CADENCE_SLOW);
+		}
+	}
+}
+
+/* @brief Take the item window of the current stock from the boundary table
+ *        of the shelf, so it changes exactly where the stock estimation does.
+ */
+/* ======================================================*/
+static void UpdateItemWindow(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	g_arrToFItemWindow[eSensor].m_nLow_mm  = INT16_MIN;
+	g_arrToFItemWindow[eSensor].m_nHigh_mm = INT16_MAX;
+
+	if (EEPROM_GetShelfType(eSensor) != DRINK)
+	{
+		return;
+	}
+
+	Stock_GetWindow(&g_arrToFStock[eSensor], g_arrLeftItems[eSensor],
+					&g_arrToFItemWindow[eSensor].m_nLow_mm, &g_arrToFItemWindow[eSensor].m_nHigh_mm);
+}
+
+/* @brief Apply the timing budget of the selected cadence. It takes effect
+ *        with the next start of the measurement, the measurement period is
+ *        applied by ToF_InitiateMeasurementAll.
+ */
+/* ======================================================*/
+static void SetCadence(TOF_SUPPORTED_SENSORS eSensor, TOF_CADENCE eCadence)
+/* ======================================================*/
+{
+	uint32_t nTimingBudget_us = (eCadence == TOF_CADENCE_SLOW) ? TOF_SLOW_TIMING_BUDGET_US : TOF_FAST_TIMING_BUDGET_US;
+
+	if (g_arrToFCadence[eSensor].m_eCadence == eCadence)
+	{
+		return;
+	}
+
+	if (VL53LX_PROFILED(VL53LX_SetMeasurementTimingBudgetMicroSeconds, &g_ToFSensorDriverData[eSensor], nTimingBudget_us))
+	{
+		LEDs_SetLEDState(RED_LED, LED_ON);
+	}
+	else
+	{
+		g_arrToFCadence[eSensor].m_eCadence = eCadence;
+	}
+}
+
+/* @brief Park the sensor - it ranges on its own in standard ranging mode and
+ *        raises GPIO1 only when the front item leaves the item window (or no
+ *        target is found). Nothing is read from it until then.
+ */
+/* ======================================================*/
+static void Park(TOF_SUPPORTED_SENSORS eSensor)
+/* ======================================================*/
+{
+	TOF_ITEM_WINDOW *pWindow = &g_arrToFItemWindow[eSensor];
+	uint16_t nLow_mm  = (pWindow->m_nLow_mm < 0) ? 0 : (uint16_t)pWindow->m_nLow_mm;
+	uint16_t nHigh_mm = (pWindow->m_nHigh_mm < 0) ? 0 : (uint16_t)pWindow->m_nHigh_mm;
+
+	g_arrToFCadence[eSensor].m_bParkRequested = 0;
+
+	if (VL53LX_PROFILED(VL53LX_StartThresholdRanging, &g_ToFSensorDriverData[eSensor], nLow_mm, nHigh_mm,
+						TOF_PARKED_MEASUREMENT_PERIOD_MS))
+	{
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+		return;
+	}
+
+	// The data ready event of the stopped stream is stale
+	g_arrToFDataReady[eSensor].m_bDataReady = 0;
+	g_arrToFCadence[eSensor].m_eCadence     = TOF_CADENCE_PARKED;
+	g_eToFSensorState[eSensor]              = STATE_PARKED;
+}
+
+/* @brief Restore the histogram ranging of a parked sensor and stream on the
+ *        fast cadence, as the sensor was when it has been parked
  */
 /* ======================================================*/
-int16_t PolyfitRawDistance(int16_t nRawDistance)
+static void Unpark(TOF_SUPPORTED_SENSORS eSensor)
 /* ======================================================*/
 {
-	float fDistancePolynomialFit = (float)nRawDistance * TOF_POLYFIT_COEF_A + TOF_POLYFIT_COEF_B;
+	if (VL53LX_PROFILED(VL53LX_StopThresholdRanging, &g_ToFSensorDriverData[eSensor]) ||
+		VL53LX_PROFILED(VL53LX_StartMeasurement, &g_ToFSensorDriverData[eSensor]))
+	{
+		g_eToFSensorState[eSensor] = STATE_ERROR;
+		return;
+	}
 
-	return (int16_t)fDistancePolynomialFit;
+	// The stream count restarts with the measurement
+	g_arrToFStreamCountValid[eSensor]       = 0;
+	g_arrToFCadence[eSensor].m_eCadence     = TOF_CADENCE_FAST;
+	g_arrToFCadence[eSensor].m_nStableSince = HAL_GetTick();
+	g_eToFSensorState[eSensor]              = STATE_STREAMING;
 }
 
+/* @brief Data ready interrupt of the sensors - it only records the event and its time */
 /* ======================================================*/
-void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+void HAL_GPIO_EXTI_Falling_Callback(uint16_t GPIO_Pin)
 /* ======================================================*/
 {
-	HAL_GPIO_WritePin(LED_RED_GPIO_Port, LED_RED_Pin, GPIO_PIN_SET);
+	uint32_t nTimestamp = System_GetMicros();
+
+	for (uint8_t i = 0; i < SENSORS_SUPPORTED; i++)
+	{
+		// The same pin number of another port shares the EXTI line, so the line has to be routed to this sensor
+		if (g_arrToFMeasuringMode[i] == TOF_MEASURING_MODE_INTERRUPT && g_arrToFGPIOs[i].Pin == GPIO_Pin &&
+			IsExtiLineRoutedTo(g_arrToFPorts[i], GPIO_Pin))
+		{
+			g_arrToFDataReady[i].m_nTimestamp = nTimestamp;
+			g_arrToFDataReady[i].m_bDataReady = 1;
+		}
+	}
 }
+
 /* ======================================================*/
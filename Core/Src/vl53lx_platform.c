@@ -45,6 +45,8 @@ unsigned char SPI2C_Buffer[256];
 #include "vl53lx_api.h"
 
 #include "stm32xxx_hal.h"
+#include "system.h"
+#include "vl53lx_register_map.h"
 #include <time.h>
 #include <math.h>
 
@@ -63,11 +65,19 @@ unsigned char SPI2C_Buffer[256];
 //extern I2C_HandleTypeDef hi2c1;
 //#define VL53L0X_pI2cHandle    (&hi2c1)
 
+/* The sensors can be on any of the I2C controllers, I2C1 is shared with the
+ * X-NUCLEO-53L3A2 expanders and display. Used in the functions taking Dev,
+ * VL53LX_GetI2cBus() is 0 when the bus has been granted.
+ */
+#define VL53LX_GetI2cBus() \
+    ((I2CBus_Acquire((I2C_BUS_ID)Dev->I2cBus, I2C_BUS_CLIENT_TOF, I2C_BUS_PRIORITY_NORMAL) == I2C_BUS_STATUS_OK) ? 0 : -1)
+#define VL53LX_PutI2cBus() I2CBus_Release((I2C_BUS_ID)Dev->I2cBus, I2C_BUS_CLIENT_TOF)
+
 /* when not customized by application define dummy one */
 #ifndef VL53LX_GetI2cBus
 /** This macro can be overloaded by user to enforce i2c sharing in RTOS context
  */
-#   define VL53LX_GetI2cBus(...) (void)0
+#   define VL53LX_GetI2cBus(...) 0
 #endif
 
 #ifndef VL53LX_PutI2cBus
@@ -76,14 +86,128 @@ unsigned char SPI2C_Buffer[256];
 #   define VL53LX_PutI2cBus(...) (void)0
 #endif
 
-uint8_t _I2CBuffer[256];
+/* post-processing scratch shared by all the devices, see VL53LXDevStructGetWorkArea1() */
+uint32_t VL53LX_SharedWorkArea1[VL53LX_WORK_AREA1_SIZE / sizeof(uint32_t)];
+uint32_t VL53LX_SharedWorkArea2[VL53LX_WORK_AREA2_SIZE / sizeof(uint32_t)];
+
+/* one transfer buffer per I2C controller, so the buses don't share state */
+static uint8_t _I2CBuffers[I2C_BUSES_COUNT][256];
+#define _I2CBuffer (_I2CBuffers[Dev->I2cBus])
+
+#ifdef VL53LX_I2C_PROFILER
+/* entry 0 collects the accesses made outside of any VL53LX_PROFILED() call */
+static VL53LX_ProfilerEntry_t _ProfilerEntries[VL53LX_PROFILER_MAX_ENTRIES] = { { "(unscoped)" } };
+static VL53LX_ProfilerEntry_t *_ProfilerActive = NULL;
+static uint32_t _ProfilerDepth = 0;
+static uint32_t _ProfilerStart_us = 0;
+
+static VL53LX_ProfilerEntry_t *_ProfilerFind(const char *name) {
+    uint32_t i;
+
+    for (i = 1; i < VL53LX_PROFILER_MAX_ENTRIES; i++) {
+        if (_ProfilerEntries[i].name == NULL) {
+            _ProfilerEntries[i].name = name;
+            return &_ProfilerEntries[i];
+        }
+        if (_ProfilerEntries[i].name == name || strcmp(_ProfilerEntries[i].name, name) == 0) {
+            return &_ProfilerEntries[i];
+        }
+    }
+    /* table full, keep counting the accesses at least */
+    return &_ProfilerEntries[0];
+}
+
+static void _ProfilerRecord(int32_t index, uint32_t bytes_read, uint32_t bytes_written) {
+    VL53LX_ProfilerEntry_t *entry = (_ProfilerActive != NULL) ? _ProfilerActive : &_ProfilerEntries[0];
+    uint32_t i;
+
+    entry->transactions++;
+    entry->bytes_read += bytes_read;
+    entry->bytes_written += bytes_written;
+    if (index < 0) {
+        return;
+    }
+    for (i = 0; i < entry->register_count; i++) {
+        if (entry->registers[i] == (uint16_t)index) {
+            return;
+        }
+    }
+    if (entry->register_count < VL53LX_PROFILER_MAX_REGISTERS) {
+        entry->registers[entry->register_count++] = (uint16_t)index;
+    } else if (entry->registers_dropped < 0xFFFF) {
+        entry->registers_dropped++;
+    }
+}
+
+void VL53LX_ProfilerBegin(const char *name) {
+    if (_ProfilerDepth++ != 0) {
+        return;
+    }
+    _ProfilerActive = _ProfilerFind(name);
+    _ProfilerStart_us = System_GetMicros();
+}
+
+VL53LX_Error VL53LX_ProfilerEnd(VL53LX_Error status) {
+    uint32_t elapsed_us;
+
+    if (_ProfilerDepth == 0 || --_ProfilerDepth != 0) {
+        return status;
+    }
+    elapsed_us = System_GetMicros() - _ProfilerStart_us;
+    _ProfilerActive->calls++;
+    _ProfilerActive->total_time_us += elapsed_us;
+    if (elapsed_us > _ProfilerActive->max_time_us) {
+        _ProfilerActive->max_time_us = elapsed_us;
+    }
+    _ProfilerActive = NULL;
+    return status;
+}
+
+const VL53LX_ProfilerEntry_t *VL53LX_ProfilerGetEntry(uint32_t entry) {
+    if (entry >= VL53LX_PROFILER_MAX_ENTRIES || _ProfilerEntries[entry].name == NULL) {
+        return NULL;
+    }
+    return &_ProfilerEntries[entry];
+}
+
+void VL53LX_ProfilerReset(void) {
+    uint32_t i;
+
+    for (i = 0; i < VL53LX_PROFILER_MAX_ENTRIES; i++) {
+        const char *name = _ProfilerEntries[i].name;
+
+        memset(&_ProfilerEntries[i], 0, sizeof(_ProfilerEntries[i]));
+        /* keep the names, a scope may be open right now */
+        _ProfilerEntries[i].name = name;
+    }
+}
+#else
+#define _ProfilerRecord(...) (void)0
+
+void VL53LX_ProfilerBegin(const char *name) {
+    (void)name;
+}
+
+VL53LX_Error VL53LX_ProfilerEnd(VL53LX_Error status) {
+    return status;
+}
+
+const VL53LX_ProfilerEntry_t *VL53LX_ProfilerGetEntry(uint32_t entry) {
+    (void)entry;
+    return NULL;
+}
+
+void VL53LX_ProfilerReset(void) {
+}
+#endif
 
 int _I2CWrite(VL53LX_DEV Dev, uint8_t *pdata, uint32_t count) {
     int status;
     int i2c_time_out = I2C_TIME_OUT_BASE+ count* I2C_TIME_OUT_BYTE;
 //    int i;
     i2cwriteCount+=count;
-    status = HAL_I2C_Master_Transmit(Dev->I2cHandle, Dev->I2cDevAddr, pdata, count, i2c_time_out);
+    _ProfilerRecord((count >= 2) ? (int32_t)((pdata[0] << 8) | pdata[1]) : -1, 0, count);
+    status = I2CBus_Transmit((I2C_BUS_ID)Dev->I2cBus, I2C_BUS_CLIENT_TOF, Dev->I2cDevAddr, pdata, count, i2c_time_out);
 
 #if 0 // to be set to 1 to sniff I2C data  !!!!!
     sprintf(SPI2C_Buffer,"0,%d,%d",count,status);
@@ -105,7 +229,8 @@ int _I2CRead(VL53LX_DEV Dev, uint8_t *pdata, uint32_t count) {
     int i2c_time_out = I2C_TIME_OUT_BASE+ count* I2C_TIME_OUT_BYTE;
 
     i2creadCount+=count;
-    status = HAL_I2C_Master_Receive(Dev->I2cHandle, Dev->I2cDevAddr|1, pdata, count, i2c_time_out);
+    _ProfilerRecord(-1, count, 0);
+    status = I2CBus_Receive((I2C_BUS_ID)Dev->I2cBus, I2C_BUS_CLIENT_TOF, Dev->I2cDevAddr|1, pdata, count, i2c_time_out);
     if (status) {
         //VL6180x_ErrLog("I2C error 0x%x %d len", dev->I2cAddr, len);
         //XNUCLEO6180XA1_I2C1_Init(&hi2c1);
@@ -113,16 +238,95 @@ int _I2CRead(VL53LX_DEV Dev, uint8_t *pdata, uint32_t count) {
     return status;
 }
 
-VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
+/* unchanged bytes between two changed ones are still written when a new
+ * transaction (device address + 2 index bytes) would cost more */
+#define _SHADOW_MAX_GAP 3
+
+#ifdef VL53LX_SHADOW_REGISTERS
+
+static uint8_t _ShadowIsCached(uint16_t index) {
+    if (index < VL53LX_SHADOW_FIRST_INDEX || index >= VL53LX_SHADOW_FIRST_INDEX + VL53LX_SHADOW_SIZE) {
+        return 0;
+    }
+    /* status registers inside the static config are owned by the device */
+    if ((index >= VL53LX_NVM_BIST__CTRL && index <= VL53LX_HOST_IF__STATUS) ||
+        index == VL53LX_GPIO__TIO_HV_STATUS || index == VL53LX_GPIO__FIO_HV_STATUS) {
+        return 0;
+    }
+    return 1;
+}
+
+static uint8_t _ShadowIsValid(VL53LX_DEV Dev, uint16_t index) {
+    uint16_t offset = index - VL53LX_SHADOW_FIRST_INDEX;
+
+    return _ShadowIsCached(index) && (Dev->ShadowValid[offset >> 3] & (1 << (offset & 7)));
+}
+
+static uint8_t _ShadowIsUnchanged(VL53LX_DEV Dev, uint16_t index, uint8_t data) {
+    return _ShadowIsValid(Dev, index) && Dev->ShadowRegs[index - VL53LX_SHADOW_FIRST_INDEX] == data;
+}
+
+static void _ShadowStore(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
+    uint32_t i;
+    uint16_t offset;
+
+    for (i = 0; i < count; i++) {
+        if (_ShadowIsCached(index + i)) {
+            offset = index + i - VL53LX_SHADOW_FIRST_INDEX;
+            Dev->ShadowRegs[offset] = pdata[i];
+            Dev->ShadowValid[offset >> 3] |= (1 << (offset & 7));
+        }
+    }
+}
+
+static void _ShadowForget(VL53LX_DEV Dev, uint16_t index, uint32_t count) {
+    uint32_t i;
+    uint16_t offset;
+
+    for (i = 0; i < count; i++) {
+        if (_ShadowIsCached(index + i)) {
+            offset = index + i - VL53LX_SHADOW_FIRST_INDEX;
+            Dev->ShadowValid[offset >> 3] &= ~(1 << (offset & 7));
+        }
+    }
+}
+#else
+#define _ShadowIsValid(...)     0
+#define _ShadowIsUnchanged(...) 0
+#define _ShadowStore(...)       (void)0
+#define _ShadowForget(...)      (void)0
+#endif
+
+void VL53LX_ShadowInvalidate(VL53LX_DEV Dev) {
+#ifdef VL53LX_SHADOW_REGISTERS
+    memset(Dev->ShadowValid, 0, sizeof(Dev->ShadowValid));
+#else
+    (void)Dev;
+#endif
+}
+
+/* A fetched read is stale once the registers it holds are written, a new
+ * measurement is started by the interrupt clear or the device is reset */
+static void _AsyncForget(VL53LX_DEV Dev, uint16_t index, uint32_t count) {
+    if (Dev->AsyncState != VL53LX_ASYNC_DONE || !Dev->AsyncIsRead) {
+        return;
+    }
+    if (index == VL53LX_SYSTEM__INTERRUPT_CLEAR || index == VL53LX_SOFT_RESET ||
+        (index < Dev->AsyncIndex + Dev->AsyncCount && Dev->AsyncIndex < index + count)) {
+        Dev->AsyncState = VL53LX_ASYNC_IDLE;
+    }
+}
+
+static VL53LX_Error _WriteBlock(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
     int status_int;
     VL53LX_Error Status = VL53LX_ERROR_NONE;
-    if (count > sizeof(_I2CBuffer) - 1) {
-        return VL53LX_ERROR_INVALID_PARAMS;
-    }
+
     _I2CBuffer[0] = index>>8;
     _I2CBuffer[1] = index&0xFF;
     memcpy(&_I2CBuffer[2], pdata, count);
-    VL53LX_GetI2cBus();
+    if (VL53LX_GetI2cBus() != 0) {
+        return VL53LX_ERROR_CONTROL_INTERFACE;
+    }
     status_int = _I2CWrite(Dev, _I2CBuffer, count + 2);
     if (status_int != 0) {
         Status = VL53LX_ERROR_CONTROL_INTERFACE;
@@ -131,14 +335,83 @@ VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, u
     return Status;
 }
 
+VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
+    VL53LX_Error Status = VL53LX_ERROR_NONE;
+    uint32_t start = 0;
+    uint32_t end;
+    uint32_t gap;
+    uint32_t i;
+
+    if (count > sizeof(_I2CBuffer) - 2) {
+        return VL53LX_ERROR_INVALID_PARAMS;
+    }
+
+    _AsyncForget(Dev, index, count);
+
+    /* only the runs of bytes the device doesn't hold yet go on the bus */
+    while (start < count && Status == VL53LX_ERROR_NONE) {
+        if (_ShadowIsUnchanged(Dev, index + start, pdata[start])) {
+            start++;
+            continue;
+        }
+        end = start + 1;
+        gap = 0;
+        for (i = start + 1; i < count && gap <= _SHADOW_MAX_GAP; i++) {
+            if (_ShadowIsUnchanged(Dev, index + i, pdata[i])) {
+                gap++;
+            } else {
+                gap = 0;
+                end = i + 1;
+            }
+        }
+        Status = _WriteBlock(Dev, index + start, pdata + start, end - start);
+        start = end;
+    }
+
+    if (Status != VL53LX_ERROR_NONE) {
+        _ShadowForget(Dev, index, count);
+    } else if (index == VL53LX_SOFT_RESET ||
+               (index == VL53LX_TEST_MODE__CTRL && count == 1 && pdata[0] != 0)) {
+        /* the registers go back to their defaults, or the test routine
+         * started by the firmware updates them */
+        VL53LX_ShadowInvalidate(Dev);
+    } else {
+        _ShadowStore(Dev, index, pdata, count);
+    }
+    return Status;
+}
+
 // the ranging_sensor_comms.dll will take care of the page selection
 VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
     VL53LX_Error Status = VL53LX_ERROR_NONE;
     int32_t status_int;
+#ifdef VL53LX_SHADOW_REGISTERS
+    uint32_t i;
+#endif
+
+    /* serve the data already fetched by VL53LX_ReadMultiAsync() */
+    if (Dev->AsyncState == VL53LX_ASYNC_DONE && Dev->AsyncIsRead &&
+        Dev->AsyncIndex == index && Dev->AsyncCount == count) {
+        memcpy(pdata, Dev->AsyncBuffer, count);
+        Dev->AsyncState = VL53LX_ASYNC_IDLE;
+        return Status;
+    }
+
+#ifdef VL53LX_SHADOW_REGISTERS
+    /* the configuration registers are served from RAM once they are known */
+    for (i = 0; i < count && _ShadowIsValid(Dev, index + i); i++)
+        ;
+    if (count > 0 && i == count) {
+        memcpy(pdata, &Dev->ShadowRegs[index - VL53LX_SHADOW_FIRST_INDEX], count);
+        return Status;
+    }
+#endif
 
     _I2CBuffer[0] = index>>8;
     _I2CBuffer[1] = index&0xFF;
-    VL53LX_GetI2cBus();
+    if (VL53LX_GetI2cBus() != 0) {
+        return VL53LX_ERROR_CONTROL_INTERFACE;
+    }
     status_int = _I2CWrite(Dev, _I2CBuffer, 2);
     if (status_int != 0) {
         Status = VL53LX_ERROR_CONTROL_INTERFACE;
@@ -147,65 +420,109 @@ VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, ui
     status_int = _I2CRead(Dev, pdata, count);
     if (status_int != 0) {
         Status = VL53LX_ERROR_CONTROL_INTERFACE;
+        goto done;
     }
+    _ShadowStore(Dev, index, pdata, count);
 done:
     VL53LX_PutI2cBus();
     return Status;
 }
 
-VL53LX_Error VL53LX_WrByte(VL53LX_DEV Dev, uint16_t index, uint8_t data) {
-    VL53LX_Error Status = VL53LX_ERROR_NONE;
-    int32_t status_int;
 
-    _I2CBuffer[0] = index>>8;
-    _I2CBuffer[1] = index&0xFF;
-    _I2CBuffer[2] = data;
+static void _I2CAsyncComplete(I2C_BUS_TRANSACTION *trans) {
+    VL53LX_DEV Dev = (VL53LX_DEV)trans->m_pContext;
 
-    VL53LX_GetI2cBus();
-    status_int = _I2CWrite(Dev, _I2CBuffer, 3);
-    if (status_int != 0) {
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-    }
-    VL53LX_PutI2cBus();
-    return Status;
+    Dev->AsyncState = (trans->m_eState == I2C_TRANSACTION_DONE) ? VL53LX_ASYNC_DONE : VL53LX_ASYNC_ERROR;
 }
 
-VL53LX_Error VL53LX_WrWord(VL53LX_DEV Dev, uint16_t index, uint16_t data) {
-    VL53LX_Error Status = VL53LX_ERROR_NONE;
-    int32_t status_int;
+static VL53LX_Error _I2CStartAsync(VL53LX_DEV Dev, uint16_t index, uint32_t count, uint8_t is_read) {
+    I2C_BUS_TRANSACTION *trans = &Dev->AsyncTransaction;
 
-    _I2CBuffer[0] = index>>8;
-    _I2CBuffer[1] = index&0xFF;
-    _I2CBuffer[2] = data >> 8;
-    _I2CBuffer[3] = data & 0x00FF;
+    if (count > sizeof(Dev->AsyncBuffer) || Dev->AsyncState == VL53LX_ASYNC_BUSY) {
+        return VL53LX_ERROR_INVALID_PARAMS;
+    }
 
-    VL53LX_GetI2cBus();
-    status_int = _I2CWrite(Dev, _I2CBuffer, 4);
-    if (status_int != 0) {
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
+    Dev->AsyncIndex = index;
+    Dev->AsyncCount = count;
+    Dev->AsyncIsRead = is_read;
+    Dev->AsyncState = VL53LX_ASYNC_BUSY;
+
+    /* the histogram readouts are time critical, they go ahead of everything else on the bus */
+    trans->m_eBus = (I2C_BUS_ID)Dev->I2cBus;
+    trans->m_eClient = I2C_BUS_CLIENT_TOF;
+    trans->m_ePriority = is_read ? I2C_BUS_PRIORITY_HIGH : I2C_BUS_PRIORITY_NORMAL;
+    trans->m_nDevAddr = Dev->I2cDevAddr;
+    trans->m_nMemAddr = index;
+    trans->m_nMemAddrSize = I2C_MEMADD_SIZE_16BIT;
+    trans->m_pData = Dev->AsyncBuffer;
+    trans->m_nSize = count;
+    trans->m_bRead = is_read;
+    trans->m_pCallback = _I2CAsyncComplete;
+    trans->m_pContext = Dev;
+
+    if (is_read) {
+        i2creadCount += count;
+        _ProfilerRecord(index, count, 2);
+    } else {
+        i2cwriteCount += count;
+        _ProfilerRecord(index, 0, count + 2);
     }
-    VL53LX_PutI2cBus();
-    return Status;
+    if (I2CBus_Submit(trans) != I2C_BUS_STATUS_OK) {
+        Dev->AsyncState = VL53LX_ASYNC_ERROR;
+        return VL53LX_ERROR_CONTROL_INTERFACE;
+    }
+    return VL53LX_ERROR_NONE;
 }
 
-VL53LX_Error VL53LX_WrDWord(VL53LX_DEV Dev, uint16_t index, uint32_t data) {
+VL53LX_Error VL53LX_ReadMultiAsync(VL53LX_DEV Dev, uint16_t index, uint32_t count) {
+    return _I2CStartAsync(Dev, index, count, 1);
+}
+
+VL53LX_Error VL53LX_WriteMultiAsync(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
+    if (count > sizeof(Dev->AsyncBuffer) || Dev->AsyncState == VL53LX_ASYNC_BUSY) {
+        return VL53LX_ERROR_INVALID_PARAMS;
+    }
+    memcpy(Dev->AsyncBuffer, pdata, count);
+    /* the completion isn't followed here, the shadow reads the registers again */
+    _ShadowForget(Dev, index, count);
+    return _I2CStartAsync(Dev, index, count, 0);
+}
+
+VL53LX_Error VL53LX_PollAsync(VL53LX_DEV Dev, uint8_t *pdone) {
     VL53LX_Error Status = VL53LX_ERROR_NONE;
-    int32_t status_int;
-    _I2CBuffer[0] = index>>8;
-    _I2CBuffer[1] = index&0xFF;
-    _I2CBuffer[2] = (data >> 24) & 0xFF;
-    _I2CBuffer[3] = (data >> 16) & 0xFF;
-    _I2CBuffer[4] = (data >> 8)  & 0xFF;
-    _I2CBuffer[5] = (data >> 0 ) & 0xFF;
-    VL53LX_GetI2cBus();
-    status_int = _I2CWrite(Dev, _I2CBuffer, 6);
-    if (status_int != 0) {
+    uint8_t state = Dev->AsyncState;
+
+    *pdone = (state != VL53LX_ASYNC_BUSY);
+    if (state == VL53LX_ASYNC_ERROR) {
+        Dev->AsyncState = VL53LX_ASYNC_IDLE;
         Status = VL53LX_ERROR_CONTROL_INTERFACE;
     }
-    VL53LX_PutI2cBus();
     return Status;
 }
 
+/* the single register accesses go through the Multi functions, so they use the shadow too */
+VL53LX_Error VL53LX_WrByte(VL53LX_DEV Dev, uint16_t index, uint8_t data) {
+    return VL53LX_WriteMulti(Dev, index, &data, 1);
+}
+
+VL53LX_Error VL53LX_WrWord(VL53LX_DEV Dev, uint16_t index, uint16_t data) {
+    uint8_t buffer[2];
+
+    buffer[0] = data >> 8;
+    buffer[1] = data & 0x00FF;
+    return VL53LX_WriteMulti(Dev, index, buffer, 2);
+}
+
+VL53LX_Error VL53LX_WrDWord(VL53LX_DEV Dev, uint16_t index, uint32_t data) {
+    uint8_t buffer[4];
+
+    buffer[0] = (data >> 24) & 0xFF;
+    buffer[1] = (data >> 16) & 0xFF;
+    buffer[2] = (data >> 8)  & 0xFF;
+    buffer[3] = (data >> 0 ) & 0xFF;
+    return VL53LX_WriteMulti(Dev, index, buffer, 4);
+}
+
 VL53LX_Error VL53LX_UpdateByte(VL53LX_DEV Dev, uint16_t index, uint8_t AndData, uint8_t OrData) {
     VL53LX_Error Status = VL53LX_ERROR_NONE;
     uint8_t data;
@@ -221,73 +538,28 @@ done:
 }
 
 VL53LX_Error VL53LX_RdByte(VL53LX_DEV Dev, uint16_t index, uint8_t *data) {
-    VL53LX_Error Status = VL53LX_ERROR_NONE;
-    int32_t status_int;
-
-	_I2CBuffer[0] = index>>8;
-	_I2CBuffer[1] = index&0xFF;
-    VL53LX_GetI2cBus();
-    status_int = _I2CWrite(Dev, _I2CBuffer, 2);
-    if( status_int ){
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-        goto done;
-    }
-    status_int = _I2CRead(Dev, data, 1);
-    if (status_int != 0) {
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-    }
-done:
-    VL53LX_PutI2cBus();
-    return Status;
+    return VL53LX_ReadMulti(Dev, index, data, 1);
 }
 
 VL53LX_Error VL53LX_RdWord(VL53LX_DEV Dev, uint16_t index, uint16_t *data) {
-    VL53LX_Error Status = VL53LX_ERROR_NONE;
-    int32_t status_int;
+    VL53LX_Error Status;
+    uint8_t buffer[2];
 
-    _I2CBuffer[0] = index>>8;
-	_I2CBuffer[1] = index&0xFF;
-    VL53LX_GetI2cBus();
-    status_int = _I2CWrite(Dev, _I2CBuffer, 2);
-
-    if( status_int ){
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-        goto done;
+    Status = VL53LX_ReadMulti(Dev, index, buffer, 2);
+    if (Status == VL53LX_ERROR_NONE) {
+        *data = ((uint16_t)buffer[0]<<8) + (uint16_t)buffer[1];
     }
-    status_int = _I2CRead(Dev, _I2CBuffer, 2);
-    if (status_int != 0) {
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-        goto done;
-    }
-
-    *data = ((uint16_t)_I2CBuffer[0]<<8) + (uint16_t)_I2CBuffer[1];
-done:
-    VL53LX_PutI2cBus();
     return Status;
 }
 
 VL53LX_Error VL53LX_RdDWord(VL53LX_DEV Dev, uint16_t index, uint32_t *data) {
-    VL53LX_Error Status = VL53LX_ERROR_NONE;
-    int32_t status_int;
+    VL53LX_Error Status;
+    uint8_t buffer[4];
 
-    _I2CBuffer[0] = index>>8;
-	_I2CBuffer[1] = index&0xFF;
-    VL53LX_GetI2cBus();
-    status_int = _I2CWrite(Dev, _I2CBuffer, 2);
-    if (status_int != 0) {
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-        goto done;
+    Status = VL53LX_ReadMulti(Dev, index, buffer, 4);
+    if (Status == VL53LX_ERROR_NONE) {
+        *data = ((uint32_t)buffer[0]<<24) + ((uint32_t)buffer[1]<<16) + ((uint32_t)buffer[2]<<8) + (uint32_t)buffer[3];
     }
-    status_int = _I2CRead(Dev, _I2CBuffer, 4);
-    if (status_int != 0) {
-        Status = VL53LX_ERROR_CONTROL_INTERFACE;
-        goto done;
-    }
-
-    *data = ((uint32_t)_I2CBuffer[0]<<24) + ((uint32_t)_I2CBuffer[1]<<16) + ((uint32_t)_I2CBuffer[2]<<8) + (uint32_t)_I2CBuffer[3];
-
-done:
-    VL53LX_PutI2cBus();
     return Status;
 }
 
@@ -299,8 +571,7 @@ VL53LX_Error VL53LX_GetTickCount(
 
 	VL53LX_Error status  = VL53LX_ERROR_NONE;
 
-	//*ptick_count_ms = timeGetTime();
-	*ptick_count_ms = 0;
+	*ptick_count_ms = HAL_GetTick();
 
 #ifdef VL53LX_LOG_ENABLE
 	trace_print(
@@ -345,22 +616,32 @@ VL53LX_Error VL53LX_GetTickCount(
 
 VL53LX_Error VL53LX_GetTimerFrequency(int32_t *ptimer_freq_hz)
 {
-	*ptimer_freq_hz = 0;
+	/* The timer is the microsecond timebase of the system */
+	*ptimer_freq_hz = 1000000;
 	
 	trace_print(VL53LX_TRACE_LEVEL_INFO, "VL53LX_GetTimerFrequency: Freq : %dHz\n", *ptimer_freq_hz);
 	return VL53LX_ERROR_NONE;
 }
 
+VL53LX_Error VL53LX_GetTimerValue(int32_t *ptimer_count)
+{
+	*ptimer_count = (int32_t)System_GetMicros();
+	return VL53LX_ERROR_NONE;
+}
+
 
 VL53LX_Error VL53LX_WaitMs(VL53LX_Dev_t *pdev, int32_t wait_ms){
 	(void)pdev;
-	HAL_Delay(wait_ms);
+	/* HAL_Delay() waits one extra tick, so the wait is timed in microseconds */
+	if (wait_ms > 0)
+		System_DelayUs((uint32_t)wait_ms * 1000);
     return VL53LX_ERROR_NONE;
 }
 
 VL53LX_Error VL53LX_WaitUs(VL53LX_Dev_t *pdev, int32_t wait_us){
 	(void)pdev;
-	HAL_Delay(wait_us/1000);
+	if (wait_us > 0)
+		System_DelayUs((uint32_t)wait_us);
     return VL53LX_ERROR_NONE;
 }
 
@@ -465,6 +746,43 @@ VL53LX_Error VL53LX_WaitValueMaskEx(
 	return status;
 }
 
+VL53LX_Error VL53LX_PollValueMaskEx(
+	VL53LX_Dev_t *pdev,
+	uint32_t      timeout_ms,
+	uint16_t      index,
+	uint8_t       value,
+	uint8_t       mask,
+	uint8_t      *pdone)
+{
+	VL53LX_Error status          = VL53LX_ERROR_NONE;
+	uint32_t     current_time_ms = 0;
+	uint8_t      byte_value      = 0;
+
+	*pdone = 0;
+
+	VL53LX_GetTickCount(&current_time_ms);
+
+	/* first call of this wait - start the timeout */
+	if (!pdev->PollActive) {
+		pdev->PollActive  = 1;
+		pdev->PollStartMs = current_time_ms;
+	}
+
+	status = VL53LX_RdByte(pdev, index, &byte_value);
+
+	if (status == VL53LX_ERROR_NONE) {
+		if ((byte_value & mask) == value)
+			*pdone = 1;
+		else if ((current_time_ms - pdev->PollStartMs) >= timeout_ms)
+			status = VL53LX_ERROR_TIME_OUT;
+	}
+
+	if (status != VL53LX_ERROR_NONE || *pdone)
+		pdev->PollActive = 0;
+
+	return status;
+}
+
 
 
 
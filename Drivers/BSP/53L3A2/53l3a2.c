@@ -9,6 +9,7 @@
 #include  "53L3A2.h"
 
 #include "stm32xxx_hal.h"
+#include "i2c_bus.h"
 
 
 #ifndef HAL_I2C_MODULE_ENABLED
@@ -16,6 +17,14 @@
 #pragma message("hal conf should enable i2c")
 #endif
 
+/* I2C1 is owned by the bus manager and shared with the VL53L3CX sensors.
+ * The display refresh is the least important traffic on the bus.
+ */
+static I2C_BUS_CLIENT   _I2cClient   = I2C_BUS_CLIENT_EXPANDER;
+static I2C_BUS_PRIORITY _I2cPriority = I2C_BUS_PRIORITY_NORMAL;
+#define XNUCLEO53L3A2_GetI2cBus() I2CBus_Acquire(I2C_BUS_1, _I2cClient, _I2cPriority)
+#define XNUCLEO53L3A2_PutI2cBus() I2CBus_Release(I2C_BUS_1, _I2cClient)
+
 /* when not customized by application define dummy one */
 #ifndef XNUCLEO53L3A2_GetI2cBus
 /**
@@ -179,15 +188,6 @@
  *@{
  */
 
-/**
- *  i2c handle to be  use of all i2c access
- * end user shall provide it to
- * can be @a XNUCLEO53L3A2_I2C1Configure() @sa XNUCLEO53L3A2_usage
- * @warning do not use any XNUCLEO53L3A2_xxx prior to a first init with valid i2c handle
- */
-I2C_HandleTypeDef  XNUCLEO53L3A2_hi2c;
-
-
 /**
  * cache the full set of expanded GPIO values to avoid i2c reading
  */
@@ -272,42 +272,12 @@ static void _I2cFailRecover(){
 
 
 int XNUCLEO53L3A2_I2C1Configure() {
-    int status;
-    GPIO_InitTypeDef GPIO_InitStruct;
-
-    _I2cFailRecover();
-
-    /* Peripheral clock enable */
-    __GPIOB_CLK_ENABLE();
-    __I2C1_CLK_ENABLE();
-
-    /**I2C1 GPIO Configuration\n
-     PB8     ------> I2C1_SCL\n
-     PB9     ------> I2C1_SDA
-     */
-    GPIO_InitStruct.Pin = GPIO_PIN_8 | GPIO_PIN_9;
-    GPIO_InitStruct.Mode = GPIO_MODE_AF_OD;
-    GPIO_InitStruct.Pull = GPIO_NOPULL;
-    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-    GPIO_InitStruct.Alternate = GPIO_AF4_I2C1;
-    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
-
-    XNUCLEO53L3A2_hi2c.Instance = I2C1;
-#ifdef __STM32F4xx_HAL_H
-    XNUCLEO53L3A2_hi2c.Init.ClockSpeed = 400000;
-    XNUCLEO53L3A2_hi2c.Init.DutyCycle = I2C_DUTYCYCLE_2;
-#else
-    /* STM32L4xx and L053 */
-    XNUCLEO53L3A2_hi2c.Init.Timing = 0x2050133E;//0x00300F38; /* set 400KHz fast mode i2c*/
-#endif
-    XNUCLEO53L3A2_hi2c.Init.OwnAddress1 = 0;
-    XNUCLEO53L3A2_hi2c.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
-    XNUCLEO53L3A2_hi2c.Init.DualAddressMode = I2C_DUALADDRESS_DISABLED;
-    XNUCLEO53L3A2_hi2c.Init.OwnAddress2 = 0;
-    XNUCLEO53L3A2_hi2c.Init.GeneralCallMode = I2C_GENERALCALL_DISABLED;
-    XNUCLEO53L3A2_hi2c.Init.NoStretchMode = I2C_NOSTRETCH_DISABLED;
-    status = HAL_I2C_Init(&XNUCLEO53L3A2_hi2c);
-    return status;
+    /* the bus can be recovered only before the bus manager has taken I2C1 */
+    if (!I2CBus_IsInitialized(I2C_BUS_1)) {
+        _I2cFailRecover();
+    }
+    I2CBus_Init(I2C_BUS_1);
+    return 0;
 }
 
 int XNUCLEO53L3A2_SetIntrStateId(int EnableIntr, int DevNo){
@@ -580,10 +550,10 @@ static int _ExpanderRd(int I2cExpAddr, int index, uint8_t *data, int n_data) {
     RegAddr = index;
     XNUCLEO53L3A2_GetI2cBus();
     do {
-        status = HAL_I2C_Master_Transmit(&XNUCLEO53L3A2_hi2c, I2cExpAddr, &RegAddr, 1, 100);
+        status = I2CBus_Transmit(I2C_BUS_1, _I2cClient, I2cExpAddr, &RegAddr, 1, 100);
         if (status)
             break;
-        status = HAL_I2C_Master_Receive(&XNUCLEO53L3A2_hi2c, I2cExpAddr, data, n_data, n_data * 100);
+        status = I2CBus_Receive(I2C_BUS_1, _I2cClient, I2cExpAddr, data, n_data, n_data * 100);
     } while (0);
     XNUCLEO53L3A2_PutI2cBus();
     return status;
@@ -604,7 +574,7 @@ static int _ExpanderWR(int I2cExpAddr, int index, uint8_t *data, int n_data) {
     RegAddr[0] = index;
     memcpy(RegAddr + 1, data, n_data);
     XNUCLEO53L3A2_GetI2cBus();
-    status = HAL_I2C_Master_Transmit(&XNUCLEO53L3A2_hi2c, I2cExpAddr, RegAddr, n_data + 1, 100);
+    status = I2CBus_Transmit(I2C_BUS_1, _I2cClient, I2cExpAddr, RegAddr, n_data + 1, 100);
     XNUCLEO53L3A2_PutI2cBus();
     return status;
 }
@@ -779,7 +749,11 @@ int XNUCLEO53L3A2_SetDisplayString(const char *str) {
         BitPos=DisplayBitPos[i];
         CurIOVal.u32 |=0x7F<<BitPos;
     }
+    _I2cClient = I2C_BUS_CLIENT_DISPLAY;
+    _I2cPriority = I2C_BUS_PRIORITY_LOW;
     status = _ExpandersSetAllIO();
+    _I2cClient = I2C_BUS_CLIENT_EXPANDER;
+    _I2cPriority = I2C_BUS_PRIORITY_NORMAL;
     if( status ){
         XNUCLEO53L3A2_ErrLog("Set i/o");
     }
@@ -9,6 +9,7 @@
 #define _X_NUCLEO_53L3A2_H_
 
 #include  "stm32xxx_hal.h"
+#include  "i2c_bus.h"
 
 /**
  * @defgroup VL53L3A2_config  VL53L3A2 static configuration
@@ -320,9 +321,9 @@ enum XNUCLEO53L3A2_dev_e{
 
 /**
  * I2C1 handle
- * @note setup and configured by @ref XNUCLEO53L3A2_Init
+ * @note owned by the I2C bus manager, setup by @ref XNUCLEO53L3A2_I2C1Configure
  */
-extern I2C_HandleTypeDef  XNUCLEO53L3A2_hi2c;
+#define XNUCLEO53L3A2_hi2c (*I2CBus_GetHandle(I2C_BUS_1))
 /** UART2 handle
  *
  * UART2 is the nucleo Virtual Com Port
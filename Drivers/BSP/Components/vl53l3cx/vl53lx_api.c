@@ -238,14 +238,12 @@ VL53LX_Error VL53LX_SetDeviceAddress(VL53LX_DEV Dev, uint8_t DeviceAddress)
 }
 
 
-VL53LX_Error VL53LX_DataInit(VL53LX_DEV Dev)
+static VL53LX_Error DataInit(VL53LX_DEV Dev, uint8_t read_p2p_data)
 {
 	VL53LX_Error Status = VL53LX_ERROR_NONE;
 	VL53LX_LLDriverData_t *pdev;
 	uint8_t  measurement_mode;
 
-	LOG_FUNCTION_START("");
-
 
 #ifdef USE_I2C_2V8
 	Status = VL53LX_RdByte(Dev, VL53LX_PAD_I2C_HV__EXTSUP_CONFIG, &i);
@@ -257,7 +255,7 @@ VL53LX_Error VL53LX_DataInit(VL53LX_DEV Dev)
 #endif
 
 	if (Status == VL53LX_ERROR_NONE)
-		Status = VL53LX_data_init(Dev, 1);
+		Status = VL53LX_data_init(Dev, read_p2p_data);
 
 	Status = SetPresetModeL3CX(Dev,
 			VL53LX_DISTANCEMODE_MEDIUM,
@@ -289,6 +287,70 @@ VL53LX_Error VL53LX_DataInit(VL53LX_DEV Dev)
 	VL53LXDevDataSet(Dev, CurrentParameters.DistanceMode,
 			VL53LX_DISTANCEMODE_MEDIUM);
 
+	VL53LXDevDataSet(Dev, ThresholdRanging.Active, 0);
+
+	return Status;
+}
+
+
+VL53LX_Error VL53LX_DataInit(VL53LX_DEV Dev)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+	Status = DataInit(Dev, 1);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+
+VL53LX_Error VL53LX_DataInitFromP2PData(VL53LX_DEV Dev,
+		VL53LX_p2p_data_t *pP2PData)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+
+	LOG_FUNCTION_START("");
+
+	Status = VL53LX_set_p2p_data(Dev, pP2PData);
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_RdWord(Dev, VL53LX_RESULT__OSC_CALIBRATE_VAL,
+				&(pdev->dbg_results.result__osc_calibrate_val));
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = DataInit(Dev, 0);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+
+VL53LX_Error VL53LX_GetP2PData(VL53LX_DEV Dev,
+		VL53LX_p2p_data_t *pP2PData)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+	Status = VL53LX_get_p2p_data(Dev, pP2PData);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+
+VL53LX_Error VL53LX_ReadP2PDataStep(VL53LX_DEV Dev, uint8_t Step,
+		uint8_t *pDone)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+	Status = VL53LX_read_p2p_data_step(Dev, Step, pDone);
+
 	LOG_FUNCTION_END(Status);
 	return Status;
 }
@@ -308,6 +370,20 @@ VL53LX_Error VL53LX_WaitDeviceBooted(VL53LX_DEV Dev)
 }
 
 
+VL53LX_Error VL53LX_CheckDeviceBooted(VL53LX_DEV Dev, uint8_t *pBooted)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+	Status = VL53LX_check_for_boot_completion(Dev,
+			VL53LX_BOOT_COMPLETION_POLLING_TIMEOUT_MS, pBooted);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+
 
 
 static VL53LX_Error ComputeDevicePresetMode(
@@ -675,6 +751,132 @@ VL53LX_Error VL53LX_ClearInterruptAndStartMeasurement(VL53LX_DEV Dev)
 }
 
 
+VL53LX_Error VL53LX_StartThresholdRanging(VL53LX_DEV Dev,
+	uint16_t LowMilliMeter, uint16_t HighMilliMeter,
+	uint32_t InterMeasurementPeriodMilliSeconds)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+	VL53LX_GPIO_interrupt_config_t IntConf;
+	uint16_t dss_config__target_total_rate_mcps;
+	uint32_t PhaseCalTimeoutUs;
+	uint32_t MmTimeoutUs;
+	uint32_t RangeTimeoutUs;
+
+	LOG_FUNCTION_START("");
+
+	if ((LowMilliMeter > HighMilliMeter) ||
+		VL53LXDevDataGet(Dev, ThresholdRanging.Active))
+		Status = VL53LX_ERROR_INVALID_PARAMS;
+
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_get_timeouts_us(Dev, &PhaseCalTimeoutUs,
+			&MmTimeoutUs, &RangeTimeoutUs);
+
+	if (Status == VL53LX_ERROR_NONE) {
+		VL53LXDevDataSet(Dev, ThresholdRanging.PhaseCalTimeoutUs,
+				PhaseCalTimeoutUs);
+		VL53LXDevDataSet(Dev, ThresholdRanging.MmTimeoutUs,
+				MmTimeoutUs);
+		VL53LXDevDataSet(Dev, ThresholdRanging.RangeTimeoutUs,
+				RangeTimeoutUs);
+		VL53LXDevDataSet(Dev, ThresholdRanging.InterMeasurementPeriodMs,
+				pdev->inter_measurement_period_ms);
+		VL53LXDevDataSet(Dev, ThresholdRanging.Active, 1);
+	}
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_StopMeasurement(Dev);
+
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_get_preset_mode_timing_cfg(Dev,
+				VL53LX_DEVICEPRESETMODE_STANDARD_RANGING,
+				&dss_config__target_total_rate_mcps,
+				&PhaseCalTimeoutUs,
+				&MmTimeoutUs,
+				&RangeTimeoutUs);
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_set_preset_mode(Dev,
+				VL53LX_DEVICEPRESETMODE_STANDARD_RANGING,
+				dss_config__target_total_rate_mcps,
+				PhaseCalTimeoutUs,
+				MmTimeoutUs,
+				RangeTimeoutUs,
+				InterMeasurementPeriodMilliSeconds);
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = SetInterMeasurementPeriodMilliSeconds(Dev,
+				InterMeasurementPeriodMilliSeconds);
+
+
+	if (Status == VL53LX_ERROR_NONE) {
+		memset(&IntConf, 0, sizeof(IntConf));
+		IntConf.intr_mode_distance = VL53LX_GPIOINTMODE_OUT_OF_WINDOW;
+		IntConf.intr_mode_rate = VL53LX_GPIOINTMODE_LEVEL_LOW;
+		IntConf.intr_no_target = 1;
+		IntConf.intr_combined_mode = 1;
+		IntConf.threshold_distance_high = HighMilliMeter;
+		IntConf.threshold_distance_low = LowMilliMeter;
+
+		pdev->gpio_interrupt_config = IntConf;
+		pdev->gen_cfg.system__interrupt_config_gpio =
+			VL53LX_encode_GPIO_interrupt_config(&IntConf);
+
+		Status = VL53LX_set_GPIO_thresholds_from_struct(Dev, &IntConf);
+	}
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_init_and_start_range(
+				Dev,
+				VL53LX_DEVICEMEASUREMENTMODE_TIMED,
+				VL53LX_DEVICECONFIGLEVEL_FULL);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+
+VL53LX_Error VL53LX_StopThresholdRanging(VL53LX_DEV Dev)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+
+	LOG_FUNCTION_START("");
+
+	if (!VL53LXDevDataGet(Dev, ThresholdRanging.Active))
+		Status = VL53LX_ERROR_INVALID_PARAMS;
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_stop_range(Dev);
+
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = SetPresetModeL3CX(Dev,
+			VL53LXDevDataGet(Dev, CurrentParameters.DistanceMode),
+			VL53LXDevDataGet(Dev,
+				ThresholdRanging.InterMeasurementPeriodMs));
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_set_timeouts_us(Dev,
+			VL53LXDevDataGet(Dev, ThresholdRanging.PhaseCalTimeoutUs),
+			VL53LXDevDataGet(Dev, ThresholdRanging.MmTimeoutUs),
+			VL53LXDevDataGet(Dev, ThresholdRanging.RangeTimeoutUs));
+
+	if (Status == VL53LX_ERROR_NONE) {
+		pdev->gpio_interrupt_config =
+			VL53LX_decode_GPIO_interrupt_config(
+				pdev->gen_cfg.system__interrupt_config_gpio);
+		VL53LXDevDataSet(Dev, ThresholdRanging.Active, 0);
+	}
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+
 VL53LX_Error VL53LX_GetMeasurementDataReady(VL53LX_DEV Dev,
 	uint8_t *pMeasurementDataReady)
 {
@@ -1007,7 +1209,7 @@ static VL53LX_Error SetMeasurementData(VL53LX_DEV Dev,
 			presults->smudge_corrector_data.new_xtalk_applied_flag;
 
 
-	pMultiRangingData->TimeStamp = 0;
+	VL53LX_GetTimerValue((int32_t *)&pMultiRangingData->TimeStamp);
 
 	pMultiRangingData->StreamCount = presults->stream_count;
 
@@ -1044,6 +1246,36 @@ static VL53LX_Error SetMeasurementData(VL53LX_DEV Dev,
 }
 
 
+static VL53LX_Error SetPrimaryData(VL53LX_DEV Dev,
+	VL53LX_range_results_t *presults,
+	VL53LX_PrimaryRangingData_t *pPrimaryRangingData)
+{
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+	uint8_t i;
+
+	pPrimaryRangingData->NumberOfObjectsFound = presults->active_results;
+	pPrimaryRangingData->HasXtalkValueChanged =
+			presults->smudge_corrector_data.new_xtalk_applied_flag;
+	VL53LX_GetTimerValue((int32_t *)&pPrimaryRangingData->TimeStamp);
+	pPrimaryRangingData->StreamCount = presults->stream_count;
+
+
+
+	for (i = 1; i < VL53LX_MAX_RANGE_RESULTS; i++) {
+		pdev->PreviousRangeMilliMeter[i] = 0;
+		pdev->PreviousRangeStatus[i] = 255;
+		pdev->PreviousExtendedRange[i] = 0;
+	}
+
+	return SetTargetData(Dev, presults->active_results,
+			presults->stream_count,
+			0,
+			presults->device_status,
+			&(presults->VL53LX_p_003[0]),
+			&(pPrimaryRangingData->RangeData));
+}
+
+
 VL53LX_Error VL53LX_GetMultiRangingData(VL53LX_DEV Dev,
 		VL53LX_MultiRangingData_t *pMultiRangingData)
 {
@@ -1051,7 +1283,7 @@ VL53LX_Error VL53LX_GetMultiRangingData(VL53LX_DEV Dev,
 	VL53LX_LLDriverData_t *pdev =
 			VL53LXDevStructGetLLDriverHandle(Dev);
 	VL53LX_range_results_t *presults =
-			(VL53LX_range_results_t *) pdev->wArea1;
+			(VL53LX_range_results_t *) VL53LXDevStructGetWorkArea1(Dev);
 
 	LOG_FUNCTION_START("");
 
@@ -1073,6 +1305,89 @@ VL53LX_Error VL53LX_GetMultiRangingData(VL53LX_DEV Dev,
 	return Status;
 }
 
+VL53LX_Error VL53LX_FetchMultiRangingData(VL53LX_DEV Dev)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+	Status = VL53LX_latch_histogram_data(Dev);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53LX_Error VL53LX_ProcessMultiRangingData(VL53LX_DEV Dev,
+		VL53LX_MultiRangingData_t *pMultiRangingData)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev =
+			VL53LXDevStructGetLLDriverHandle(Dev);
+
+	LOG_FUNCTION_START("");
+
+	if (pdev->hist_data_latched == 0)
+		Status = VL53LX_ERROR_INVALID_COMMAND;
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_GetMultiRangingData(Dev, pMultiRangingData);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53LX_Error VL53LX_ProcessPrimaryRangingData(VL53LX_DEV Dev,
+		VL53LX_PrimaryRangingData_t *pPrimaryRangingData)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev =
+			VL53LXDevStructGetLLDriverHandle(Dev);
+	VL53LX_range_results_t *presults =
+			(VL53LX_range_results_t *) VL53LXDevStructGetWorkArea1(Dev);
+
+	LOG_FUNCTION_START("");
+
+	if (pdev->hist_data_latched == 0)
+		Status = VL53LX_ERROR_INVALID_COMMAND;
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = VL53LX_get_device_results(
+					Dev,
+					VL53LX_DEVICERESULTSLEVEL_FULL,
+					presults);
+
+	if (Status == VL53LX_ERROR_NONE)
+		Status = SetPrimaryData(Dev,
+					presults,
+					pPrimaryRangingData);
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
+VL53LX_Error VL53LX_GetProcessedHistogramData(VL53LX_DEV Dev,
+		VL53LX_histogram_bin_data_t **ppHistogramData,
+		VL53LX_range_results_t **ppRangeResults)
+{
+	VL53LX_Error Status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev =
+			VL53LXDevStructGetLLDriverHandle(Dev);
+
+	LOG_FUNCTION_START("");
+
+	if (ppHistogramData == NULL || ppRangeResults == NULL)
+		Status = VL53LX_ERROR_INVALID_PARAMS;
+
+	if (Status == VL53LX_ERROR_NONE) {
+		*ppHistogramData = &(pdev->hist_data);
+		*ppRangeResults  =
+			(VL53LX_range_results_t *) VL53LXDevStructGetWorkArea1(Dev);
+	}
+
+	LOG_FUNCTION_END(Status);
+	return Status;
+}
+
 VL53LX_Error VL53LX_GetAdditionalData(VL53LX_DEV Dev,
 		VL53LX_AdditionalData_t *pAdditionalData)
 {
@@ -184,6 +184,65 @@ VL53LX_Error VL53LX_SetDeviceAddress(VL53LX_DEV Dev,
  */
 VL53LX_Error VL53LX_DataInit(VL53LX_DEV Dev);
 
+/**
+ * @brief One time device initialization from cached part-to-part data
+ *
+ * @par Function Description
+ * Same as @a VL53LX_DataInit(), but the part-to-part data decoded from the
+ * device NVM is taken from a copy saved by @a VL53LX_GetP2PData() instead of
+ * being read from the device. The copy must come from the same device
+ * (see @a VL53LX_GetUID()). The oscillator calibration value is not part of
+ * the copy, it is read from the device.
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                   Device Handle
+ * @param   pP2PData              Pointer to the cached part-to-part data
+ * @return  VL53LX_ERROR_NONE     Success
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_DataInitFromP2PData(VL53LX_DEV Dev,
+		VL53LX_p2p_data_t *pP2PData);
+
+/**
+ * @brief Get the part-to-part data decoded from the device NVM
+ *
+ * @par Function Description
+ * To be called after @a VL53LX_DataInit(). The data could be saved by the
+ * application and passed to @a VL53LX_DataInitFromP2PData() on the next
+ * start, so the NVM of the device doesn't have to be read again.
+ *
+ * @note This function doesn't Access to the device
+ *
+ * @param   Dev                   Device Handle
+ * @param   pP2PData              Pointer to the data structure to fill up.
+ * @return  VL53LX_ERROR_NONE     Success
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_GetP2PData(VL53LX_DEV Dev,
+		VL53LX_p2p_data_t *pP2PData);
+
+/**
+ * @brief Read the part-to-part data from the device NVM one block at a time
+ *
+ * @par Function Description
+ * Resumable version of the NVM read of @a VL53LX_DataInit(). Each call reads
+ * one block, so the read can be spread across several passes of the
+ * application's main loop. Step has to start at 0 and be incremented after
+ * every successful call until pDone is set. The data can then be taken with
+ * @a VL53LX_GetP2PData() and passed to @a VL53LX_DataInitFromP2PData().
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                   Device Handle
+ * @param   Step                  Index of the block to read
+ * @param   pDone                 Set to 1 once the last block has been read
+ * @return  VL53LX_ERROR_NONE     Success (check pDone)
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_ReadP2PDataStep(VL53LX_DEV Dev, uint8_t Step,
+		uint8_t *pDone);
+
 /**
  * @brief Wait for device booted after chip enable (hardware standby)
  *
@@ -194,6 +253,25 @@ VL53LX_Error VL53LX_DataInit(VL53LX_DEV Dev);
  */
 VL53LX_Error VL53LX_WaitDeviceBooted(VL53LX_DEV Dev);
 
+/**
+ * @brief Check once if the device has booted after chip enable
+ *
+ * @par Function Description
+ * Non-blocking version of @a VL53LX_WaitDeviceBooted(). The status register
+ * is read once per call, so the boot of the device can be waited for across
+ * several passes of the application's main loop. The first call has to be
+ * made at least VL53LX_FIRMWARE_BOOT_TIME_US after the chip enable.
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                   Device Handle
+ * @param   pBooted               Set to 1 once the device has booted
+ * @return  VL53LX_ERROR_NONE     Success (check pBooted)
+ * @return  VL53LX_ERROR_TIME_OUT The device has not booted in time
+ * @return  "Other error code"    See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_CheckDeviceBooted(VL53LX_DEV Dev, uint8_t *pBooted);
+
 
 /** @} VL53LX_init_group */
 
@@ -332,6 +410,46 @@ VL53LX_Error VL53LX_StopMeasurement(VL53LX_DEV Dev);
  */
 VL53LX_Error VL53LX_ClearInterruptAndStartMeasurement(VL53LX_DEV Dev);
 
+/**
+ * @brief Start autonomous ranging against distance thresholds
+ *
+ * @par Function Description
+ * The histogram ranging is stopped and the device ranges on its own in timed
+ * standard ranging mode. GPIO1 is only asserted when a range falls outside
+ * [LowMilliMeter, HighMilliMeter] or no target is found, so the host doesn't
+ * have to read the device until then. The histogram ranging setup is kept and
+ * restored by @a VL53LX_StopThresholdRanging().
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                                  Device Handle
+ * @param   LowMilliMeter                        Low distance threshold
+ * @param   HighMilliMeter                       High distance threshold
+ * @param   InterMeasurementPeriodMilliSeconds   Period of the ranging
+ * @return  VL53LX_ERROR_NONE    Success
+ * @return  VL53LX_ERROR_INVALID_PARAMS Thresholds out of order or threshold
+ * ranging already running
+ * @return  "Other error code"   See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_StartThresholdRanging(VL53LX_DEV Dev,
+	uint16_t LowMilliMeter, uint16_t HighMilliMeter,
+	uint32_t InterMeasurementPeriodMilliSeconds);
+
+/**
+ * @brief Stop the threshold ranging and restore the histogram ranging setup
+ *
+ * @par Function Description
+ * The histogram ranging is restarted with @a VL53LX_StartMeasurement().
+ *
+ * @note This function Access to the device
+ *
+ * @param   Dev                  Device Handle
+ * @return  VL53LX_ERROR_NONE    Success
+ * @return  VL53LX_ERROR_INVALID_PARAMS Threshold ranging is not running
+ * @return  "Other error code"   See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_StopThresholdRanging(VL53LX_DEV Dev);
+
 /**
  * @brief Return Measurement Data Ready
  *
@@ -390,6 +508,95 @@ VL53LX_Error VL53LX_WaitMeasurementDataReady(VL53LX_DEV Dev);
 VL53LX_Error VL53LX_GetMultiRangingData(VL53LX_DEV Dev,
 		VL53LX_MultiRangingData_t *pMultiRangingData);
 
+/**
+ * @brief Fetch the raw histogram of the last measurement
+ *
+ * @par Function Description
+ * First stage of @a VL53LX_GetMultiRangingData(). The histogram of the last
+ * measurement is read from the device and latched in the driver, so
+ * @a VL53LX_ClearInterruptAndStartMeasurement() can be called right away and
+ * the next measurement integrates while the latched one is post-processed
+ * by @a VL53LX_ProcessMultiRangingData().
+ *
+ * @warning The latched histogram has to be processed before the next call
+ * to this function or to @a VL53LX_GetMultiRangingData(), otherwise it is lost.
+ *
+ * @note This function Access to the device
+ * @note Only single zone histogram ranging is supported
+ *
+ * @param   Dev                      Device Handle
+ * @return  VL53LX_ERROR_NONE        Success
+ * @return  VL53LX_ERROR_NOT_SUPPORTED  Multi-zone ranging is configured
+ * @return  "Other error code"       See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_FetchMultiRangingData(VL53LX_DEV Dev);
+
+/**
+ * @brief Post-process the histogram latched by VL53LX_FetchMultiRangingData()
+ *
+ * @par Function Description
+ * Second stage of @a VL53LX_GetMultiRangingData(). Runs the histogram
+ * post-processing (ranging, dmax, crosstalk and consistency checks) on the
+ * latched histogram and fills up the ranging data. It can be called while
+ * the next measurement is already running.
+ *
+ * @note This function doesn't Access to the device
+ *
+ * @param   Dev                      Device Handle
+ * @param   pMultiRangingData        Pointer to the data structure to fill up.
+ * @return  VL53LX_ERROR_NONE        Success
+ * @return  VL53LX_ERROR_INVALID_COMMAND  No histogram has been latched
+ * @return  "Other error code"       See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_ProcessMultiRangingData(VL53LX_DEV Dev,
+		VL53LX_MultiRangingData_t *pMultiRangingData);
+
+/**
+ * @brief Post-process the latched histogram for the primary target only
+ *
+ * @par Function Description
+ * Same as @a VL53LX_ProcessMultiRangingData(), but only the first target is
+ * converted, straight from the range results kept in the driver's work area.
+ * The result structure is not cleared and the other targets are not
+ * converted, so it is meant for applications which only use the closest
+ * target.
+ *
+ * @note This function doesn't Access to the device
+ *
+ * @param   Dev                      Device Handle
+ * @param   pPrimaryRangingData      Pointer to the data structure to fill up.
+ * @return  VL53LX_ERROR_NONE        Success
+ * @return  VL53LX_ERROR_INVALID_COMMAND  No histogram has been latched
+ * @return  "Other error code"       See ::VL53LX_Error
+ */
+VL53LX_Error VL53LX_ProcessPrimaryRangingData(VL53LX_DEV Dev,
+		VL53LX_PrimaryRangingData_t *pPrimaryRangingData);
+
+/**
+ * @brief Get the histogram and range results of the last post-processing
+ *
+ * @par Function Description
+ * Gives access to the histogram bins and the complete range results of the
+ * measurement post-processed by the last call to
+ * @a VL53LX_ProcessPrimaryRangingData() or
+ * @a VL53LX_ProcessMultiRangingData(), e.g. to log them for offline analysis.
+ *
+ * @warning The range results are kept in the work area shared by all the
+ * devices, so they are valid only until the next post-processing of any
+ * device.
+ *
+ * @note This function doesn't Access to the device
+ *
+ * @param   Dev                      Device Handle
+ * @param   ppHistogramData          Returns a pointer to the histogram data
+ * @param   ppRangeResults           Returns a pointer to the range results
+ * @return  VL53LX_ERROR_NONE        Success
+ * @return  VL53LX_ERROR_INVALID_PARAMS  A NULL pointer is given
+ */
+VL53LX_Error VL53LX_GetProcessedHistogramData(VL53LX_DEV Dev,
+		VL53LX_histogram_bin_data_t **ppHistogramData,
+		VL53LX_range_results_t **ppRangeResults);
+
 /**
  * @brief Get Additional Data
  *
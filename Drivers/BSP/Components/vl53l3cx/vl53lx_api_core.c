@@ -130,7 +130,7 @@ static VL53LX_Error select_offset_per_vcsel(VL53LX_LLDriverData_t *pdev,
 		break;
 	}
 
-	isc = pdev->ll_state.cfg_internal_stream_count;
+	isc = pdev->hist_cfg_internal_stream_count;
 	if (status == VL53LX_ERROR_NONE)
 		*poffset = (isc & 0x01) ? tA : tB;
 
@@ -629,6 +629,29 @@ VL53LX_Error VL53LX_read_p2p_data(
 
 
 
+	VL53LX_Error status = VL53LX_ERROR_NONE;
+	uint8_t      step   = 0;
+	uint8_t      done   = 0;
+
+	LOG_FUNCTION_START("");
+
+	while (status == VL53LX_ERROR_NONE && done == 0)
+		status = VL53LX_read_p2p_data_step(Dev, step++, &done);
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+
+VL53LX_Error VL53LX_read_p2p_data_step(
+	VL53LX_DEV        Dev,
+	uint8_t           step,
+	uint8_t          *pdone)
+{
+
+
+
 	VL53LX_Error status       = VL53LX_ERROR_NONE;
 	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
 	VL53LX_hist_post_process_config_t *pHP = &(pdev->histpostprocess);
@@ -639,58 +662,63 @@ VL53LX_Error VL53LX_read_p2p_data(
 
 	LOG_FUNCTION_START("");
 
-	if (status == VL53LX_ERROR_NONE)
-		status = VL53LX_get_static_nvm_managed(
-						Dev,
-						&(pdev->stat_nvm));
+	*pdone = 0;
 
-	if (status == VL53LX_ERROR_NONE)
-		status = VL53LX_get_customer_nvm_managed(
-						Dev,
-						&(pdev->customer));
+	switch (step) {
+	case 0:
 
-	if (status == VL53LX_ERROR_NONE) {
+		if (status == VL53LX_ERROR_NONE)
+			status = VL53LX_get_static_nvm_managed(
+							Dev,
+							&(pdev->stat_nvm));
 
-		status = VL53LX_get_nvm_copy_data(
-						Dev,
-						&(pdev->nvm_copy_data));
+		if (status == VL53LX_ERROR_NONE)
+			status = VL53LX_get_customer_nvm_managed(
+							Dev,
+							&(pdev->customer));
 
+		if (status == VL53LX_ERROR_NONE) {
 
-		if (status == VL53LX_ERROR_NONE)
-			VL53LX_copy_rtn_good_spads_to_buffer(
-					&(pdev->nvm_copy_data),
-					&(pdev->rtn_good_spads[0]));
-	}
+			status = VL53LX_get_nvm_copy_data(
+							Dev,
+							&(pdev->nvm_copy_data));
 
 
+			if (status == VL53LX_ERROR_NONE)
+				VL53LX_copy_rtn_good_spads_to_buffer(
+						&(pdev->nvm_copy_data),
+						&(pdev->rtn_good_spads[0]));
+		}
 
-	if (status == VL53LX_ERROR_NONE) {
-		pHP->algo__crosstalk_compensation_plane_offset_kcps =
-		pN->algo__crosstalk_compensation_plane_offset_kcps;
-		pHP->algo__crosstalk_compensation_x_plane_gradient_kcps =
-		pN->algo__crosstalk_compensation_x_plane_gradient_kcps;
-		pHP->algo__crosstalk_compensation_y_plane_gradient_kcps =
-		pN->algo__crosstalk_compensation_y_plane_gradient_kcps;
-	}
 
 
-	if (status == VL53LX_ERROR_NONE)
+		if (status == VL53LX_ERROR_NONE) {
+			pHP->algo__crosstalk_compensation_plane_offset_kcps =
+			pN->algo__crosstalk_compensation_plane_offset_kcps;
+			pHP->algo__crosstalk_compensation_x_plane_gradient_kcps =
+			pN->algo__crosstalk_compensation_x_plane_gradient_kcps;
+			pHP->algo__crosstalk_compensation_y_plane_gradient_kcps =
+			pN->algo__crosstalk_compensation_y_plane_gradient_kcps;
+		}
+		break;
+
+	case 1:
+
 		status =
 			VL53LX_read_nvm_optical_centre(
 				Dev,
 				&(pdev->optical_centre));
+		break;
 
+	case 2:
 
-
-	if (status == VL53LX_ERROR_NONE)
 		status =
 			VL53LX_read_nvm_cal_peak_rate_map(
 				Dev,
 				&(pdev->cal_peak_rate_map));
+		break;
 
-
-
-	if (status == VL53LX_ERROR_NONE) {
+	case 3:
 
 		status =
 			VL53LX_read_nvm_additional_offset_cal_data(
@@ -719,10 +747,9 @@ VL53LX_Error VL53LX_read_p2p_data(
 			&(pCD->result__mm_inner_actual_effective_spads),
 			&(pCD->result__mm_outer_actual_effective_spads));
 		}
-	}
-
+		break;
 
-	if (status == VL53LX_ERROR_NONE) {
+	case 4:
 
 		status =
 			VL53LX_read_nvm_fmt_range_results_data(
@@ -749,10 +776,10 @@ VL53LX_Error VL53LX_read_p2p_data(
 
 			pdev->fmt_dmax_cal.coverglass_transmission = 0x0100;
 		}
-	}
+		break;
 
+	default:
 
-	if (status == VL53LX_ERROR_NONE)
 		status =
 			VL53LX_RdWord(
 				Dev,
@@ -761,32 +788,36 @@ VL53LX_Error VL53LX_read_p2p_data(
 
 
 
-	if (pdev->stat_nvm.osc_measured__fast_osc__frequency < 0x1000) {
-		trace_print(
-			VL53LX_TRACE_LEVEL_WARNING,
-			"\nInvalid %s value (0x%04X) - forcing to 0x%04X\n\n",
-			"pdev->stat_nvm.osc_measured__fast_osc__frequency",
-			pdev->stat_nvm.osc_measured__fast_osc__frequency,
-			0xBCCC);
-		pdev->stat_nvm.osc_measured__fast_osc__frequency = 0xBCCC;
-	}
+		if (pdev->stat_nvm.osc_measured__fast_osc__frequency < 0x1000) {
+			trace_print(
+				VL53LX_TRACE_LEVEL_WARNING,
+				"\nInvalid %s value (0x%04X) - forcing to 0x%04X\n\n",
+				"pdev->stat_nvm.osc_measured__fast_osc__frequency",
+				pdev->stat_nvm.osc_measured__fast_osc__frequency,
+				0xBCCC);
+			pdev->stat_nvm.osc_measured__fast_osc__frequency = 0xBCCC;
+		}
 
 
 
-	if (status == VL53LX_ERROR_NONE)
-		status =
-			VL53LX_get_mode_mitigation_roi(
-				Dev,
-				&(pdev->mm_roi));
+		if (status == VL53LX_ERROR_NONE)
+			status =
+				VL53LX_get_mode_mitigation_roi(
+					Dev,
+					&(pdev->mm_roi));
+
 
 
+		if (pdev->optical_centre.x_centre == 0 &&
+			pdev->optical_centre.y_centre == 0) {
+			pdev->optical_centre.x_centre =
+					pdev->mm_roi.x_centre << 4;
+			pdev->optical_centre.y_centre =
+					pdev->mm_roi.y_centre << 4;
+		}
 
-	if (pdev->optical_centre.x_centre == 0 &&
-		pdev->optical_centre.y_centre == 0) {
-		pdev->optical_centre.x_centre =
-				pdev->mm_roi.x_centre << 4;
-		pdev->optical_centre.y_centre =
-				pdev->mm_roi.y_centre << 4;
+		*pdone = 1;
+		break;
 	}
 
 	LOG_FUNCTION_END(status);
@@ -915,6 +946,91 @@ VL53LX_Error VL53LX_set_part_to_part_data(
 }
 
 
+VL53LX_Error VL53LX_get_p2p_data(
+	VL53LX_DEV                            Dev,
+	VL53LX_p2p_data_t                    *pp2p_data)
+{
+
+
+
+	VL53LX_Error status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+
+	LOG_FUNCTION_START("");
+
+	memcpy(&(pp2p_data->stat_nvm), &(pdev->stat_nvm),
+		sizeof(VL53LX_static_nvm_managed_t));
+	memcpy(&(pp2p_data->customer), &(pdev->customer),
+		sizeof(VL53LX_customer_nvm_managed_t));
+	memcpy(&(pp2p_data->nvm_copy_data), &(pdev->nvm_copy_data),
+		sizeof(VL53LX_nvm_copy_data_t));
+	memcpy(&(pp2p_data->optical_centre), &(pdev->optical_centre),
+		sizeof(VL53LX_optical_centre_t));
+	memcpy(&(pp2p_data->cal_peak_rate_map), &(pdev->cal_peak_rate_map),
+		sizeof(VL53LX_cal_peak_rate_map_t));
+	memcpy(&(pp2p_data->add_off_cal_data), &(pdev->add_off_cal_data),
+		sizeof(VL53LX_additional_offset_cal_data_t));
+	memcpy(&(pp2p_data->fmt_dmax_cal), &(pdev->fmt_dmax_cal),
+		sizeof(VL53LX_dmax_calibration_data_t));
+	memcpy(&(pp2p_data->mm_roi), &(pdev->mm_roi),
+		sizeof(VL53LX_user_zone_t));
+	memcpy(&(pp2p_data->rtn_good_spads[0]), &(pdev->rtn_good_spads[0]),
+		sizeof(pp2p_data->rtn_good_spads));
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+
+VL53LX_Error VL53LX_set_p2p_data(
+	VL53LX_DEV                            Dev,
+	VL53LX_p2p_data_t                    *pp2p_data)
+{
+
+
+
+	VL53LX_Error status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+	VL53LX_hist_post_process_config_t *pHP = &(pdev->histpostprocess);
+	VL53LX_customer_nvm_managed_t *pN = &(pdev->customer);
+
+	LOG_FUNCTION_START("");
+
+	memcpy(&(pdev->stat_nvm), &(pp2p_data->stat_nvm),
+		sizeof(VL53LX_static_nvm_managed_t));
+	memcpy(&(pdev->customer), &(pp2p_data->customer),
+		sizeof(VL53LX_customer_nvm_managed_t));
+	memcpy(&(pdev->nvm_copy_data), &(pp2p_data->nvm_copy_data),
+		sizeof(VL53LX_nvm_copy_data_t));
+	memcpy(&(pdev->optical_centre), &(pp2p_data->optical_centre),
+		sizeof(VL53LX_optical_centre_t));
+	memcpy(&(pdev->cal_peak_rate_map), &(pp2p_data->cal_peak_rate_map),
+		sizeof(VL53LX_cal_peak_rate_map_t));
+	memcpy(&(pdev->add_off_cal_data), &(pp2p_data->add_off_cal_data),
+		sizeof(VL53LX_additional_offset_cal_data_t));
+	memcpy(&(pdev->fmt_dmax_cal), &(pp2p_data->fmt_dmax_cal),
+		sizeof(VL53LX_dmax_calibration_data_t));
+	memcpy(&(pdev->mm_roi), &(pp2p_data->mm_roi),
+		sizeof(VL53LX_user_zone_t));
+	memcpy(&(pdev->rtn_good_spads[0]), &(pp2p_data->rtn_good_spads[0]),
+		sizeof(pp2p_data->rtn_good_spads));
+
+
+
+	pHP->algo__crosstalk_compensation_plane_offset_kcps =
+	pN->algo__crosstalk_compensation_plane_offset_kcps;
+	pHP->algo__crosstalk_compensation_x_plane_gradient_kcps =
+	pN->algo__crosstalk_compensation_x_plane_gradient_kcps;
+	pHP->algo__crosstalk_compensation_y_plane_gradient_kcps =
+	pN->algo__crosstalk_compensation_y_plane_gradient_kcps;
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+
 VL53LX_Error VL53LX_get_part_to_part_data(
 	VL53LX_DEV                      Dev,
 	VL53LX_calibration_data_t      *pcal_data)
@@ -1386,6 +1502,18 @@ VL53LX_Error VL53LX_set_preset_mode(
 
 
 	switch (device_preset_mode) {
+	case VL53LX_DEVICEPRESETMODE_STANDARD_RANGING:
+		status = VL53LX_preset_mode_standard_ranging(
+					pstatic,
+					phistogram,
+					pgeneral,
+					ptiming,
+					pdynamic,
+					psystem,
+					ptuning_parms,
+					pzone_cfg);
+		break;
+
 	case VL53LX_DEVICEPRESETMODE_HISTOGRAM_LONG_RANGE:
 
 		status = VL53LX_preset_mode_histogram_long_range(
@@ -2086,10 +2214,13 @@ VL53LX_Error VL53LX_get_device_results(
 	uint8_t i;
 	uint8_t histo_merge_nb, idx;
 	VL53LX_range_data_t *pdata;
+	uint8_t latched;
 
 	LOG_FUNCTION_START("");
 
 
+	latched = pdev->hist_data_latched;
+	pdev->hist_data_latched = 0;
 
 	if ((pdev->sys_ctrl.system__mode_start &
 		 VL53LX_DEVICESCHEDULERMODE_HISTOGRAM)
@@ -2097,7 +2228,8 @@ VL53LX_Error VL53LX_get_device_results(
 
 
 
-		status = VL53LX_get_histogram_bin_data(
+		if (!latched)
+			status = VL53LX_get_histogram_bin_data(
 						Dev,
 						&(pdev->hist_data));
 
@@ -2106,7 +2238,7 @@ VL53LX_Error VL53LX_get_device_results(
 
 		if (status == VL53LX_ERROR_NONE &&
 			pHD->number_of_ambient_bins == 0) {
-			zid = pdev->ll_state.rd_zone_id;
+			zid = pHD->zone_id;
 			status = VL53LX_hist_copy_and_scale_ambient_info(
 			&(pZH->VL53LX_p_003[zid]),
 			&(pdev->hist_data));
@@ -2224,8 +2356,8 @@ VL53LX_Error VL53LX_get_device_results(
 				&(pdev->histpostprocess),
 				&(pdev->hist_data),
 				&(pdev->xtalk_shapes),
-				pdev->wArea1,
-				pdev->wArea2,
+				VL53LXDevStructGetWorkArea1(Dev),
+				VL53LXDevStructGetWorkArea2(Dev),
 				&histo_merge_nb,
 				presults);
 
@@ -2255,7 +2387,7 @@ VL53LX_Error VL53LX_get_device_results(
 		if (status != VL53LX_ERROR_NONE)
 			goto UPDATE_DYNAMIC_CONFIG;
 
-		zid = pdev->ll_state.rd_zone_id;
+		zid = pHD->zone_id;
 		status = VL53LX_hist_phase_consistency_check(
 			Dev,
 			&(pZH->VL53LX_p_003[zid]),
@@ -2266,7 +2398,7 @@ VL53LX_Error VL53LX_get_device_results(
 		if (status != VL53LX_ERROR_NONE)
 			goto UPDATE_DYNAMIC_CONFIG;
 
-		zid = pdev->ll_state.rd_zone_id;
+		zid = pHD->zone_id;
 		status = VL53LX_hist_xmonitor_consistency_check(
 			Dev,
 			&(pZH->VL53LX_p_003[zid]),
@@ -2278,7 +2410,7 @@ VL53LX_Error VL53LX_get_device_results(
 			goto UPDATE_DYNAMIC_CONFIG;
 
 
-		zid = pdev->ll_state.rd_zone_id;
+		zid = pHD->zone_id;
 		pZH->max_zones    = VL53LX_MAX_USER_ZONES;
 		pZH->active_zones =
 				pdev->zone_cfg.active_zones+1;
@@ -2402,16 +2534,22 @@ UPDATE_DYNAMIC_CONFIG:
 	}
 
 
-	presults->cfg_device_state = pdev->ll_state.cfg_device_state;
-	presults->rd_device_state  = pdev->ll_state.rd_device_state;
-	presults->zone_id          = pdev->ll_state.rd_zone_id;
+	if (latched) {
+		presults->cfg_device_state = pHD->cfg_device_state;
+		presults->rd_device_state  = pHD->rd_device_state;
+		presults->zone_id          = pHD->zone_id;
+	} else {
+		presults->cfg_device_state = pdev->ll_state.cfg_device_state;
+		presults->rd_device_state  = pdev->ll_state.rd_device_state;
+		presults->zone_id          = pdev->ll_state.rd_zone_id;
+	}
 
 	if (status == VL53LX_ERROR_NONE) {
 
 
 		pres->zone_results.max_zones    = VL53LX_MAX_USER_ZONES;
 		pres->zone_results.active_zones = pdev->zone_cfg.active_zones+1;
-		zid = pdev->ll_state.rd_zone_id;
+		zid = presults->zone_id;
 
 		if (zid < pres->zone_results.max_zones) {
 
@@ -2462,7 +2600,7 @@ UPDATE_DYNAMIC_CONFIG:
 
 
 
-	if (status == VL53LX_ERROR_NONE)
+	if (status == VL53LX_ERROR_NONE && !latched)
 		status = VL53LX_check_ll_driver_rd_state(Dev);
 
 #ifdef VL53LX_LOG_ENABLE
@@ -2479,6 +2617,56 @@ UPDATE_DYNAMIC_CONFIG:
 }
 
 
+VL53LX_Error VL53LX_latch_histogram_data(
+	VL53LX_DEV                    Dev)
+{
+
+
+	VL53LX_Error status = VL53LX_ERROR_NONE;
+
+	VL53LX_LLDriverData_t *pdev =
+			VL53LXDevStructGetLLDriverHandle(Dev);
+	VL53LX_histogram_bin_data_t *pHD = &(pdev->hist_data);
+
+	LOG_FUNCTION_START("");
+
+
+
+	if ((pdev->sys_ctrl.system__mode_start &
+		 VL53LX_DEVICESCHEDULERMODE_HISTOGRAM)
+		 != VL53LX_DEVICESCHEDULERMODE_HISTOGRAM)
+		status = VL53LX_ERROR_MODE_NOT_SUPPORTED;
+
+
+
+	if (status == VL53LX_ERROR_NONE &&
+		pdev->zone_cfg.active_zones > 0)
+		status = VL53LX_ERROR_NOT_SUPPORTED;
+
+	pdev->hist_data_latched = 0;
+
+	if (status == VL53LX_ERROR_NONE)
+		status = VL53LX_get_histogram_bin_data(
+						Dev,
+						&(pdev->hist_data));
+
+
+
+	if (status == VL53LX_ERROR_NONE) {
+		pdev->sys_results.result__stream_count =
+			pHD->result__stream_count;
+		status = VL53LX_check_ll_driver_rd_state(Dev);
+	}
+
+	if (status == VL53LX_ERROR_NONE)
+		pdev->hist_data_latched = 1;
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+
 VL53LX_Error VL53LX_clear_interrupt_and_enable_next_range(
 	VL53LX_DEV        Dev,
 	uint8_t           measurement_mode)
@@ -2722,6 +2910,8 @@ VL53LX_Error VL53LX_get_histogram_bin_data(
 
 	pdata->cfg_device_state = pdev->ll_state.cfg_device_state;
 	pdata->rd_device_state  = pdev->ll_state.rd_device_state;
+	pdev->hist_cfg_internal_stream_count =
+		pdev->ll_state.cfg_internal_stream_count;
 
 
 
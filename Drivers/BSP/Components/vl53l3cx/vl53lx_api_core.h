@@ -98,6 +98,28 @@ VL53LX_Error VL53LX_read_p2p_data(
 
 
 
+VL53LX_Error VL53LX_read_p2p_data_step(
+	VL53LX_DEV      Dev,
+	uint8_t         step,
+	uint8_t        *pdone);
+
+
+
+
+VL53LX_Error VL53LX_get_p2p_data(
+	VL53LX_DEV                            Dev,
+	VL53LX_p2p_data_t                    *pp2p_data);
+
+
+
+
+VL53LX_Error VL53LX_set_p2p_data(
+	VL53LX_DEV                            Dev,
+	VL53LX_p2p_data_t                    *pp2p_data);
+
+
+
+
 VL53LX_Error VL53LX_set_part_to_part_data(
 	VL53LX_DEV                            Dev,
 	VL53LX_calibration_data_t            *pcal_data);
@@ -240,6 +262,12 @@ VL53LX_Error VL53LX_get_device_results(
 
 
 
+VL53LX_Error VL53LX_latch_histogram_data(
+	VL53LX_DEV                 Dev);
+
+
+
+
 VL53LX_Error VL53LX_clear_interrupt_and_enable_next_range(
 	VL53LX_DEV       Dev,
 	uint8_t          measurement_mode);
@@ -126,6 +126,8 @@ void  VL53LX_init_ll_driver_state(
 	pstate->rd_timing_status  = 0;
 	pstate->rd_zone_id        = 0;
 
+	pdev->hist_data_latched   = 0;
+
 }
 
 
@@ -71,6 +71,8 @@
 #include "vl53lx_ll_def.h"
 #include "vl53lx_ll_device.h"
 #include "vl53lx_core_support.h"
+#include "vl53lx_hist_kernels.h"
+#include "vl53lx_hist_math.h"
 
 
 
@@ -167,8 +169,8 @@ uint32_t VL53LX_events_per_spad_maths(
 			* 1000 * 256);
 
 	if (num_spads != 0)
-		total_hist_counts = do_division_u(
-				dividend, (uint64_t)num_spads);
+		total_hist_counts = VL53LX_hist_div_u64(
+				dividend, (uint32_t)num_spads);
 
 
 
@@ -178,7 +180,7 @@ uint32_t VL53LX_events_per_spad_maths(
 		uint64_t dividend = (((uint64_t)(total_hist_counts << 11))
 			+ ((uint64_t)duration / 2));
 
-		xtalk_per_spad = do_division_u(dividend, (uint64_t)duration);
+		xtalk_per_spad = VL53LX_hist_div_u64(dividend, duration);
 	} else {
 		xtalk_per_spad =   (uint64_t)(total_hist_counts << 11);
 	}
@@ -191,27 +193,7 @@ uint32_t VL53LX_events_per_spad_maths(
 
 uint32_t VL53LX_isqrt(uint32_t num)
 {
-
-
-
-	uint32_t  res = 0;
-	uint32_t  bit = 1 << 30;
-
-
-	while (bit > num)
-		bit >>= 2;
-
-	while (bit != 0) {
-		if (num >= res + bit)  {
-			num -= res + bit;
-			res = (res >> 1) + bit;
-		} else {
-			res >>= 1;
-		}
-		bit >>= 2;
-	}
-
-	return res;
+	return VL53LX_hist_isqrt(num);
 }
 
 
@@ -297,7 +279,6 @@ void  VL53LX_hist_remove_ambient_bins(
 
 
 
-	uint8_t bin = 0;
 	uint8_t lc = 0;
 	uint8_t i = 0;
 
@@ -325,11 +306,10 @@ void  VL53LX_hist_remove_ambient_bins(
 	if (pdata->number_of_ambient_bins > 0) {
 
 
-		for (bin = pdata->number_of_ambient_bins;
-				bin < pdata->VL53LX_p_020; bin++) {
-			pdata->bin_data[bin-pdata->number_of_ambient_bins] =
-				pdata->bin_data[bin];
-		}
+		VL53LX_hist_shift_bins(
+			pdata->bin_data,
+			pdata->number_of_ambient_bins,
+			pdata->VL53LX_p_020);
 
 
 		pdata->VL53LX_p_021 =
@@ -661,7 +641,6 @@ void  VL53LX_hist_estimate_ambient_from_ambient_bins(
 {
 
 
-	uint8_t  bin            = 0;
 
 	LOG_FUNCTION_START("");
 
@@ -672,9 +651,10 @@ void  VL53LX_hist_estimate_ambient_from_ambient_bins(
 
 
 
-		pdata->ambient_events_sum = 0;
-		for (bin = 0; bin < pdata->number_of_ambient_bins; bin++)
-			pdata->ambient_events_sum += pdata->bin_data[bin];
+		pdata->ambient_events_sum =
+			VL53LX_hist_sum_bins(
+				pdata->bin_data,
+				pdata->number_of_ambient_bins);
 
 		pdata->VL53LX_p_028 = pdata->ambient_events_sum;
 		pdata->VL53LX_p_028 +=
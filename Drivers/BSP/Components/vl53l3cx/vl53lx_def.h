@@ -150,6 +150,20 @@ typedef struct {
 	/*!< Defines the allowed total time for a single measurement */
 } VL53LX_DeviceParameters_t;
 
+/** @brief Histogram ranging setup kept while the device ranges on its own
+ *  against distance thresholds (see @a VL53LX_StartThresholdRanging())
+ */
+typedef struct {
+	uint8_t Active;
+	/*!< Threshold ranging is running */
+	uint32_t PhaseCalTimeoutUs;
+	uint32_t MmTimeoutUs;
+	uint32_t RangeTimeoutUs;
+	/*!< Timeouts of the histogram ranging */
+	uint32_t InterMeasurementPeriodMs;
+	/*!< Inter measurement period of the histogram ranging */
+} VL53LX_ThresholdRangingData_t;
+
 
 /** @defgroup VL53LX_define_Smudge_Mode_group Defines smudge correction modes
  *  Defines the smudge correction modes
@@ -226,8 +240,8 @@ typedef struct {
  */
 typedef struct {
 	uint32_t TimeStamp;
-		/*!< 32-bit time stamp.
-		 * @warning Not yet implemented
+		/*!< 32-bit time stamp in units of VL53LX_GetTimerFrequency(),
+		 * taken when the ranging data is filled up.
 		 */
 
 	uint8_t StreamCount;
@@ -254,6 +268,30 @@ typedef struct {
 		 */
 } VL53LX_MultiRangingData_t;
 
+/**
+ * @struct  VL53LX_PrimaryRangingData_t
+ * @brief   Structure for storing the range result of the primary target only
+ *
+ */
+typedef struct {
+	uint32_t TimeStamp;
+		/*!< 32-bit time stamp in units of VL53LX_GetTimerFrequency(),
+		 * taken when the ranging data is filled up.
+		 */
+
+	uint8_t StreamCount;
+		/*!< 8-bit Stream Count. */
+
+	uint8_t NumberOfObjectsFound;
+		/*!< Indicate the number of objects found, only the first one
+		 * is converted to RangeData.
+		 */
+	VL53LX_TargetRangeData_t RangeData;
+		/*!< Range data of the primary target */
+	uint8_t HasXtalkValueChanged;
+		/*!< set to 1 if a new Xtalk value has been computed */
+} VL53LX_PrimaryRangingData_t;
+
 
 
 /**
@@ -371,6 +409,9 @@ typedef struct {
 	VL53LX_DeviceParameters_t CurrentParameters;
 	/*!< Current Device Parameter */
 
+	VL53LX_ThresholdRangingData_t ThresholdRanging;
+	/*!< Saved histogram ranging setup */
+
 } VL53LX_DevData_t;
 
 
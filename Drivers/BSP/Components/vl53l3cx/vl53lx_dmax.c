@@ -84,6 +84,7 @@
 #include <vl53lx_types.h>
 #include "vl53lx_core_support.h"
 #include "vl53lx_error_codes.h"
+#include "vl53lx_hist_math.h"
 
 #include "vl53lx_dmax.h"
 
@@ -211,7 +212,8 @@ VL53LX_Error VL53LX_f_001(
 			tmp64 <<= (11+1);
 			tmp64  +=
 			((uint64_t)pdata->VL53LX_p_033/2);
-			tmp64  /=  (uint64_t)pdata->VL53LX_p_033;
+			tmp64   = VL53LX_hist_div_u64(tmp64,
+				pdata->VL53LX_p_033);
 
 			if (tmp64 < (uint64_t)pcfg->max_effective_spads)
 				pdata->VL53LX_p_004 = (uint16_t)tmp64;
@@ -241,7 +243,8 @@ VL53LX_Error VL53LX_f_001(
 		tmp64  = (uint64_t)pcal->ref__peak_signal_count_rate_mcps;
 		tmp64 *= (1000 * 256);
 		tmp64 += ((uint64_t)pcal->ref__actual_effective_spads/2);
-		tmp64 /=  (uint64_t)pcal->ref__actual_effective_spads;
+		tmp64  = VL53LX_hist_div_u64(tmp64,
+			(uint32_t)pcal->ref__actual_effective_spads);
 
 		pdata->VL53LX_p_009   = (uint32_t)tmp64;
 		pdata->VL53LX_p_009 <<= 4;
@@ -257,7 +260,7 @@ VL53LX_Error VL53LX_f_001(
 		tmp64  += (1<<(11+7));
 		tmp64 >>= (11+8);
 		tmp64  +=  500;
-		tmp64  /= 1000;
+		tmp64   = VL53LX_hist_div_u64(tmp64, 1000);
 
 
 
@@ -287,10 +290,11 @@ VL53LX_Error VL53LX_f_001(
 				   (uint64_t)pcal->coverglass_transmission);
 
 		tmp64  += (((uint64_t)pcal->ref_reflectance_pc * 256)/2);
-		tmp64  /=  ((uint64_t)pcal->ref_reflectance_pc * 256);
+		tmp64   = VL53LX_hist_div_u64(tmp64,
+			(uint32_t)pcal->ref_reflectance_pc * 256);
 
 		tmp64  +=  500;
-		tmp64  /= 1000;
+		tmp64   = VL53LX_hist_div_u64(tmp64, 1000);
 
 
 
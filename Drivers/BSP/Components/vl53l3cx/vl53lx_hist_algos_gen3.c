@@ -87,6 +87,7 @@
 
 #include "vl53lx_hist_core.h"
 #include "vl53lx_hist_algos_gen3.h"
+#include "vl53lx_hist_kernels.h"
 #include "vl53lx_sigma_estimate.h"
 #include "vl53lx_dmax.h"
 
@@ -1258,51 +1259,20 @@ VL53LX_Error VL53LX_f_012(
 
 	VL53LX_hist_pulse_data_t *pdata = &(palgo->VL53LX_p_003[pulse_no]);
 
-	uint8_t  lb            = 0;
-	uint8_t  i            = 0;
-	uint8_t  j            = 0;
-	uint8_t  w            = 0;
-
 	LOG_FUNCTION_START("");
 
 
 
 
-	for (lb = pdata->VL53LX_p_012; lb <= pdata->VL53LX_p_013; lb++) {
-
-		i =  lb  % palgo->VL53LX_p_030;
-
-
-
-		palgo->VL53LX_p_043[i]  = 0;
-		palgo->VL53LX_p_018[i] = 0;
-
-		for (w = 0; w < (pdata->VL53LX_p_051 << 1); w++) {
-
-
-
-
-
-			j = lb + w + palgo->VL53LX_p_030;
-			j = j - pdata->VL53LX_p_051;
-			j = j % palgo->VL53LX_p_030;
-
-
-
-
-
-
-			if (i < ppulse->VL53LX_p_021 && j <
-					ppulse->VL53LX_p_021) {
-				if (w < pdata->VL53LX_p_051)
-					palgo->VL53LX_p_043[i] +=
-						ppulse->bin_data[j];
-				else
-					palgo->VL53LX_p_043[i] -=
-						ppulse->bin_data[j];
-			}
-		}
-	}
+	VL53LX_hist_difference_filter(
+			ppulse->bin_data,
+			ppulse->VL53LX_p_021,
+			pdata->VL53LX_p_051,
+			pdata->VL53LX_p_012,
+			pdata->VL53LX_p_013,
+			palgo->VL53LX_p_030,
+			palgo->VL53LX_p_043,
+			palgo->VL53LX_p_018);
 
 	return status;
 }
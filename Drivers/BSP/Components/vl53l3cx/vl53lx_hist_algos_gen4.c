@@ -88,6 +88,7 @@
 #include "vl53lx_hist_core.h"
 #include "vl53lx_hist_algos_gen3.h"
 #include "vl53lx_hist_algos_gen4.h"
+#include "vl53lx_hist_kernels.h"
 #include "vl53lx_sigma_estimate.h"
 #include "vl53lx_dmax.h"
 
@@ -522,11 +523,6 @@ VL53LX_Error VL53LX_f_026(
 
 	VL53LX_hist_pulse_data_t *pdata = &(palgo3->VL53LX_p_003[pulse_no]);
 
-	uint8_t  lb     = 0;
-	uint8_t  i     = 0;
-	int32_t  suma  = 0;
-	int32_t  sumb  = 0;
-	int32_t  sumc  = 0;
 
 	LOG_FUNCTION_START("");
 
@@ -537,40 +533,19 @@ VL53LX_Error VL53LX_f_026(
 
 
 
-	for (lb = pdata->VL53LX_p_012; lb <= pdata->VL53LX_p_013; lb++) {
-
-		i =  lb  % palgo3->VL53LX_p_030;
-
-
-
-		VL53LX_f_022(
-				i,
-				pdata->VL53LX_p_051,
-				ppulse,
-				&suma,
-				&sumb,
-				&sumc);
-
-
-
-		pfiltered->VL53LX_p_007[i] = suma;
-		pfiltered->VL53LX_p_032[i] = sumb;
-		pfiltered->VL53LX_p_001[i] = sumc;
-
-
-
-
-		pfiltered->VL53LX_p_053[i] =
-			(suma + sumb) -
-			(sumc + palgo3->VL53LX_p_028);
-
-
-
-
-		pfiltered->VL53LX_p_054[i] =
-			(sumb + sumc) -
-			(suma + palgo3->VL53LX_p_028);
-	}
+	VL53LX_hist_window_filter(
+			ppulse->bin_data,
+			ppulse->VL53LX_p_021,
+			pdata->VL53LX_p_051,
+			pdata->VL53LX_p_012,
+			pdata->VL53LX_p_013,
+			palgo3->VL53LX_p_030,
+			palgo3->VL53LX_p_028,
+			pfiltered->VL53LX_p_007,
+			pfiltered->VL53LX_p_032,
+			pfiltered->VL53LX_p_001,
+			pfiltered->VL53LX_p_053,
+			pfiltered->VL53LX_p_054);
 
 	return status;
 }
@@ -88,6 +88,7 @@
 #include "vl53lx_sigma_estimate.h"
 
 #include "vl53lx_hist_core.h"
+#include "vl53lx_hist_kernels.h"
 
 
 
@@ -396,6 +397,7 @@ void  VL53LX_f_005(
 	uint8_t min_bins   = 0;
 	int8_t  bin_offset = 0;
 	int8_t  bin_access = 0;
+	uint8_t run        = 0;
 
 	LOG_FUNCTION_START("");
 
@@ -444,51 +446,80 @@ void  VL53LX_f_005(
 		min_bins = pbins->VL53LX_p_021;
 
 
-	for (i = 0 ; i <  min_bins ; i++) {
-
+	if (min_bins > 0) {
 
 
 
 		if (bin_offset >= 0)
-			bin_access = ((int8_t)i + (int8_t)bin_offset)
-				% (int8_t)pbins->VL53LX_p_021;
+			bin_access = (int8_t)bin_offset;
 		else
-			bin_access = ((int8_t)pbins->VL53LX_p_021 +
-				((int8_t)i + (int8_t)bin_offset))
-					% (int8_t)pbins->VL53LX_p_021;
-
-		trace_print(
-			VL53LX_TRACE_LEVEL_DEBUG,
-			"Subtract:     %8d : %8d : %8d : %8d : %8d : %8d\n",
-			i, bin_access, bin_offset, pbins->VL53LX_p_021,
-			pbins->bin_data[(uint8_t)bin_access],
-			pxtalk->bin_data[i]);
+			bin_access = (int8_t)pbins->VL53LX_p_021 +
+				(int8_t)bin_offset;
 
 
 
 
-		if (pbins->bin_data[(uint8_t)bin_access] >
-			pxtalk->bin_data[i]) {
-
-			pbins->bin_data[(uint8_t)bin_access] =
-				pbins->bin_data[(uint8_t)bin_access]
-				- pxtalk->bin_data[i];
+		if (bin_access >= 0) {
+			bin_access = bin_access
+				% (int8_t)pbins->VL53LX_p_021;
 
+			run = pbins->VL53LX_p_021 - (uint8_t)bin_access;
+			if (run > min_bins)
+				run = min_bins;
+
+			trace_print(
+				VL53LX_TRACE_LEVEL_DEBUG,
+				"Subtract:     %8d : %8d : %8d : %8d : %8d bins\n",
+				0, bin_access, bin_offset, pbins->VL53LX_p_021,
+				run);
+
+			VL53LX_hist_subtract_bins(
+				&(pbins->bin_data[(uint8_t)bin_access]),
+				&(pxtalk->bin_data[0]),
+				&(pxtalk_realigned->bin_data[(uint8_t)bin_access]),
+				run);
+
+			trace_print(
+				VL53LX_TRACE_LEVEL_DEBUG,
+				"Subtract:     %8d : %8d : %8d : %8d : %8d bins\n",
+				run, 0, bin_offset, pbins->VL53LX_p_021,
+				min_bins - run);
+
+			VL53LX_hist_subtract_bins(
+				&(pbins->bin_data[0]),
+				&(pxtalk->bin_data[run]),
+				&(pxtalk_realigned->bin_data[0]),
+				min_bins - run);
 		} else {
-			pbins->bin_data[(uint8_t)bin_access] = 0;
-		}
-
-
-
-
-
-
-		pxtalk_realigned->bin_data[(uint8_t)bin_access] =
-			pxtalk->bin_data[i];
-
-
-
 
+			/*
+			 * Offset beyond a whole period back - bin by bin as the
+			 * ST loop, without the bins it wrote before bin_data
+			 */
+			for (i = 0 ; i <  min_bins ; i++) {
+
+				bin_access = ((int8_t)pbins->VL53LX_p_021 +
+					((int8_t)i + (int8_t)bin_offset))
+						% (int8_t)pbins->VL53LX_p_021;
+
+				if (bin_access < 0)
+					continue;
+
+				trace_print(
+					VL53LX_TRACE_LEVEL_DEBUG,
+					"Subtract:     %8d : %8d : %8d : %8d : %8d : %8d\n",
+					i, bin_access, bin_offset,
+					pbins->VL53LX_p_021,
+					pbins->bin_data[(uint8_t)bin_access],
+					pxtalk->bin_data[i]);
+
+				VL53LX_hist_subtract_bins(
+					&(pbins->bin_data[(uint8_t)bin_access]),
+					&(pxtalk->bin_data[i]),
+					&(pxtalk_realigned->bin_data[(uint8_t)bin_access]),
+					1);
+			}
+		}
 	}
 
 
@@ -0,0 +1,345 @@
+/*
+ * vl53lx_hist_kernels.c
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#include "vl53lx_hist_kernels.h"
+
+#if defined(__ARM_FEATURE_DSP) || defined(VL53LX_HIST_KERNELS_EMULATE_DSP)
+#define VL53LX_HIST_KERNELS_DSP
+#include "cmsis_compiler.h"
+#endif
+
+
+int32_t VL53LX_hist_sum_bins_ref(
+	const int32_t *pbins,
+	uint8_t        count)
+{
+	int32_t sum = 0;
+	uint8_t bin = 0;
+
+	for (bin = 0; bin < count; bin++)
+		sum += pbins[bin];
+
+	return sum;
+}
+
+
+int32_t VL53LX_hist_sum_bins_fast(
+	const int32_t *pbins,
+	uint8_t        count)
+{
+	/* Two accumulators keep the loads back to back (LDRD on the M33) */
+	uint32_t sum0 = 0;
+	uint32_t sum1 = 0;
+	uint8_t  bin  = 0;
+
+	for (; bin + 1 < count; bin += 2) {
+		sum0 += (uint32_t)pbins[bin];
+		sum1 += (uint32_t)pbins[bin + 1];
+	}
+
+	if (bin < count)
+		sum0 += (uint32_t)pbins[bin];
+
+	return (int32_t)(sum0 + sum1);
+}
+
+
+void VL53LX_hist_shift_bins_ref(
+	int32_t *pbins,
+	uint8_t  shift,
+	uint8_t  end)
+{
+	uint8_t bin = 0;
+
+	for (bin = shift; bin < end; bin++)
+		pbins[bin - shift] = pbins[bin];
+}
+
+
+void VL53LX_hist_shift_bins_fast(
+	int32_t *pbins,
+	uint8_t  shift,
+	uint8_t  end)
+{
+	if (shift > 0 && shift < end)
+		memmove(pbins, pbins + shift, (end - shift) * sizeof(int32_t));
+}
+
+
+void VL53LX_hist_subtract_bins_ref(
+	int32_t       *pbins,
+	const int32_t *psub,
+	int32_t       *pcopy,
+	uint8_t        count)
+{
+	uint8_t bin = 0;
+
+	for (bin = 0; bin < count; bin++) {
+		if (pbins[bin] > psub[bin])
+			pbins[bin] = pbins[bin] - psub[bin];
+		else
+			pbins[bin] = 0;
+
+		pcopy[bin] = psub[bin];
+	}
+}
+
+
+void VL53LX_hist_subtract_bins_fast(
+	int32_t       *pbins,
+	const int32_t *psub,
+	int32_t       *pcopy,
+	uint8_t        count)
+{
+	uint8_t bin = 0;
+
+	for (bin = 0; bin < count; bin++) {
+#ifdef VL53LX_HIST_KERNELS_DSP
+		/* Saturating subtract, then negative to 0 - no branch */
+		pbins[bin] = (int32_t)__USAT(__QSUB(pbins[bin], psub[bin]), 31);
+#else
+		int32_t diff = pbins[bin] - psub[bin];
+
+		pbins[bin] = diff & ~(diff >> 31);
+#endif
+		pcopy[bin] = psub[bin];
+	}
+}
+
+
+void VL53LX_hist_window_filter_ref(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t        ambient,
+	int32_t       *pa,
+	int32_t       *pb,
+	int32_t       *pc,
+	int32_t       *pab,
+	int32_t       *pbc)
+{
+	uint8_t lb = 0;
+	uint8_t i  = 0;
+	uint8_t w  = 0;
+	uint8_t j  = 0;
+	int32_t a  = 0;
+	int32_t b  = 0;
+	int32_t c  = 0;
+
+	for (lb = first; lb <= last; lb++) {
+		i = lb % period;
+
+		a = 0;
+		b = pbins[i];
+		c = 0;
+
+		for (w = 0 ; w < ((woi << 1)+1) ; w++) {
+			j = ((i + w + bins) - woi) % bins;
+
+			if (w < woi)
+				a += pbins[j];
+			else if (w > woi)
+				c += pbins[j];
+		}
+
+		pa[i]  = a;
+		pb[i]  = b;
+		pc[i]  = c;
+		pab[i] = (a + b) - (c + ambient);
+		pbc[i] = (b + c) - (a + ambient);
+	}
+}
+
+
+void VL53LX_hist_window_filter_fast(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t        ambient,
+	int32_t       *pa,
+	int32_t       *pb,
+	int32_t       *pc,
+	int32_t       *pab,
+	int32_t       *pbc)
+{
+	/*
+	 * The windows slide by one bin from one filtered bin to the next, so
+	 * one bin enters and one leaves each sum instead of summing 2 * woi
+	 * bins again. The sums restart where the bin index wraps at period.
+	 */
+	uint8_t  lb   = 0;
+	uint8_t  i    = 0;
+	uint8_t  w    = 0;
+	uint8_t  cur  = 0;
+	uint8_t  tail = 0;
+	uint8_t  head = 0;
+	int16_t  next = -1;
+	uint32_t a    = 0;
+	uint32_t b    = 0;
+	uint32_t c    = 0;
+
+	if (bins == 0 || period == 0 || woi >= bins) {
+		VL53LX_hist_window_filter_ref(pbins, bins, woi, first, last,
+			period, ambient, pa, pb, pc, pab, pbc);
+		return;
+	}
+
+	for (lb = first; lb <= last; lb++) {
+		i = lb % period;
+
+		if (i != next) {
+			a = 0;
+			c = 0;
+
+			for (w = 1; w <= woi; w++) {
+				a += (uint32_t)pbins[(i + bins - w) % bins];
+				c += (uint32_t)pbins[(i + w) % bins];
+			}
+
+			cur  = i % bins;
+			tail = (i + bins - woi) % bins;
+			head = (i + woi + 1) % bins;
+		}
+
+		b = (uint32_t)pbins[i];
+
+		pa[i]  = (int32_t)a;
+		pb[i]  = (int32_t)b;
+		pc[i]  = (int32_t)c;
+		pab[i] = (int32_t)((a + b) - (c + (uint32_t)ambient));
+		pbc[i] = (int32_t)((b + c) - (a + (uint32_t)ambient));
+
+		/* Slide the windows to bin i + 1 */
+		a += (uint32_t)pbins[cur] - (uint32_t)pbins[tail];
+		cur = (cur + 1 == bins) ? 0 : cur + 1;
+		c += (uint32_t)pbins[head] - (uint32_t)pbins[cur];
+		tail = (tail + 1 == bins) ? 0 : tail + 1;
+		head = (head + 1 == bins) ? 0 : head + 1;
+		next = (int16_t)i + 1;
+	}
+}
+
+
+void VL53LX_hist_difference_filter_ref(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t       *pfilt,
+	int32_t       *pzero)
+{
+	uint8_t lb = 0;
+	uint8_t i  = 0;
+	uint8_t j  = 0;
+	uint8_t w  = 0;
+
+	for (lb = first; lb <= last; lb++) {
+
+		i =  lb  % period;
+
+		pfilt[i] = 0;
+		pzero[i] = 0;
+
+		for (w = 0; w < (woi << 1); w++) {
+
+			j = lb + w + period;
+			j = j - woi;
+			j = j % period;
+
+			if (i < bins && j < bins) {
+				if (w < woi)
+					pfilt[i] += pbins[j];
+				else
+					pfilt[i] -= pbins[j];
+			}
+		}
+	}
+}
+
+
+void VL53LX_hist_difference_filter_fast(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t       *pfilt,
+	int32_t       *pzero)
+{
+	/*
+	 * As in the window filter, one bin enters and one leaves each window
+	 * from one lb to the next. The windows are circular over period, so
+	 * they slide across the wrap of the bin index without a restart.
+	 * The reference computes the bin indexes in uint8_t - where they could
+	 * wrap at 256 the reference is called instead.
+	 */
+	uint8_t  lb   = 0;
+	uint8_t  i    = 0;
+	uint8_t  w    = 0;
+	uint8_t  tail = 0;
+	uint8_t  head = 0;
+	uint32_t a    = 0;
+	uint32_t c    = 0;
+	uint32_t in   = 0;
+
+	if (period == 0 || woi > period ||
+		((uint16_t)last + period + (woi << 1)) > 0xFF) {
+		VL53LX_hist_difference_filter_ref(pbins, bins, woi, first, last,
+			period, pfilt, pzero);
+		return;
+	}
+
+	if (first > last)
+		return;
+
+	i = first % period;
+
+	for (w = 1; w <= woi; w++) {
+		tail = (i + period - w) % period;
+		head = (i + w - 1) % period;
+
+		if (tail < bins)
+			a += (uint32_t)pbins[tail];
+		if (head < bins)
+			c += (uint32_t)pbins[head];
+	}
+
+	tail = (i + period - woi) % period;
+	head = (i + woi) % period;
+
+	for (lb = first; lb <= last; lb++) {
+
+		pfilt[i] = (i < bins) ? (int32_t)(a - c) : 0;
+		pzero[i] = 0;
+
+		if (lb == last)
+			break;
+
+		/* Slide the windows to lb + 1 */
+		in = (i < bins) ? (uint32_t)pbins[i] : 0;
+		a += in;
+		c -= in;
+
+		if (tail < bins)
+			a -= (uint32_t)pbins[tail];
+		if (head < bins)
+			c += (uint32_t)pbins[head];
+
+		i    = (i + 1 == period) ? 0 : i + 1;
+		tail = (tail + 1 == period) ? 0 : tail + 1;
+		head = (head + 1 == period) ? 0 : head + 1;
+	}
+}
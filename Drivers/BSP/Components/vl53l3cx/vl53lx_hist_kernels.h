@@ -0,0 +1,151 @@
+/*
+ * vl53lx_hist_kernels.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#ifndef _VL53LX_HIST_KERNELS_H_
+#define _VL53LX_HIST_KERNELS_H_
+
+#include "vl53lx_types.h"
+#include "vl53lx_platform_user_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Loops over the histogram bins of the post-processing.
+ *
+ * Each kernel has a reference version (_ref), which is the loop of the ST
+ * driver as it was, and a fast version (_fast) with bit-exact the same
+ * results for histogram data (any sum or difference of bins fits int32).
+ * The driver calls the fast versions when VL53LX_HIST_KERNELS is 1 in
+ * vl53lx_platform_user_config.h. The fast versions use the DSP instructions
+ * of the Cortex-M33 when the compiler targets them (__ARM_FEATURE_DSP).
+ *
+ * Tools/HistBench (make check) compares the fast versions to the references.
+ */
+
+/**
+ * @brief Sum of count bins
+ */
+int32_t VL53LX_hist_sum_bins_ref(
+	const int32_t *pbins,
+	uint8_t        count);
+
+int32_t VL53LX_hist_sum_bins_fast(
+	const int32_t *pbins,
+	uint8_t        count);
+
+/**
+ * @brief Moves bins [shift, end) down by shift bins
+ */
+void VL53LX_hist_shift_bins_ref(
+	int32_t *pbins,
+	uint8_t  shift,
+	uint8_t  end);
+
+void VL53LX_hist_shift_bins_fast(
+	int32_t *pbins,
+	uint8_t  shift,
+	uint8_t  end);
+
+/**
+ * @brief Subtracts psub from pbins, clamped at 0, and copies psub to pcopy
+ */
+void VL53LX_hist_subtract_bins_ref(
+	int32_t       *pbins,
+	const int32_t *psub,
+	int32_t       *pcopy,
+	uint8_t        count);
+
+void VL53LX_hist_subtract_bins_fast(
+	int32_t       *pbins,
+	const int32_t *psub,
+	int32_t       *pcopy,
+	uint8_t        count);
+
+/**
+ * @brief Window sums of the gen4 pulse filter (VL53LX_f_026).
+ *
+ * For each bin i = lb % period, lb in [first, last]: pa[i] and pc[i] are the
+ * sums of the woi bins before and after bin i (circular over bins), pb[i] is
+ * bin i, pab[i] = a + b - c - ambient and pbc[i] = b + c - a - ambient.
+ */
+void VL53LX_hist_window_filter_ref(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t        ambient,
+	int32_t       *pa,
+	int32_t       *pb,
+	int32_t       *pc,
+	int32_t       *pab,
+	int32_t       *pbc);
+
+void VL53LX_hist_window_filter_fast(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t        ambient,
+	int32_t       *pa,
+	int32_t       *pb,
+	int32_t       *pc,
+	int32_t       *pab,
+	int32_t       *pbc);
+
+/**
+ * @brief Difference filter of the gen3 pulse detection (VL53LX_f_012).
+ *
+ * For each bin i = lb % period, lb in [first, last]: pfilt[i] is the sum of
+ * the woi bins before lb less the sum of the woi bins from lb on (circular
+ * over period, bins from bins on count as 0) and pfilt[i] is 0 when i is
+ * not below bins. pzero[i] is cleared.
+ */
+void VL53LX_hist_difference_filter_ref(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t       *pfilt,
+	int32_t       *pzero);
+
+void VL53LX_hist_difference_filter_fast(
+	const int32_t *pbins,
+	uint8_t        bins,
+	uint8_t        woi,
+	uint8_t        first,
+	uint8_t        last,
+	uint8_t        period,
+	int32_t       *pfilt,
+	int32_t       *pzero);
+
+#if VL53LX_HIST_KERNELS
+#define VL53LX_hist_sum_bins        VL53LX_hist_sum_bins_fast
+#define VL53LX_hist_shift_bins      VL53LX_hist_shift_bins_fast
+#define VL53LX_hist_subtract_bins   VL53LX_hist_subtract_bins_fast
+#define VL53LX_hist_window_filter   VL53LX_hist_window_filter_fast
+#define VL53LX_hist_difference_filter VL53LX_hist_difference_filter_fast
+#else
+#define VL53LX_hist_sum_bins        VL53LX_hist_sum_bins_ref
+#define VL53LX_hist_shift_bins      VL53LX_hist_shift_bins_ref
+#define VL53LX_hist_subtract_bins   VL53LX_hist_subtract_bins_ref
+#define VL53LX_hist_window_filter   VL53LX_hist_window_filter_ref
+#define VL53LX_hist_difference_filter VL53LX_hist_difference_filter_ref
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VL53LX_HIST_KERNELS_H_ */
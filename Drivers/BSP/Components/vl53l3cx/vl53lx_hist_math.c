@@ -0,0 +1,208 @@
+/*
+ * vl53lx_hist_math.c
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#include "vl53lx_hist_math.h"
+
+#if defined(__GNUC__)
+#define VL53LX_HIST_MATH_CLZ(x)    ((uint32_t)__builtin_clz(x))
+#else
+static uint32_t VL53LX_hist_math_clz(uint32_t x)
+{
+	uint32_t n = 0;
+
+	while (!(x & 0x80000000)) {
+		x <<= 1;
+		n++;
+	}
+
+	return n;
+}
+#define VL53LX_HIST_MATH_CLZ(x)    VL53LX_hist_math_clz(x)
+#endif
+
+/*
+ * Square root seeds: ceil(sqrt((i + 1) << 24)) for the top byte i = 64..255
+ * of a number normalised by an even shift, capped at 0xFFFF
+ */
+#define VL53LX_HIST_SQRT_SEED_FIRST  64
+
+static const uint16_t VL53LX_hist_sqrt_seed[] = {
+	33024, 33277, 33528, 33777, 34024, 34270, 34514, 34756,
+	34997, 35236, 35473, 35709, 35943, 36175, 36407, 36636,
+	36864, 37091, 37317, 37541, 37764, 37985, 38205, 38424,
+	38642, 38859, 39074, 39288, 39501, 39713, 39923, 40133,
+	40341, 40549, 40755, 40960, 41165, 41368, 41570, 41772,
+	41972, 42171, 42370, 42567, 42764, 42960, 43155, 43348,
+	43542, 43734, 43925, 44116, 44306, 44494, 44683, 44870,
+	45056, 45242, 45427, 45612, 45795, 45978, 46160, 46341,
+	46522, 46702, 46881, 47060, 47238, 47415, 47592, 47768,
+	47943, 48118, 48292, 48465, 48638, 48810, 48982, 49152,
+	49323, 49493, 49662, 49830, 49999, 50166, 50333, 50499,
+	50665, 50831, 50995, 51160, 51323, 51486, 51649, 51811,
+	51973, 52134, 52295, 52455, 52615, 52774, 52932, 53091,
+	53248, 53406, 53563, 53719, 53875, 54030, 54185, 54340,
+	54494, 54648, 54801, 54954, 55107, 55259, 55410, 55561,
+	55712, 55862, 56012, 56162, 56311, 56460, 56608, 56756,
+	56904, 57051, 57198, 57344, 57491, 57636, 57782, 57927,
+	58071, 58216, 58360, 58503, 58646, 58789, 58932, 59074,
+	59216, 59357, 59498, 59639, 59780, 59920, 60060, 60199,
+	60338, 60477, 60616, 60754, 60892, 61030, 61167, 61304,
+	61440, 61577, 61713, 61849, 61984, 62119, 62254, 62389,
+	62523, 62657, 62791, 62924, 63058, 63191, 63323, 63455,
+	63588, 63719, 63851, 63982, 64113, 64244, 64374, 64504,
+	64634, 64764, 64893, 65022, 65151, 65280, 65408, 65535,
+};
+
+
+uint32_t VL53LX_hist_isqrt_ref(
+	uint32_t  num)
+{
+	uint32_t  res = 0;
+	uint32_t  bit = 1 << 30;
+
+
+	while (bit > num)
+		bit >>= 2;
+
+	while (bit != 0) {
+		if (num >= res + bit)  {
+			num -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return res;
+}
+
+
+uint32_t VL53LX_hist_isqrt_fast(
+	uint32_t  num)
+{
+	/*
+	 * The seed from the table is at least the root and good to about 8
+	 * bits, then Newton steps go down to floor(sqrt(num)) - two or three
+	 * hardware divides instead of 16 rounds of the bit by bit loop.
+	 */
+	uint32_t  shift = 0;
+	uint32_t  seed  = 0;
+	uint32_t  res   = 0;
+	uint32_t  next  = 0;
+
+	if (num == 0)
+		return 0;
+
+	shift = VL53LX_HIST_MATH_CLZ(num) & ~1u;
+	seed  = VL53LX_hist_sqrt_seed[((num << shift) >> 24) -
+		VL53LX_HIST_SQRT_SEED_FIRST];
+
+	shift >>= 1;
+	res = (seed + (1u << shift) - 1) >> shift;
+
+	for (;;) {
+		next = (res + num / res) >> 1;
+
+		if (next >= res)
+			break;
+
+		res = next;
+	}
+
+	return res;
+}
+
+
+uint64_t VL53LX_hist_div_u64_ref(
+	uint64_t  dividend,
+	uint32_t  divisor)
+{
+	return dividend / (uint64_t)divisor;
+}
+
+
+static uint32_t VL53LX_hist_div_u64_step(
+	uint32_t  high,
+	uint32_t  low,
+	uint32_t  divisor)
+{
+	/*
+	 * (high:low) / divisor with high < divisor, so the quotient fits 32 bits.
+	 * Long division in two 16-bit digits on the 32-bit divider (Hacker's
+	 * Delight, divlu): the divisor is normalised to its top bit, each digit
+	 * is estimated from the top half of the divisor and corrected at most
+	 * twice.
+	 */
+	const uint32_t base  = 0x10000;
+	uint32_t shift = VL53LX_HIST_MATH_CLZ(divisor);
+	uint32_t div1  = 0;
+	uint32_t div0  = 0;
+	uint32_t num32 = 0;
+	uint32_t num21 = 0;
+	uint32_t num10 = 0;
+	uint32_t num1  = 0;
+	uint32_t num0  = 0;
+	uint32_t q1    = 0;
+	uint32_t q0    = 0;
+	uint32_t rhat  = 0;
+
+	divisor <<= shift;
+	div1 = divisor >> 16;
+	div0 = divisor & 0xFFFF;
+
+	num32 = high << shift;
+	if (shift != 0)
+		num32 |= low >> (32 - shift);
+	num10 = low << shift;
+	num1  = num10 >> 16;
+	num0  = num10 & 0xFFFF;
+
+	q1   = num32 / div1;
+	rhat = num32 - q1 * div1;
+
+	while (q1 >= base || q1 * div0 > base * rhat + num1) {
+		q1--;
+		rhat += div1;
+		if (rhat >= base)
+			break;
+	}
+
+	num21 = num32 * base + num1 - q1 * divisor;
+
+	q0   = num21 / div1;
+	rhat = num21 - q0 * div1;
+
+	while (q0 >= base || q0 * div0 > base * rhat + num0) {
+		q0--;
+		rhat += div1;
+		if (rhat >= base)
+			break;
+	}
+
+	return q1 * base + q0;
+}
+
+
+uint64_t VL53LX_hist_div_u64_fast(
+	uint64_t  dividend,
+	uint32_t  divisor)
+{
+	uint32_t  high   = (uint32_t)(dividend >> 32);
+	uint32_t  low    = (uint32_t)dividend;
+	uint32_t  q_high = 0;
+
+	/* Most dividends of the post-processing fit 32 bits - one UDIV */
+	if (high == 0)
+		return (uint64_t)(low / divisor);
+
+	q_high = high / divisor;
+	high  -= q_high * divisor;
+
+	return ((uint64_t)q_high << 32) |
+		VL53LX_hist_div_u64_step(high, low, divisor);
+}
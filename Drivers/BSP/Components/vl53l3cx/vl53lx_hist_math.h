@@ -0,0 +1,65 @@
+/*
+ * vl53lx_hist_math.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+#ifndef _VL53LX_HIST_MATH_H_
+#define _VL53LX_HIST_MATH_H_
+
+#include "vl53lx_types.h"
+#include "vl53lx_platform_user_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed-point primitives of the sigma, dmax and rate calculations.
+ *
+ * As in vl53lx_hist_kernels.h each primitive has a reference version (_ref),
+ * the maths of the ST driver as it was, and a fast version (_fast) with
+ * bit-exact the same results. The fast versions are built on the 32-bit
+ * hardware divider and CLZ of the Cortex-M33 - the 64-bit divide of the
+ * compiler runtime is a software loop there. The driver calls the fast
+ * versions when VL53LX_HIST_MATH is 1 in vl53lx_platform_user_config.h.
+ *
+ * Tools/HistBench (make check) compares the fast versions to the references.
+ */
+
+/**
+ * @brief Integer square root, floor(sqrt(num))
+ */
+uint32_t VL53LX_hist_isqrt_ref(
+	uint32_t  num);
+
+uint32_t VL53LX_hist_isqrt_fast(
+	uint32_t  num);
+
+/**
+ * @brief Unsigned 64-bit by 32-bit division, dividend / divisor.
+ *
+ * The divisor must not be 0.
+ */
+uint64_t VL53LX_hist_div_u64_ref(
+	uint64_t  dividend,
+	uint32_t  divisor);
+
+uint64_t VL53LX_hist_div_u64_fast(
+	uint64_t  dividend,
+	uint32_t  divisor);
+
+#if VL53LX_HIST_MATH
+#define VL53LX_hist_isqrt           VL53LX_hist_isqrt_fast
+#define VL53LX_hist_div_u64         VL53LX_hist_div_u64_fast
+#else
+#define VL53LX_hist_isqrt           VL53LX_hist_isqrt_ref
+#define VL53LX_hist_div_u64         VL53LX_hist_div_u64_ref
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VL53LX_HIST_MATH_H_ */
@@ -1465,8 +1465,6 @@ typedef struct {
 
 	VL53LX_low_power_auto_data_t		low_power_auto_data;
 
-	uint8_t  wArea1[1536];
-	uint8_t  wArea2[512];
 	VL53LX_per_vcsel_period_offset_cal_data_t per_vcsel_cal_data;
 
 	uint8_t bin_rec_pos;
@@ -1480,6 +1478,10 @@ typedef struct {
 	uint8_t PreviousRangeStatus[VL53LX_MAX_RANGE_RESULTS];
 	uint8_t PreviousExtendedRange[VL53LX_MAX_RANGE_RESULTS];
 	uint8_t PreviousStreamCount;
+
+	uint8_t hist_data_latched;
+
+	uint8_t hist_cfg_internal_stream_count;
 } VL53LX_LLDriverData_t;
 
 
@@ -1521,6 +1523,23 @@ typedef struct {
 
 
 
+typedef struct {
+
+	VL53LX_static_nvm_managed_t          stat_nvm;
+	VL53LX_customer_nvm_managed_t        customer;
+	VL53LX_nvm_copy_data_t               nvm_copy_data;
+	VL53LX_optical_centre_t              optical_centre;
+	VL53LX_cal_peak_rate_map_t           cal_peak_rate_map;
+	VL53LX_additional_offset_cal_data_t  add_off_cal_data;
+	VL53LX_dmax_calibration_data_t       fmt_dmax_cal;
+	VL53LX_user_zone_t                   mm_roi;
+	uint8_t  rtn_good_spads[VL53LX_RTN_SPAD_BUFFER_SIZE];
+
+} VL53LX_p2p_data_t;
+
+
+
+
 typedef struct {
 
 	VL53LX_customer_nvm_managed_t        customer;
@@ -84,6 +84,7 @@
 #include <vl53lx_types.h>
 #include "vl53lx_core_support.h"
 #include "vl53lx_error_codes.h"
+#include "vl53lx_hist_math.h"
 
 #include "vl53lx_sigma_estimate.h"
 
@@ -461,7 +462,8 @@ VL53LX_Error VL53LX_f_037(
 			tmp0 = tmp0 * ((uint64_t)c_zp +
 					(uint64_t)cx_zp + (uint64_t)a_zp +
 					(uint64_t)ax_zp);
-			tmp0 = (tmp0 + (b_minus_amb >> 1)) / b_minus_amb;
+			tmp0 = VL53LX_hist_div_u64(tmp0 + (b_minus_amb >> 1),
+				(uint32_t)b_minus_amb);
 
 
 
@@ -473,14 +475,17 @@ VL53LX_Error VL53LX_f_037(
 
 			tmp1 = (uint64_t)pll_period_mm *
 					(uint64_t)pll_period_mm * VL53LX_p_055;
-			tmp1 = (tmp1 + (b_minus_amb >> 1)) / b_minus_amb;
+			tmp1 = VL53LX_hist_div_u64(tmp1 + (b_minus_amb >> 1),
+				(uint32_t)b_minus_amb);
 
 			tmp1 =  tmp1 * VL53LX_p_055;
-			tmp1 = (tmp1 + (b_minus_amb >> 1)) / b_minus_amb;
+			tmp1 = VL53LX_hist_div_u64(tmp1 + (b_minus_amb >> 1),
+				(uint32_t)b_minus_amb);
 
 			tmp1 =  tmp1 * ((uint64_t)VL53LX_p_032 + (uint64_t)bx +
 					(uint64_t)VL53LX_p_028);
-			tmp1 = (tmp1 + (b_minus_amb >> 1)) / b_minus_amb;
+			tmp1 = VL53LX_hist_div_u64(tmp1 + (b_minus_amb >> 1),
+				(uint32_t)b_minus_amb);
 
 
 
@@ -491,7 +496,8 @@ VL53LX_Error VL53LX_f_037(
 
 
 			tmp0 = tmp0 + tmp1;
-			tmp0 = (tmp0 + (b_minus_amb >> 1)) / b_minus_amb;
+			tmp0 = VL53LX_hist_div_u64(tmp0 + (b_minus_amb >> 1),
+				(uint32_t)b_minus_amb);
 			tmp0 = (tmp0 + 0x01) >> 2;
 
 
@@ -640,8 +646,8 @@ VL53LX_Error VL53LX_f_023(
 
 
 
-			tmp1 = tmp1 / b_minus_amb;
-			tmp1 = tmp1 / b_minus_amb;
+			tmp1 = VL53LX_hist_div_u64(tmp1, (uint32_t)b_minus_amb);
+			tmp1 = VL53LX_hist_div_u64(tmp1, (uint32_t)b_minus_amb);
 
 
 
@@ -687,11 +693,11 @@ VL53LX_Error VL53LX_f_023(
 
 
 			if (tmp0 > (uint64_t)VL53LX_D_007) {
-				tmp0 = tmp0 / b_minus_amb;
+				tmp0 = VL53LX_hist_div_u64(tmp0, (uint32_t)b_minus_amb);
 				tmp0 = tmp0 * pll_period_mm;
 			} else {
 				tmp0 = tmp0 * pll_period_mm;
-				tmp0 = tmp0 / b_minus_amb;
+				tmp0 = VL53LX_hist_div_u64(tmp0, (uint32_t)b_minus_amb);
 			}
 
 
@@ -703,12 +709,12 @@ VL53LX_Error VL53LX_f_023(
 
 
 			if (tmp0 > (uint64_t)VL53LX_D_007) {
-				tmp0 = tmp0 / b_minus_amb;
+				tmp0 = VL53LX_hist_div_u64(tmp0, (uint32_t)b_minus_amb);
 				tmp0 = tmp0 / 4;
 				tmp0 = tmp0 * pll_period_mm;
 			} else {
 				tmp0 = tmp0 * pll_period_mm;
-				tmp0 = tmp0 / b_minus_amb;
+				tmp0 = VL53LX_hist_div_u64(tmp0, (uint32_t)b_minus_amb);
 				tmp0 = tmp0 / 4;
 			}
 
@@ -517,3 +517,35 @@ VL53LX_Error VL53LX_poll_for_range_completion(
 }
 
 
+
+VL53LX_Error VL53LX_check_for_boot_completion(
+	VL53LX_DEV    Dev,
+	uint32_t      timeout_ms,
+	uint8_t      *pdone)
+{
+
+
+	VL53LX_Error status       = VL53LX_ERROR_NONE;
+
+	LOG_FUNCTION_START("");
+
+
+
+	status =
+		VL53LX_PollValueMaskEx(
+			Dev,
+			timeout_ms,
+			VL53LX_FIRMWARE__SYSTEM_STATUS,
+			0x01,
+			0x01,
+			pdone);
+
+	if (status == VL53LX_ERROR_NONE && *pdone)
+		VL53LX_init_ll_driver_state(Dev, VL53LX_DEVICESTATE_SW_STANDBY);
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+
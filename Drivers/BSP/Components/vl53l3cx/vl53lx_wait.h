@@ -145,6 +145,14 @@ VL53LX_Error VL53LX_poll_for_range_completion(
 
 
 
+
+VL53LX_Error VL53LX_check_for_boot_completion(
+	VL53LX_DEV      Dev,
+	uint32_t        timeout_ms,
+	uint8_t        *pdone);
+
+
+
 #ifdef __cplusplus
 }
 #endif
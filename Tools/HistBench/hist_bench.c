@@ -0,0 +1,698 @@
+/*
+ *  @file:   hist_bench.c
+ *  @Author: Denislav Trifonov
+ *  @Date:   17.10.2026
+ *  @brief: Host benchmark of the VL53LX histogram post-processing. Histograms
+ *          captured with the HCAP console command (see Core/Inc/hist_capture.h)
+ *          are run through VL53LX_hist_process_data, the same code the firmware
+ *          runs in VL53LX_ProcessPrimaryRangingData, and the time per frame and
+ *          per stage is reported.
+ *
+ *  Build (from this directory):
+ *      make
+ *
+ *  Usage:
+ *      hist_bench [-n repeats] [-x plane offset] [-o results.csv] <capture file>
+ *
+ *      -n  runs of the whole capture, 10 by default. The first run warms up
+ *          the caches and isn't timed.
+ *      -x  enables the crosstalk compensation with this plane offset (same
+ *          units as algo__crosstalk_compensation_plane_offset_kcps) and a
+ *          flat crosstalk shape, to time the crosstalk stages as well.
+ *      -o  writes the range results of every frame, one line per frame:
+ *          sensor, sequence, status, targets, then median range, range status,
+ *          sigma, peak signal and ambient rate of each target. The files of
+ *          two builds must be identical unless the change is meant to alter
+ *          the results.
+ *
+ *  The calibration of the sensors (offsets, crosstalk, gain) is not part of
+ *  the capture, so the driver defaults are used and the ranges differ from the
+ *  captured ones by the offset of the sensor.
+ *
+ *  Stages are timed by wrapping the calls between the source files of the
+ *  driver (-Wl,--wrap in the Makefile), the driver itself is not changed.
+ *  The per frame time is measured in separate runs with the stage timing off.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "vl53lx_hist_funcs.h"
+#include "vl53lx_hist_core.h"
+#include "vl53lx_hist_algos_gen3.h"
+#include "vl53lx_hist_algos_gen4.h"
+#include "vl53lx_hist_private_structs.h"
+#include "vl53lx_dmax_private_structs.h"
+#include "vl53lx_dmax.h"
+#include "vl53lx_xtalk.h"
+#include "vl53lx_core_support.h"
+#include "vl53lx_api_preset_modes.h"
+
+/* The frame layout only - hist_capture.h pulls in the whole ToF driver */
+#define HIST_CAPTURE_SYNC_0      0xA5
+#define HIST_CAPTURE_SYNC_1      0x5A
+#define HIST_CAPTURE_VERSION     1
+#define HIST_CAPTURE_HEADER_SIZE 16
+#define HIST_CAPTURE_META_SIZE   41
+#define BENCH_MAX_PAYLOAD        512
+
+#define BENCH_DEFAULT_REPEATS    10
+#define BENCH_ROI_CENTRE_SPAD    199	// Default ROI of the driver, 16x16 SPADs in the centre
+#define BENCH_ROI_XY_SIZE        0xFF
+
+typedef enum {
+	// Called by VL53LX_hist_process_data
+	BENCH_STAGE_AVERAGE = 0,
+	BENCH_STAGE_XTALK,
+	BENCH_STAGE_RANGING,
+	// Called by the ranging (VL53LX_f_025)
+	BENCH_STAGE_XTALK_ALIGN,
+	BENCH_STAGE_AMBIENT,
+	BENCH_STAGE_DMAX,
+	BENCH_STAGE_THRESHOLDS,
+	BENCH_STAGE_PULSES,
+	BENCH_STAGE_TARGETS,
+	BENCH_STAGES_COUNT
+}BENCH_STAGE;
+
+#define BENCH_FIRST_RANGING_STAGE BENCH_STAGE_XTALK_ALIGN
+
+typedef struct {
+	uint8_t  m_nSensor;
+	uint32_t m_nSequence;
+	VL53LX_histogram_bin_data_t m_sHistogram;
+}BENCH_FRAME;
+
+static const char *g_arrStageNames[BENCH_STAGES_COUNT] = {
+	"bin averaging (f_031)",
+	"crosstalk rate and removal (f_032, f_033)",
+	"ranging (f_025)",
+	"  crosstalk alignment (f_005)",
+	"  ambient estimate and removal",
+	"  dmax (f_001)",
+	"  thresholds and peaks (f_006 .. f_009)",
+	"  pulse data and sigma (f_010, f_011, f_014, f_015)",
+	"  targets (f_016 .. f_019)",
+};
+
+static BENCH_FRAME *g_arrFrames;
+static uint32_t     g_nFramesCount;
+static uint32_t     g_nFramesAllocated;
+static uint32_t     g_nUnmatchedPhase;
+
+static VL53LX_dmax_calibration_data_t    g_sDmaxCalibration;
+static VL53LX_hist_gen3_dmax_config_t    g_sDmaxConfig;
+static VL53LX_hist_post_process_config_t g_sPostProcessConfig;
+static VL53LX_xtalk_histogram_data_t     g_sXtalkShape;
+static VL53LX_hist_gen3_algo_private_data_t  g_sWorkArea1;
+static VL53LX_hist_gen4_algo_filtered_data_t g_sWorkArea2;
+
+static uint8_t  g_bStageTiming;
+static uint32_t g_arrStageDepth[2];
+static uint64_t g_arrStage_ns[BENCH_STAGES_COUNT];
+
+static void LoadCapture(FILE *pFile);
+static void LoadFrame(const uint8_t *pFrame, uint16_t nPayloadSize);
+static void InitConfig(uint32_t nXtalkPlaneOffset);
+static VL53LX_Error ProcessFrame(const BENCH_FRAME *pFrame, VL53LX_range_results_t *pResults);
+static void WriteResults(FILE *pFile, const BENCH_FRAME *pFrame, VL53LX_Error eStatus, const VL53LX_range_results_t *pResults);
+static uint64_t StageBegin(BENCH_STAGE eStage);
+static void StageEnd(BENCH_STAGE eStage, uint64_t nStart_ns);
+static uint16_t GetU16(const uint8_t *pData);
+static int32_t GetS24(const uint8_t *pData);
+static uint32_t GetU32(const uint8_t *pData);
+static uint16_t Fletcher16(const uint8_t *pData, uint16_t nSize);
+static uint64_t GetTime_ns(void);
+
+/* ======================================================*/
+int main(int argc, char *argv[])
+/* ======================================================*/
+{
+	VL53LX_range_results_t sResults;
+	const char *pCaptureName = NULL;
+	const char *pResultsName = NULL;
+	FILE     *pFile;
+	uint32_t  nRepeats = BENCH_DEFAULT_REPEATS;
+	uint32_t  nXtalkPlaneOffset = 0;
+	uint32_t  nFailed = 0;
+	uint64_t  nTotal_ns = 0, nStagesTotal_ns = 0;
+	uint64_t  nFastestRun_ns = UINT64_MAX;
+	uint64_t  nFrameMax_ns = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-n") && i + 1 < argc)
+		{
+			nRepeats = (uint32_t)strtoul(argv[++i], NULL, 0);
+		}
+		else if (!strcmp(argv[i], "-x") && i + 1 < argc)
+		{
+			nXtalkPlaneOffset = (uint32_t)strtoul(argv[++i], NULL, 0);
+		}
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+		{
+			pResultsName = argv[++i];
+		}
+		else
+		{
+			pCaptureName = argv[i];
+		}
+	}
+
+	if (pCaptureName == NULL || nRepeats < 2)
+	{
+		fprintf(stderr, "Usage: %s [-n repeats (2+)] [-x plane offset] [-o results.csv] <capture file>\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(pCaptureName, "rb");
+
+	if (pFile == NULL)
+	{
+		perror(pCaptureName);
+		return 1;
+	}
+
+	LoadCapture(pFile);
+	fclose(pFile);
+
+	if (g_nFramesCount == 0)
+	{
+		fprintf(stderr, "No histogram frames in %s\n", pCaptureName);
+		return 1;
+	}
+
+	InitConfig(nXtalkPlaneOffset);
+
+	// Warm up run, which also gives the results
+	pFile = (pResultsName != NULL) ? fopen(pResultsName, "w") : NULL;
+
+	if (pResultsName != NULL && pFile == NULL)
+	{
+		perror(pResultsName);
+		return 1;
+	}
+
+	for (uint32_t i = 0; i < g_nFramesCount; i++)
+	{
+		VL53LX_Error eStatus = ProcessFrame(&g_arrFrames[i], &sResults);
+
+		if (eStatus != VL53LX_ERROR_NONE)
+		{
+			nFailed++;
+		}
+
+		if (pFile != NULL)
+		{
+			WriteResults(pFile, &g_arrFrames[i], eStatus, &sResults);
+		}
+	}
+
+	if (pFile != NULL)
+	{
+		fclose(pFile);
+	}
+
+	// Per frame time, without the stage timing
+	for (uint32_t nRun = 1; nRun < nRepeats; nRun++)
+	{
+		uint64_t nRun_ns = 0;
+
+		for (uint32_t i = 0; i < g_nFramesCount; i++)
+		{
+			uint64_t nStart_ns = GetTime_ns();
+			uint64_t nFrame_ns;
+
+			ProcessFrame(&g_arrFrames[i], &sResults);
+
+			nFrame_ns = GetTime_ns() - nStart_ns;
+			nRun_ns  += nFrame_ns;
+
+			if (nFrame_ns > nFrameMax_ns)
+			{
+				nFrameMax_ns = nFrame_ns;
+			}
+		}
+
+		nTotal_ns += nRun_ns;
+
+		if (nRun_ns < nFastestRun_ns)
+		{
+			nFastestRun_ns = nRun_ns;
+		}
+	}
+
+	// Time per stage
+	g_bStageTiming = 1;
+
+	for (uint32_t nRun = 1; nRun < nRepeats; nRun++)
+	{
+		uint64_t nStart_ns = GetTime_ns();
+
+		for (uint32_t i = 0; i < g_nFramesCount; i++)
+		{
+			ProcessFrame(&g_arrFrames[i], &sResults);
+		}
+
+		nStagesTotal_ns += GetTime_ns() - nStart_ns;
+	}
+
+	g_bStageTiming = 0;
+
+	printf("%u frames, %u runs, %u failed, %u with unmatched zero distance phase\n",
+			g_nFramesCount, nRepeats - 1, nFailed, g_nUnmatchedPhase);
+	printf("Crosstalk compensation: %s\n", nXtalkPlaneOffset ? "on" : "off");
+	printf("Per frame: %.0f ns average, %.0f ns best run average, %llu ns max\n",
+			(double)nTotal_ns / ((uint64_t)g_nFramesCount * (nRepeats - 1)),
+			(double)nFastestRun_ns / g_nFramesCount, (unsigned long long)nFrameMax_ns);
+	printf("Per stage (ns per frame, %% of the frame with the stage timing on):\n");
+
+	for (uint8_t i = 0; i < BENCH_STAGES_COUNT; i++)
+	{
+		double nStage_ns = (double)g_arrStage_ns[i] / ((uint64_t)g_nFramesCount * (nRepeats - 1));
+
+		printf("  %-52s %10.0f %6.1f%%\n", g_arrStageNames[i], nStage_ns, 100.0 * g_arrStage_ns[i] / nStagesTotal_ns);
+	}
+
+	{
+		uint64_t nRest_ns = g_arrStage_ns[BENCH_STAGE_RANGING];
+
+		for (uint8_t i = BENCH_FIRST_RANGING_STAGE; i < BENCH_STAGES_COUNT; i++)
+		{
+			nRest_ns -= (g_arrStage_ns[i] < nRest_ns) ? g_arrStage_ns[i] : nRest_ns;
+		}
+
+		printf("  %-52s %10.0f %6.1f%%\n", "  gen4 filtering (f_026, f_027) and the rest",
+				(double)nRest_ns / ((uint64_t)g_nFramesCount * (nRepeats - 1)), 100.0 * nRest_ns / nStagesTotal_ns);
+	}
+
+	return 0;
+}
+
+// @brief Read all valid frames of the capture. Console text and corrupted frames are skipped.
+/* ======================================================*/
+static void LoadCapture(FILE *pFile)
+/* ======================================================*/
+{
+	static uint8_t arrData[HIST_CAPTURE_HEADER_SIZE + BENCH_MAX_PAYLOAD + 2];
+	int nByte;
+
+	while ((nByte = fgetc(pFile)) != EOF)
+	{
+		uint16_t nPayloadSize;
+		long     nResume;
+
+		if (nByte != HIST_CAPTURE_SYNC_0)
+		{
+			continue;
+		}
+
+		nResume    = ftell(pFile);
+		arrData[0] = (uint8_t)nByte;
+
+		if (fread(arrData + 1, 1, HIST_CAPTURE_HEADER_SIZE - 1, pFile) != HIST_CAPTURE_HEADER_SIZE - 1)
+		{
+			break;
+		}
+
+		nPayloadSize = GetU16(arrData + 4);
+
+		if (arrData[1] != HIST_CAPTURE_SYNC_1 || arrData[2] != HIST_CAPTURE_VERSION || nPayloadSize > BENCH_MAX_PAYLOAD ||
+			fread(arrData + HIST_CAPTURE_HEADER_SIZE, 1, nPayloadSize + 2, pFile) != (size_t)nPayloadSize + 2 ||
+			Fletcher16(arrData, HIST_CAPTURE_HEADER_SIZE + nPayloadSize) != GetU16(arrData + HIST_CAPTURE_HEADER_SIZE + nPayloadSize))
+		{
+			fseek(pFile, nResume, SEEK_SET);
+			continue;
+		}
+
+		LoadFrame(arrData, nPayloadSize);
+	}
+}
+
+/* @brief Rebuild the histogram as VL53LX_get_histogram_bin_data leaves it.
+ *        The VCSEL start of the calibration isn't captured, it is the one
+ *        which gives the captured zero distance phase.
+ */
+/* ======================================================*/
+static void LoadFrame(const uint8_t *pFrame, uint16_t nPayloadSize)
+/* ======================================================*/
+{
+	const uint8_t *pData = pFrame + HIST_CAPTURE_HEADER_SIZE;
+	VL53LX_histogram_bin_data_t *pHistogram;
+	uint16_t nZeroDistancePhase;
+	uint8_t  nBins = pData[3];
+
+	if (nBins > VL53LX_HISTOGRAM_BUFFER_SIZE || nPayloadSize < HIST_CAPTURE_META_SIZE + nBins * 3)
+	{
+		return;
+	}
+
+	if (g_nFramesCount == g_nFramesAllocated)
+	{
+		g_nFramesAllocated = g_nFramesAllocated ? g_nFramesAllocated * 2 : 1024;
+		g_arrFrames        = realloc(g_arrFrames, g_nFramesAllocated * sizeof(BENCH_FRAME));
+
+		if (g_arrFrames == NULL)
+		{
+			fprintf(stderr, "Out of memory\n");
+			exit(1);
+		}
+	}
+
+	g_arrFrames[g_nFramesCount].m_nSensor   = pFrame[3];
+	g_arrFrames[g_nFramesCount].m_nSequence = GetU32(pFrame + 8);
+	pHistogram = &g_arrFrames[g_nFramesCount].m_sHistogram;
+	g_nFramesCount++;
+
+	memset(pHistogram, 0, sizeof(*pHistogram));
+	pHistogram->time_stamp                   = GetU32(pFrame + 12);
+	pHistogram->result__stream_count         = pData[0];
+	pHistogram->result__range_status         = pData[1];
+	pHistogram->VL53LX_p_019                 = pData[2];
+	pHistogram->VL53LX_p_020                 = VL53LX_HISTOGRAM_BUFFER_SIZE;
+	pHistogram->VL53LX_p_021                 = nBins;
+	pHistogram->number_of_ambient_bins       = pData[4];
+	pHistogram->VL53LX_p_005                 = pData[5];
+	pHistogram->phasecal_result__vcsel_start = pData[6];
+	pData += 7;
+
+	for (uint8_t i = 0; i < VL53LX_MAX_BIN_SEQUENCE_LENGTH; i++)
+	{
+		pHistogram->bin_seq[i] = pData[i];
+		pHistogram->bin_rep[i] = pData[VL53LX_MAX_BIN_SEQUENCE_LENGTH + i];
+	}
+
+	pData += 2 * VL53LX_MAX_BIN_SEQUENCE_LENGTH;
+
+	pHistogram->vcsel_width                        = GetU16(pData);
+	pHistogram->VL53LX_p_015                       = GetU16(pData + 2);
+	nZeroDistancePhase                             = GetU16(pData + 4);
+	pHistogram->phasecal_result__reference_phase   = GetU16(pData + 6);
+	pHistogram->result__dss_actual_effective_spads = GetU16(pData + 8);
+	pHistogram->total_periods_elapsed              = GetU32(pData + 10);
+	pHistogram->peak_duration_us                   = GetU32(pData + 14);
+	pHistogram->woi_duration_us                    = GetU32(pData + 18);
+	pData += 22;
+
+	for (uint8_t i = 0; i < nBins; i++)
+	{
+		pHistogram->bin_data[i] = GetS24(pData + i * 3);
+	}
+
+	pHistogram->roi_config__user_roi_centre_spad              = BENCH_ROI_CENTRE_SPAD;
+	pHistogram->roi_config__user_roi_requested_global_xy_size = BENCH_ROI_XY_SIZE;
+
+	for (uint16_t nVcselStart = 0; nVcselStart <= UINT8_MAX; nVcselStart++)
+	{
+		pHistogram->cal_config__vcsel_start = (uint8_t)nVcselStart;
+		VL53LX_hist_calc_zero_distance_phase(pHistogram);
+
+		if (pHistogram->zero_distance_phase == nZeroDistancePhase)
+		{
+			break;
+		}
+	}
+
+	if (pHistogram->zero_distance_phase != nZeroDistancePhase)
+	{
+		pHistogram->cal_config__vcsel_start = 0;
+		pHistogram->zero_distance_phase     = nZeroDistancePhase;
+		g_nUnmatchedPhase++;
+	}
+
+	VL53LX_hist_estimate_ambient_from_ambient_bins(pHistogram);
+}
+
+/* @brief The configuration VL53LX_DataInit loads and VL53LX_get_device_results
+ *        completes for every frame, without the calibration of the sensor.
+ */
+/* ======================================================*/
+static void InitConfig(uint32_t nXtalkPlaneOffset)
+/* ======================================================*/
+{
+	VL53LX_init_dmax_calibration_data_struct(&g_sDmaxCalibration);
+	VL53LX_init_hist_gen3_dmax_config_struct(&g_sDmaxConfig);
+	VL53LX_init_hist_post_process_config_struct(nXtalkPlaneOffset != 0, &g_sPostProcessConfig);
+
+	g_sPostProcessConfig.algo__crosstalk_compensation_plane_offset_kcps = nXtalkPlaneOffset;
+
+	g_sDmaxConfig.ambient_thresh_sigma      = g_sPostProcessConfig.ambient_thresh_sigma1;
+	g_sDmaxConfig.min_ambient_thresh_events = g_sPostProcessConfig.min_ambient_thresh_events;
+	g_sDmaxConfig.signal_total_events_limit = g_sPostProcessConfig.signal_total_events_limit;
+
+	// Flat crosstalk shape, the bins of a shape sum up to 1024
+	memset(&g_sXtalkShape, 0, sizeof(g_sXtalkShape));
+	g_sXtalkShape.xtalk_shape.VL53LX_p_020 = VL53LX_XTALK_HISTO_BINS;
+	g_sXtalkShape.xtalk_shape.VL53LX_p_021 = VL53LX_XTALK_HISTO_BINS;
+
+	for (uint8_t i = 0; i < VL53LX_XTALK_HISTO_BINS; i++)
+	{
+		g_sXtalkShape.xtalk_shape.bin_data[i] = 1024 / VL53LX_XTALK_HISTO_BINS;
+	}
+}
+
+// @brief The histogram is copied as VL53LX_hist_process_data may change its input
+/* ======================================================*/
+static VL53LX_Error ProcessFrame(const BENCH_FRAME *pFrame, VL53LX_range_results_t *pResults)
+/* ======================================================*/
+{
+	VL53LX_histogram_bin_data_t sHistogram = pFrame->m_sHistogram;
+	uint8_t nHistogramsMerged = 1;
+
+	return VL53LX_hist_process_data(&g_sDmaxCalibration, &g_sDmaxConfig, &g_sPostProcessConfig, &sHistogram, &g_sXtalkShape,
+			(uint8_t *)&g_sWorkArea1, (uint8_t *)&g_sWorkArea2, pResults, &nHistogramsMerged);
+}
+
+/* ======================================================*/
+static void WriteResults(FILE *pFile, const BENCH_FRAME *pFrame, VL53LX_Error eStatus, const VL53LX_range_results_t *pResults)
+/* ======================================================*/
+{
+	uint8_t nTargets = (pResults->active_results < VL53LX_MAX_RANGE_RESULTS) ? pResults->active_results : VL53LX_MAX_RANGE_RESULTS;
+
+	fprintf(pFile, "%u,%u,%d,%u", pFrame->m_nSensor, pFrame->m_nSequence, eStatus, nTargets);
+
+	for (uint8_t i = 0; i < nTargets; i++)
+	{
+		const VL53LX_range_data_t *pTarget = &pResults->VL53LX_p_003[i];
+
+		fprintf(pFile, ",%d,%u,%u,%u,%u", pTarget->median_range_mm, pTarget->range_status, pTarget->VL53LX_p_002,
+				pTarget->peak_signal_count_rate_mcps, pTarget->ambient_count_rate_mcps);
+	}
+
+	fprintf(pFile, "\n");
+}
+
+/* Stage timing ---------------------------------------------------------------*/
+
+/* @brief Stages of the same level may call each other (e.g. the ambient
+ *        estimate is used by the dmax), only the outermost call is timed.
+ */
+/* ======================================================*/
+static uint64_t StageBegin(BENCH_STAGE eStage)
+/* ======================================================*/
+{
+	uint8_t nLevel = (eStage >= BENCH_FIRST_RANGING_STAGE);
+
+	if (!g_bStageTiming || g_arrStageDepth[nLevel]++)
+	{
+		return 0;
+	}
+
+	return GetTime_ns();
+}
+
+/* ======================================================*/
+static void StageEnd(BENCH_STAGE eStage, uint64_t nStart_ns)
+/* ======================================================*/
+{
+	uint8_t nLevel = (eStage >= BENCH_FIRST_RANGING_STAGE);
+
+	if (!g_bStageTiming || --g_arrStageDepth[nLevel])
+	{
+		return;
+	}
+
+	g_arrStage_ns[eStage] += GetTime_ns() - nStart_ns;
+}
+
+/* The linker sends the calls to VL53LX_xxx to __wrap_VL53LX_xxx, which calls
+ * the driver function as __real_VL53LX_xxx.
+ */
+#define BENCH_WRAP(eStage, ReturnType, Name, Parameters, Arguments) \
+	ReturnType __real_##Name Parameters; \
+	ReturnType __wrap_##Name Parameters; \
+	ReturnType __wrap_##Name Parameters \
+	{ \
+		uint64_t nStart_ns = StageBegin(eStage); \
+		ReturnType eResult = __real_##Name Arguments; \
+		StageEnd(eStage, nStart_ns); \
+		return eResult; \
+	}
+
+#define BENCH_WRAP_VOID(eStage, Name, Parameters, Arguments) \
+	void __real_##Name Parameters; \
+	void __wrap_##Name Parameters; \
+	void __wrap_##Name Parameters \
+	{ \
+		uint64_t nStart_ns = StageBegin(eStage); \
+		__real_##Name Arguments; \
+		StageEnd(eStage, nStart_ns); \
+	}
+
+BENCH_WRAP(BENCH_STAGE_AVERAGE, VL53LX_Error, VL53LX_f_031,
+		(VL53LX_histogram_bin_data_t *pidata, VL53LX_histogram_bin_data_t *podata),
+		(pidata, podata))
+
+BENCH_WRAP(BENCH_STAGE_XTALK, VL53LX_Error, VL53LX_f_032,
+		(uint32_t mean_offset, int16_t xgradient, int16_t ygradient, int8_t centre_offset_x, int8_t centre_offset_y,
+		 uint16_t roi_effective_spads, uint8_t roi_centre_spad, uint8_t roi_xy_size, uint32_t *xtalk_rate_kcps),
+		(mean_offset, xgradient, ygradient, centre_offset_x, centre_offset_y, roi_effective_spads, roi_centre_spad,
+		 roi_xy_size, xtalk_rate_kcps))
+
+BENCH_WRAP(BENCH_STAGE_XTALK, VL53LX_Error, VL53LX_f_033,
+		(VL53LX_histogram_bin_data_t *phist_data, VL53LX_xtalk_histogram_shape_t *pxtalk_data, uint32_t xtalk_rate_kcps,
+		 VL53LX_histogram_bin_data_t *pxtalkcount_data),
+		(phist_data, pxtalk_data, xtalk_rate_kcps, pxtalkcount_data))
+
+BENCH_WRAP(BENCH_STAGE_RANGING, VL53LX_Error, VL53LX_f_025,
+		(VL53LX_dmax_calibration_data_t *pdmax_cal, VL53LX_hist_gen3_dmax_config_t *pdmax_cfg,
+		 VL53LX_hist_post_process_config_t *ppost_cfg, VL53LX_histogram_bin_data_t *pbins,
+		 VL53LX_histogram_bin_data_t *pxtalk, VL53LX_hist_gen3_algo_private_data_t *palgo,
+		 VL53LX_hist_gen4_algo_filtered_data_t *pfiltered, VL53LX_hist_gen3_dmax_private_data_t *pdmax_algo,
+		 VL53LX_range_results_t *presults),
+		(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered, pdmax_algo, presults))
+
+BENCH_WRAP_VOID(BENCH_STAGE_XTALK_ALIGN, VL53LX_f_005,
+		(VL53LX_histogram_bin_data_t *pxtalk, VL53LX_histogram_bin_data_t *pbins, VL53LX_histogram_bin_data_t *pxtalk_realigned),
+		(pxtalk, pbins, pxtalk_realigned))
+
+BENCH_WRAP_VOID(BENCH_STAGE_AMBIENT, VL53LX_hist_calc_zero_distance_phase,
+		(VL53LX_histogram_bin_data_t *pdata),
+		(pdata))
+
+BENCH_WRAP_VOID(BENCH_STAGE_AMBIENT, VL53LX_hist_estimate_ambient_from_ambient_bins,
+		(VL53LX_histogram_bin_data_t *pdata),
+		(pdata))
+
+BENCH_WRAP_VOID(BENCH_STAGE_AMBIENT, VL53LX_hist_estimate_ambient_from_thresholded_bins,
+		(int32_t ambient_threshold_sigma, VL53LX_histogram_bin_data_t *pdata),
+		(ambient_threshold_sigma, pdata))
+
+BENCH_WRAP_VOID(BENCH_STAGE_AMBIENT, VL53LX_hist_remove_ambient_bins,
+		(VL53LX_histogram_bin_data_t *pdata),
+		(pdata))
+
+BENCH_WRAP(BENCH_STAGE_DMAX, VL53LX_Error, VL53LX_f_001,
+		(uint16_t target_reflectance, VL53LX_dmax_calibration_data_t *pcal, VL53LX_hist_gen3_dmax_config_t *pcfg,
+		 VL53LX_histogram_bin_data_t *pbins, VL53LX_hist_gen3_dmax_private_data_t *pdata, int16_t *pambient_dmax_mm),
+		(target_reflectance, pcal, pcfg, pbins, pdata, pambient_dmax_mm))
+
+BENCH_WRAP(BENCH_STAGE_THRESHOLDS, VL53LX_Error, VL53LX_f_006,
+		(uint16_t ambient_threshold_events_scaler, int32_t ambient_threshold_sigma, int32_t min_ambient_threshold_events,
+		 uint8_t algo__crosstalk_compensation_enable, VL53LX_histogram_bin_data_t *pbins,
+		 VL53LX_histogram_bin_data_t *pxtalk, VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(ambient_threshold_events_scaler, ambient_threshold_sigma, min_ambient_threshold_events,
+		 algo__crosstalk_compensation_enable, pbins, pxtalk, palgo))
+
+BENCH_WRAP(BENCH_STAGE_THRESHOLDS, VL53LX_Error, VL53LX_f_007,
+		(VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(palgo))
+
+BENCH_WRAP(BENCH_STAGE_THRESHOLDS, VL53LX_Error, VL53LX_f_008,
+		(VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(palgo))
+
+BENCH_WRAP(BENCH_STAGE_THRESHOLDS, VL53LX_Error, VL53LX_f_009,
+		(VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(palgo))
+
+BENCH_WRAP(BENCH_STAGE_PULSES, VL53LX_Error, VL53LX_f_010,
+		(uint8_t pulse_no, VL53LX_histogram_bin_data_t *pbins, VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(pulse_no, pbins, palgo))
+
+BENCH_WRAP(BENCH_STAGE_PULSES, VL53LX_Error, VL53LX_f_011,
+		(uint8_t pulse_no, VL53LX_histogram_bin_data_t *pbins, VL53LX_hist_gen3_algo_private_data_t *palgo,
+		 int32_t pad_value, VL53LX_histogram_bin_data_t *ppulse),
+		(pulse_no, pbins, palgo, pad_value, ppulse))
+
+BENCH_WRAP(BENCH_STAGE_PULSES, VL53LX_Error, VL53LX_f_014,
+		(uint8_t bin, uint8_t sigma_estimator__sigma_ref_mm, uint8_t VL53LX_p_030, uint8_t VL53LX_p_051,
+		 uint8_t crosstalk_compensation_enable, VL53LX_histogram_bin_data_t *phist_data_ap,
+		 VL53LX_histogram_bin_data_t *phist_data_zp, VL53LX_histogram_bin_data_t *pxtalk_hist, uint16_t *psigma_est),
+		(bin, sigma_estimator__sigma_ref_mm, VL53LX_p_030, VL53LX_p_051, crosstalk_compensation_enable,
+		 phist_data_ap, phist_data_zp, pxtalk_hist, psigma_est))
+
+BENCH_WRAP(BENCH_STAGE_PULSES, VL53LX_Error, VL53LX_f_015,
+		(uint8_t pulse_no, uint8_t clip_events, VL53LX_histogram_bin_data_t *pbins, VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(pulse_no, clip_events, pbins, palgo))
+
+BENCH_WRAP(BENCH_STAGE_TARGETS, VL53LX_Error, VL53LX_f_016,
+		(VL53LX_HistTargetOrder target_order, VL53LX_hist_gen3_algo_private_data_t *palgo),
+		(target_order, palgo))
+
+BENCH_WRAP_VOID(BENCH_STAGE_TARGETS, VL53LX_f_017,
+		(uint8_t range_id, uint8_t valid_phase_low, uint8_t valid_phase_high, uint16_t sigma_thres,
+		 VL53LX_histogram_bin_data_t *pbins, VL53LX_hist_pulse_data_t *ppulse, VL53LX_range_data_t *pdata),
+		(range_id, valid_phase_low, valid_phase_high, sigma_thres, pbins, ppulse, pdata))
+
+BENCH_WRAP(BENCH_STAGE_TARGETS, VL53LX_Error, VL53LX_f_018,
+		(uint16_t vcsel_width, uint16_t fast_osc_frequency, uint32_t total_periods_elapsed, uint16_t VL53LX_p_004,
+		 VL53LX_range_data_t *pdata),
+		(vcsel_width, fast_osc_frequency, total_periods_elapsed, VL53LX_p_004, pdata))
+
+BENCH_WRAP_VOID(BENCH_STAGE_TARGETS, VL53LX_f_019,
+		(uint16_t gain_factor, int16_t range_offset_mm, VL53LX_range_data_t *pdata),
+		(gain_factor, range_offset_mm, pdata))
+
+/* Helpers ---------------------------------------------------------------------*/
+
+/* ======================================================*/
+static uint16_t GetU16(const uint8_t *pData)
+/* ======================================================*/
+{
+	return (uint16_t)(pData[0] | (pData[1] << 8));
+}
+
+/* ======================================================*/
+static int32_t GetS24(const uint8_t *pData)
+/* ======================================================*/
+{
+	uint32_t nValue = pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16);
+
+	return (int32_t)(nValue ^ 0x800000) - 0x800000;
+}
+
+/* ======================================================*/
+static uint32_t GetU32(const uint8_t *pData)
+/* ======================================================*/
+{
+	return GetU16(pData) | ((uint32_t)GetU16(pData + 2) << 16);
+}
+
+/* ======================================================*/
+static uint16_t Fletcher16(const uint8_t *pData, uint16_t nSize)
+/* ======================================================*/
+{
+	uint16_t nSum1 = 0;
+	uint16_t nSum2 = 0;
+
+	for (uint16_t i = 0; i < nSize; i++)
+	{
+		nSum1 = (nSum1 + pData[i]) % 255;
+		nSum2 = (nSum2 + nSum1) % 255;
+	}
+
+	return (nSum2 << 8) | nSum1;
+}
+
+/* ======================================================*/
+static uint64_t GetTime_ns(void)
+/* ======================================================*/
+{
+	struct timespec sTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+	return (uint64_t)sTime.tv_sec * 1000000000u + sTime.tv_nsec;
+}
@@ -0,0 +1,265 @@
+/*
+ *  @file:   kernel_check.c
+ *  @Author: Denislav Trifonov
+ *  @Date:   17.10.2026
+ *  @brief: Host check of the histogram kernels (vl53lx_hist_kernels.c). The fast
+ *          version of each kernel must give bit-exact the results of its
+ *          reference on random histograms and on the edge cases (empty
+ *          ranges, windows as wide as the histogram, bin index wrapping).
+ *
+ *  Build and run (from this directory):
+ *      make check
+ *  It runs twice, with the portable C kernels and with the DSP kernels on
+ *  emulated M33 instructions (stub/cmsis_compiler.h).
+ *
+ *  Usage:
+ *      kernel_check [cases per kernel] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vl53lx_hist_structs.h"
+#include "vl53lx_hist_kernels.h"
+
+#define CHECK_BINS          VL53LX_HISTOGRAM_BUFFER_SIZE
+#define CHECK_DEFAULT_CASES 1000000
+#define CHECK_BIN_MAX       (1 << 24)	// The sensor reports 24-bit bins
+#define CHECK_FILL          0x5A5A5A5A	// Shows writes out of the range of a kernel
+
+static uint32_t g_nRandomState;
+static uint32_t g_nFailures;
+
+static void CheckSumBins(uint32_t nCase);
+static void CheckShiftBins(uint32_t nCase);
+static void CheckSubtractBins(uint32_t nCase);
+static void CheckWindowFilter(uint32_t nCase);
+static void CheckDifferenceFilter(uint32_t nCase);
+static void FillBins(int32_t *pBins, int32_t nMin, int32_t nMax);
+static void Fail(const char *pKernel, uint32_t nCase, const char *pDetails);
+static uint32_t Random(void);
+static int32_t RandomRange(int32_t nMin, int32_t nMax);
+
+/* ======================================================*/
+int main(int argc, char *argv[])
+/* ======================================================*/
+{
+	uint32_t nCases = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : CHECK_DEFAULT_CASES;
+
+	g_nRandomState = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1;
+
+	if (g_nRandomState == 0)
+	{
+		g_nRandomState = 1;
+	}
+
+	for (uint32_t i = 0; i < nCases; i++)
+	{
+		CheckSumBins(i);
+		CheckShiftBins(i);
+		CheckSubtractBins(i);
+		CheckWindowFilter(i);
+		CheckDifferenceFilter(i);
+	}
+
+#ifdef VL53LX_HIST_KERNELS_EMULATE_DSP
+	printf("DSP kernels: ");
+#else
+	printf("C kernels: ");
+#endif
+	printf("%u cases per kernel, %u failures\n", nCases, g_nFailures);
+
+	return g_nFailures ? 1 : 0;
+}
+
+/* ======================================================*/
+static void CheckSumBins(uint32_t nCase)
+/* ======================================================*/
+{
+	int32_t arrBins[CHECK_BINS];
+	uint8_t nCount = (uint8_t)RandomRange(0, CHECK_BINS);
+
+	FillBins(arrBins, -CHECK_BIN_MAX, CHECK_BIN_MAX);
+
+	if (VL53LX_hist_sum_bins_ref(arrBins, nCount) != VL53LX_hist_sum_bins_fast(arrBins, nCount))
+	{
+		Fail("sum_bins", nCase, "sum");
+	}
+}
+
+/* ======================================================*/
+static void CheckShiftBins(uint32_t nCase)
+/* ======================================================*/
+{
+	int32_t arrRef[CHECK_BINS], arrFast[CHECK_BINS];
+	uint8_t nShift = (uint8_t)RandomRange(0, CHECK_BINS);
+	uint8_t nEnd   = (uint8_t)RandomRange(0, CHECK_BINS);
+
+	FillBins(arrRef, 0, CHECK_BIN_MAX);
+	memcpy(arrFast, arrRef, sizeof(arrRef));
+
+	VL53LX_hist_shift_bins_ref(arrRef, nShift, nEnd);
+	VL53LX_hist_shift_bins_fast(arrFast, nShift, nEnd);
+
+	if (memcmp(arrRef, arrFast, sizeof(arrRef)))
+	{
+		Fail("shift_bins", nCase, "bins");
+	}
+}
+
+/* ======================================================*/
+static void CheckSubtractBins(uint32_t nCase)
+/* ======================================================*/
+{
+	int32_t arrRef[CHECK_BINS], arrFast[CHECK_BINS], arrSub[CHECK_BINS];
+	int32_t arrCopyRef[CHECK_BINS], arrCopyFast[CHECK_BINS];
+	uint8_t nCount = (uint8_t)RandomRange(0, CHECK_BINS);
+
+	// Every other case near the limit where the difference still fits int32
+	if (nCase & 1)
+	{
+		FillBins(arrRef, -(1 << 30), (1 << 30) - 1);
+		FillBins(arrSub, -(1 << 30), (1 << 30) - 1);
+	}
+	else
+	{
+		FillBins(arrRef, 0, CHECK_BIN_MAX);
+		FillBins(arrSub, 0, CHECK_BIN_MAX / 16);
+	}
+
+	memcpy(arrFast, arrRef, sizeof(arrRef));
+
+	for (uint8_t i = 0; i < CHECK_BINS; i++)
+	{
+		arrCopyRef[i]  = CHECK_FILL;
+		arrCopyFast[i] = CHECK_FILL;
+	}
+
+	VL53LX_hist_subtract_bins_ref(arrRef, arrSub, arrCopyRef, nCount);
+	VL53LX_hist_subtract_bins_fast(arrFast, arrSub, arrCopyFast, nCount);
+
+	if (memcmp(arrRef, arrFast, sizeof(arrRef)))
+	{
+		Fail("subtract_bins", nCase, "bins");
+	}
+
+	if (memcmp(arrCopyRef, arrCopyFast, sizeof(arrCopyRef)))
+	{
+		Fail("subtract_bins", nCase, "copy");
+	}
+}
+
+// @brief Pulses as VL53LX_f_026 gets them - the bin index may wrap at the VCSEL period
+/* ======================================================*/
+static void CheckWindowFilter(uint32_t nCase)
+/* ======================================================*/
+{
+	int32_t arrBins[CHECK_BINS];
+	int32_t arrRef[5][CHECK_BINS], arrFast[5][CHECK_BINS];
+	uint8_t nBins   = (uint8_t)RandomRange(1, CHECK_BINS);
+	uint8_t nWoi    = (uint8_t)RandomRange(0, (nCase % 8) ? nBins / 2 : nBins);
+	uint8_t nPeriod = (uint8_t)RandomRange(1, CHECK_BINS);
+	uint8_t nFirst  = (uint8_t)RandomRange(0, 2 * CHECK_BINS);
+	uint8_t nLast   = (uint8_t)RandomRange((nCase % 16) ? nFirst : 0, nFirst + CHECK_BINS);
+	int32_t nAmbient = RandomRange(0, CHECK_BIN_MAX);
+
+	FillBins(arrBins, 0, CHECK_BIN_MAX);
+
+	for (uint8_t i = 0; i < 5; i++)
+	{
+		for (uint8_t j = 0; j < CHECK_BINS; j++)
+		{
+			arrRef[i][j]  = CHECK_FILL;
+			arrFast[i][j] = CHECK_FILL;
+		}
+	}
+
+	VL53LX_hist_window_filter_ref(arrBins, nBins, nWoi, nFirst, nLast, nPeriod, nAmbient,
+			arrRef[0], arrRef[1], arrRef[2], arrRef[3], arrRef[4]);
+	VL53LX_hist_window_filter_fast(arrBins, nBins, nWoi, nFirst, nLast, nPeriod, nAmbient,
+			arrFast[0], arrFast[1], arrFast[2], arrFast[3], arrFast[4]);
+
+	if (memcmp(arrRef, arrFast, sizeof(arrRef)))
+	{
+		char arrDetails[96];
+
+		snprintf(arrDetails, sizeof(arrDetails), "bins %u, woi %u, period %u, lb %u..%u", nBins, nWoi, nPeriod, nFirst, nLast);
+		Fail("window_filter", nCase, arrDetails);
+	}
+}
+
+// @brief Pulses as VL53LX_f_012 gets them - the windows wrap at the VCSEL period, which may be shorter or longer than the histogram
+/* ======================================================*/
+static void CheckDifferenceFilter(uint32_t nCase)
+/* ======================================================*/
+{
+	int32_t arrBins[CHECK_BINS];
+	int32_t arrRef[2][CHECK_BINS], arrFast[2][CHECK_BINS];
+	uint8_t nBins   = (uint8_t)RandomRange(1, CHECK_BINS);
+	uint8_t nPeriod = (uint8_t)RandomRange(1, CHECK_BINS);
+	uint8_t nWoi    = (uint8_t)RandomRange(0, (nCase % 8) ? nPeriod / 2 : nPeriod);
+	uint8_t nFirst  = (uint8_t)RandomRange(0, 2 * CHECK_BINS);
+	uint8_t nLast   = (uint8_t)RandomRange((nCase % 16) ? nFirst : 0, nFirst + CHECK_BINS);
+
+	FillBins(arrBins, 0, CHECK_BIN_MAX);
+
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		for (uint8_t j = 0; j < CHECK_BINS; j++)
+		{
+			arrRef[i][j]  = CHECK_FILL;
+			arrFast[i][j] = CHECK_FILL;
+		}
+	}
+
+	VL53LX_hist_difference_filter_ref(arrBins, nBins, nWoi, nFirst, nLast, nPeriod, arrRef[0], arrRef[1]);
+	VL53LX_hist_difference_filter_fast(arrBins, nBins, nWoi, nFirst, nLast, nPeriod, arrFast[0], arrFast[1]);
+
+	if (memcmp(arrRef, arrFast, sizeof(arrRef)))
+	{
+		char arrDetails[96];
+
+		snprintf(arrDetails, sizeof(arrDetails), "bins %u, woi %u, period %u, lb %u..%u", nBins, nWoi, nPeriod, nFirst, nLast);
+		Fail("difference_filter", nCase, arrDetails);
+	}
+}
+
+/* ======================================================*/
+static void FillBins(int32_t *pBins, int32_t nMin, int32_t nMax)
+/* ======================================================*/
+{
+	for (uint8_t i = 0; i < CHECK_BINS; i++)
+	{
+		pBins[i] = RandomRange(nMin, nMax);
+	}
+}
+
+// @brief Only the first failures are printed
+/* ======================================================*/
+static void Fail(const char *pKernel, uint32_t nCase, const char *pDetails)
+/* ======================================================*/
+{
+	if (g_nFailures++ < 10)
+	{
+		printf("%s: case %u differs (%s)\n", pKernel, nCase, pDetails);
+	}
+}
+
+// @brief xorshift32, the same sequence on every host
+/* ======================================================*/
+static uint32_t Random(void)
+/* ======================================================*/
+{
+	g_nRandomState ^= g_nRandomState << 13;
+	g_nRandomState ^= g_nRandomState >> 17;
+	g_nRandomState ^= g_nRandomState << 5;
+
+	return g_nRandomState;
+}
+
+/* ======================================================*/
+static int32_t RandomRange(int32_t nMin, int32_t nMax)
+/* ======================================================*/
+{
+	return nMin + (int32_t)(Random() % ((uint32_t)(nMax - nMin) + 1));
+}
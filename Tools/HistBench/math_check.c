@@ -0,0 +1,178 @@
+/*
+ *  @file:   math_check.c
+ *  @Author: Denislav Trifonov
+ *  @Date:   17.10.2026
+ *  @brief: Host check of the fixed-point primitives (vl53lx_hist_math.c). The
+ *          fast version of each primitive must give bit-exact the results of
+ *          its reference: the square root on every number up to 2^20 and
+ *          around every perfect square, the division on the edge cases of
+ *          the long division (digit corrections, divisor normalisation), and
+ *          both on random numbers of random bit lengths.
+ *
+ *  Build and run (from this directory):
+ *      make check
+ *
+ *  Usage:
+ *      math_check [random cases] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "vl53lx_hist_math.h"
+
+#define CHECK_DEFAULT_CASES 10000000
+#define CHECK_SQRT_ALL      (1u << 20)	// Every number below is checked
+
+static uint32_t g_nRandomState;
+static uint32_t g_nFailures;
+static uint32_t g_nChecks;
+
+static void CheckIsqrt(uint32_t nNum);
+static void CheckDiv(uint64_t nDividend, uint32_t nDivisor);
+static void CheckDivEdges(void);
+static uint32_t Random(void);
+static uint64_t RandomBits(uint32_t nMaxBits);
+
+/* ======================================================*/
+int main(int argc, char *argv[])
+/* ======================================================*/
+{
+	uint32_t nCases = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : CHECK_DEFAULT_CASES;
+
+	g_nRandomState = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1;
+
+	if (g_nRandomState == 0)
+	{
+		g_nRandomState = 1;
+	}
+
+	for (uint32_t i = 0; i < CHECK_SQRT_ALL; i++)
+	{
+		CheckIsqrt(i);
+	}
+
+	// The Newton steps end or miss at the perfect squares
+	for (uint32_t i = 1; i <= 0xFFFF; i++)
+	{
+		CheckIsqrt(i * i - 1);
+		CheckIsqrt(i * i);
+		CheckIsqrt(i * i + 1);
+		CheckIsqrt(i * i + 2 * i);
+	}
+
+	CheckIsqrt(0xFFFFFFFF);
+	CheckDivEdges();
+
+	for (uint32_t i = 0; i < nCases; i++)
+	{
+		uint32_t nDivisor = (uint32_t)RandomBits(32);
+
+		CheckIsqrt((uint32_t)RandomBits(32));
+		CheckDiv(RandomBits(64), nDivisor ? nDivisor : 1);
+	}
+
+	printf("Math: %u checks, %u failures\n", g_nChecks, g_nFailures);
+
+	return g_nFailures ? 1 : 0;
+}
+
+// @brief Only the first failures are printed
+/* ======================================================*/
+static void CheckIsqrt(uint32_t nNum)
+/* ======================================================*/
+{
+	uint32_t nRef  = VL53LX_hist_isqrt_ref(nNum);
+	uint32_t nFast = VL53LX_hist_isqrt_fast(nNum);
+
+	g_nChecks++;
+
+	if ((nRef != nFast) && (g_nFailures++ < 10))
+	{
+		printf("isqrt(%u): %u, reference %u\n", nNum, nFast, nRef);
+	}
+}
+
+/* ======================================================*/
+static void CheckDiv(uint64_t nDividend, uint32_t nDivisor)
+/* ======================================================*/
+{
+	uint64_t nRef  = VL53LX_hist_div_u64_ref(nDividend, nDivisor);
+	uint64_t nFast = VL53LX_hist_div_u64_fast(nDividend, nDivisor);
+
+	g_nChecks++;
+
+	if ((nRef != nFast) && (g_nFailures++ < 10))
+	{
+		printf("div_u64(%llu, %u): %llu, reference %llu\n", (unsigned long long)nDividend,
+				nDivisor, (unsigned long long)nFast, (unsigned long long)nRef);
+	}
+}
+
+// @brief Divisors at the digit and normalisation limits, with dividends around their multiples
+/* ======================================================*/
+static void CheckDivEdges(void)
+/* ======================================================*/
+{
+	static const uint32_t arrDivisors[] =
+	{
+		1, 2, 3, 7, 1000, 0x7FFF, 0x8000, 0xFFFF, 0x10000, 0x10001, 0x12345,
+		0x7FFFFFFF, 0x80000000, 0x80000001, 0xFFFF0000, 0xFFFF0001, 0xFFFFFFFE, 0xFFFFFFFF
+	};
+	static const uint64_t arrQuotients[] =
+	{
+		0, 1, 2, 0xFFFF, 0x10000, 0xFFFFFFFF, 0x100000000, 0x1FFFFFFFF, 0xFFFF0000FFFF
+	};
+
+	for (uint32_t i = 0; i < sizeof(arrDivisors) / sizeof(arrDivisors[0]); i++)
+	{
+		uint32_t nDivisor = arrDivisors[i];
+
+		CheckDiv(UINT64_MAX, nDivisor);
+		CheckDiv(UINT64_MAX - nDivisor, nDivisor);
+		CheckDiv(((uint64_t)nDivisor << 32) - 1, nDivisor);
+		CheckDiv((uint64_t)nDivisor << 32, nDivisor);
+		CheckDiv(((uint64_t)(nDivisor - 1) << 32) | 0xFFFFFFFF, nDivisor);
+
+		for (uint32_t j = 0; j < sizeof(arrQuotients) / sizeof(arrQuotients[0]); j++)
+		{
+			uint64_t nProduct = arrQuotients[j] * nDivisor;
+
+			// Only where the product does not wrap
+			if (arrQuotients[j] && ((nProduct / arrQuotients[j]) != nDivisor))
+			{
+				continue;
+			}
+
+			CheckDiv(nProduct, nDivisor);
+			CheckDiv(nProduct + nDivisor - 1, nDivisor);
+
+			if (nProduct)
+			{
+				CheckDiv(nProduct - 1, nDivisor);
+			}
+		}
+	}
+}
+
+// @brief xorshift32, the same sequence on every host
+/* ======================================================*/
+static uint32_t Random(void)
+/* ======================================================*/
+{
+	g_nRandomState ^= g_nRandomState << 13;
+	g_nRandomState ^= g_nRandomState >> 17;
+	g_nRandomState ^= g_nRandomState << 5;
+
+	return g_nRandomState;
+}
+
+// @brief Random number of a random bit length up to nMaxBits, so small numbers come as often as big
+/* ======================================================*/
+static uint64_t RandomBits(uint32_t nMaxBits)
+/* ======================================================*/
+{
+	uint32_t nBits  = Random() % (nMaxBits + 1);
+	uint64_t nValue = ((uint64_t)Random() << 32) | Random();
+
+	return nBits ? (nValue >> (64 - nBits)) : 0;
+}
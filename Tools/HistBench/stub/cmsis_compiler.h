@@ -0,0 +1,49 @@
+/*
+ * cmsis_compiler.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+/* Host stand-in of the CMSIS intrinsics used by vl53lx_hist_kernels.c, so the
+ * DSP versions of the kernels can be checked on the host as well
+ * (-DVL53LX_HIST_KERNELS_EMULATE_DSP). Same results as the instructions of
+ * the Cortex-M33.
+ */
+#ifndef _HIST_BENCH_CMSIS_COMPILER_H_
+#define _HIST_BENCH_CMSIS_COMPILER_H_
+
+#include <stdint.h>
+
+// QSUB - signed saturating subtract
+static inline int32_t __QSUB(int32_t nOp1, int32_t nOp2)
+{
+	int64_t nResult = (int64_t)nOp1 - nOp2;
+
+	if (nResult > INT32_MAX)
+	{
+		return INT32_MAX;
+	}
+
+	if (nResult < INT32_MIN)
+	{
+		return INT32_MIN;
+	}
+
+	return (int32_t)nResult;
+}
+
+// USAT - signed to unsigned saturation to nBits bits
+static inline uint32_t __USAT(int32_t nValue, uint32_t nBits)
+{
+	uint32_t nMax = (nBits >= 32) ? UINT32_MAX : ((1u << nBits) - 1);
+
+	if (nValue < 0)
+	{
+		return 0;
+	}
+
+	return ((uint32_t)nValue > nMax) ? nMax : (uint32_t)nValue;
+}
+
+#endif /* _HIST_BENCH_CMSIS_COMPILER_H_ */
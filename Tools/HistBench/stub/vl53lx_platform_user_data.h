@@ -0,0 +1,32 @@
+/*
+ * vl53lx_platform_user_data.h
+ *
+ *  Created on: 17.10.2026 г.
+ *      Author: Denislav Trifonov
+ */
+
+/* Host stand-in of Core/Inc/vl53lx_platform_user_data.h for the histogram
+ * benchmark. The post-processing never touches the device, so the device
+ * structure keeps only the driver data and there is no HAL or I2C bus.
+ */
+#ifndef _VL53LX_PLATFORM_USER_DATA_H_
+#define _VL53LX_PLATFORM_USER_DATA_H_
+
+#include <stdlib.h>
+
+#include "vl53lx_def.h"
+
+typedef struct {
+	VL53LX_DevData_t Data;
+} VL53LX_Dev_t;
+
+typedef VL53LX_Dev_t* VL53LX_DEV;
+
+#define VL53LXDevDataGet(Dev, field) (Dev->Data.field)
+#define VL53LXDevDataSet(Dev, field, data) ((Dev->Data.field) = (data))
+#define PALDevDataGet(Dev, field) (Dev->Data.field)
+#define PALDevDataSet(Dev, field, data) (Dev->Data.field)=(data)
+#define VL53LXDevStructGetLLDriverHandle(Dev) (&Dev->Data.LLData)
+#define VL53LXDevStructGetLLResultsHandle(Dev) (&Dev->Data.llresults)
+
+#endif /* _VL53LX_PLATFORM_USER_DATA_H_ */
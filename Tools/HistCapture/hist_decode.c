@@ -0,0 +1,201 @@
+/*
+ *  @file:   hist_decode.c
+ *  @Author: Denislav Trifonov
+ *  @Date:   17.10.2026
+ *  @brief: Host tool which decodes the binary histogram frames streamed by the
+ *          HCAP console command (see Core/Inc/hist_capture.h) into CSV, one
+ *          line per frame. Console text mixed in the stream and corrupted
+ *          frames are skipped.
+ *
+ *  Build (from this directory):
+ *      gcc -O2 -Wall -o hist_decode hist_decode.c
+ *
+ *  Usage:
+ *      stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > capture.bin
+ *      hist_decode capture.bin > capture.csv
+ *
+ *  Columns: sensor, sequence, timestamp_us, dropped, stream_count, first_bin,
+ *  ambient_bins, vcsel_period, vcsel_width, fast_osc, zero_distance_phase,
+ *  effective_spads, total_periods, peak_duration_us, woi_duration_us,
+ *  device_status, wrap_dmax_mm, then range_mm/status/sigma/signal/ambient of
+ *  each target and the bins.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* The frame layout only - hist_capture.h pulls in the ToF driver */
+#define HIST_CAPTURE_SYNC_0      0xA5
+#define HIST_CAPTURE_SYNC_1      0x5A
+#define HIST_CAPTURE_VERSION     1
+#define HIST_CAPTURE_HEADER_SIZE 16
+#define DECODE_MAX_PAYLOAD       512
+
+static uint16_t GetU16(const uint8_t *pData);
+static uint32_t GetU24(const uint8_t *pData);
+static uint32_t GetU32(const uint8_t *pData);
+static uint16_t Fletcher16(const uint8_t *pData, uint16_t nSize);
+static void PrintFrame(const uint8_t *pFrame, uint16_t nPayloadSize);
+
+/* ======================================================*/
+int main(int argc, char *argv[])
+/* ======================================================*/
+{
+	static uint8_t arrData[HIST_CAPTURE_HEADER_SIZE + DECODE_MAX_PAYLOAD + 2];
+	FILE    *pFile;
+	uint32_t nFrames = 0, nCorrupted = 0, nMissing = 0;
+	uint32_t nNextSequence = 0;
+	int      nByte;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <capture file>\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(argv[1], "rb");
+
+	if (pFile == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	while ((nByte = fgetc(pFile)) != EOF)
+	{
+		uint16_t nPayloadSize;
+		long     nResume;
+
+		if (nByte != HIST_CAPTURE_SYNC_0)
+		{
+			continue;
+		}
+
+		// On a bad frame the search continues right after this sync byte
+		nResume    = ftell(pFile);
+		arrData[0] = (uint8_t)nByte;
+
+		if (fread(arrData + 1, 1, HIST_CAPTURE_HEADER_SIZE - 1, pFile) != HIST_CAPTURE_HEADER_SIZE - 1)
+		{
+			break;
+		}
+
+		nPayloadSize = GetU16(arrData + 4);
+
+		if (arrData[1] != HIST_CAPTURE_SYNC_1 || arrData[2] != HIST_CAPTURE_VERSION || nPayloadSize > DECODE_MAX_PAYLOAD ||
+			fread(arrData + HIST_CAPTURE_HEADER_SIZE, 1, nPayloadSize + 2, pFile) != (size_t)nPayloadSize + 2 ||
+			Fletcher16(arrData, HIST_CAPTURE_HEADER_SIZE + nPayloadSize) != GetU16(arrData + HIST_CAPTURE_HEADER_SIZE + nPayloadSize))
+		{
+			if (arrData[1] == HIST_CAPTURE_SYNC_1)
+			{
+				nCorrupted++;
+			}
+
+			fseek(pFile, nResume, SEEK_SET);
+			continue;
+		}
+
+		// Frames dropped by the device are counted in the header, frames lost on the way show as sequence gaps
+		if (nFrames && GetU32(arrData + 8) > nNextSequence)
+		{
+			nMissing += GetU32(arrData + 8) - nNextSequence;
+		}
+
+		nNextSequence = GetU32(arrData + 8) + 1;
+		nFrames++;
+
+		PrintFrame(arrData, nPayloadSize);
+	}
+
+	fclose(pFile);
+	fprintf(stderr, "%u frames, %u corrupted, %u missing (dropped by the device or lost)\n", nFrames, nCorrupted, nMissing);
+
+	return 0;
+}
+
+/* ======================================================*/
+static void PrintFrame(const uint8_t *pFrame, uint16_t nPayloadSize)
+/* ======================================================*/
+{
+	const uint8_t *pData = pFrame + HIST_CAPTURE_HEADER_SIZE;
+	const uint8_t *pEnd  = pData + nPayloadSize;
+	uint8_t nBins, nTargets;
+	const uint8_t *pBins;
+
+	printf("%u,%u,%u,%u,", pFrame[3], GetU32(pFrame + 8), GetU32(pFrame + 12), GetU16(pFrame + 6));
+
+	// stream count, range status, first bin, bins count, ambient bins, VCSEL period, phasecal VCSEL start
+	nBins = pData[3];
+	printf("%u,%u,%u,%u,", pData[0], pData[2], pData[4], pData[5]);
+	pData += 7 + 12;
+
+	// VCSEL width, fast oscillator, zero distance phase, reference phase, effective SPADs
+	printf("%u,%u,%u,%u,", GetU16(pData), GetU16(pData + 2), GetU16(pData + 4), GetU16(pData + 8));
+	pData += 10;
+
+	printf("%u,%u,%u,", GetU32(pData), GetU32(pData + 4), GetU32(pData + 8));
+	pData += 12;
+
+	pBins  = pData;
+	pData += nBins * 3;
+
+	if (pData + 5 > pEnd)
+	{
+		printf("\n");
+		return;
+	}
+
+	// Range results
+	nTargets = pData[2];
+	printf("%u,%d", pData[1], (int16_t)GetU16(pData + 3));
+	pData += 5;
+
+	for (uint8_t i = 0; i < nTargets && pData + 13 <= pEnd; i++, pData += 13)
+	{
+		printf(",%d,%u,%u,%u,%u", (int16_t)GetU16(pData), pData[6], GetU16(pData + 7), GetU16(pData + 9), GetU16(pData + 11));
+	}
+
+	for (uint8_t i = 0; i < nBins; i++)
+	{
+		printf(",%u", GetU24(pBins + i * 3));
+	}
+
+	printf("\n");
+}
+
+/* ======================================================*/
+static uint16_t GetU16(const uint8_t *pData)
+/* ======================================================*/
+{
+	return (uint16_t)(pData[0] | (pData[1] << 8));
+}
+
+/* ======================================================*/
+static uint32_t GetU24(const uint8_t *pData)
+/* ======================================================*/
+{
+	return pData[0] | ((uint32_t)pData[1] << 8) | ((uint32_t)pData[2] << 16);
+}
+
+/* ======================================================*/
+static uint32_t GetU32(const uint8_t *pData)
+/* ======================================================*/
+{
+	return GetU16(pData) | ((uint32_t)GetU16(pData + 2) << 16);
+}
+
+/* ======================================================*/
+static uint16_t Fletcher16(const uint8_t *pData, uint16_t nSize)
+/* ======================================================*/
+{
+	uint16_t nSum1 = 0;
+	uint16_t nSum2 = 0;
+
+	for (uint16_t i = 0; i < nSize; i++)
+	{
+		nSum1 = (nSum1 + pData[i]) % 255;
+		nSum2 = (nSum2 + nSum1) % 255;
+	}
+
+	return (nSum2 << 8) | nSum1;
+}
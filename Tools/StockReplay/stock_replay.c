@@ -0,0 +1,311 @@
+/*
+ *  @file:   stock_replay.c
+ *  @Author: Denislav Trifonov
+ *  @Date:   17.10.2026
+ *  @brief: Host tool which replays measurements captured with the RECD console
+ *          command through the stock estimation of the firmware (Core/Src/stock.c)
+ *          and the stock propagation of app_bluenrg.c (User_Process).
+ *
+ *  Build (from this directory):
+ *      gcc -O2 -Wall -I../../Core/Inc -o stock_replay stock_replay.c ../../Core/Src/stock.c
+ *  The filter can be tuned at build time, e.g. -DSTOCK_FILTER_MIN_FRAMES=3.
+ *
+ *  Usage:
+ *      stock_replay <capture file>
+ *
+ *  The capture is the text printed by RECD, one record per line:
+ *      S <shelf> <type> <initial stock> <left stock>
+ *      F <shelf> <timestamp us, hex> <status> <range mm> <sigma 8.8> <signal 9.7> <ambient 9.7> <stream count>
+ *  Lines starting with anything else are ignored. To score a capture, the real
+ *  stock is added by hand before the frames it applies to:
+ *      T <shelf> <real stock>
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "stock.h"
+
+#define REPLAY_SHELVES_MAX   5
+#define REPLAY_LINE_SIZE     128
+#define REPLAY_SHELF_DRINK   0	// SHELF_TYPES of eeprom.h
+#define REPLAY_RANGE_VALID   0	// VL53LX_RANGESTATUS_RANGE_VALID
+#define REPLAY_STOCK_UNKNOWN 0xFFFF
+
+typedef struct {
+	uint8_t         m_bConfigured;
+	uint8_t         m_eShelfType;
+	STOCK_ESTIMATOR m_sEstimator;
+
+	// Stock as in tof.c (g_arrLeftItems) and as published by app_bluenrg.c
+	uint8_t  m_nLeftItems;
+	uint8_t  m_nPublishedItems;
+	uint8_t  m_nRawItems;
+
+	// Real stock from the T lines and the frames since it changed
+	uint16_t m_nRealItems;
+	uint8_t  m_bPendingDetection;
+	uint32_t m_nFramesSinceChange;
+
+	uint32_t m_nFrames;
+	uint32_t m_nValidFrames;
+	uint32_t m_nRawChanges;
+	uint32_t m_nTransitions;
+	uint32_t m_nFalseTransitions;
+	uint32_t m_nEmptyEvents;
+	uint32_t m_nDetections;
+	uint32_t m_nMissedDetections;
+	uint32_t m_nTotalLatency;
+	uint32_t m_nMaxLatency;
+	uint64_t m_nProcessing_ns;
+}REPLAY_SHELF;
+
+static REPLAY_SHELF g_arrShelves[REPLAY_SHELVES_MAX];
+
+static void ReplayShelfConfig(const char *pLine);
+static void ReplayRealStock(const char *pLine);
+static void ReplayFrame(const char *pLine);
+static void PublishStock(REPLAY_SHELF *pShelf);
+static void PrintReport(void);
+static uint64_t GetTime_ns(void);
+
+/* ======================================================*/
+int main(int argc, char *argv[])
+/* ======================================================*/
+{
+	char  arrLine[REPLAY_LINE_SIZE];
+	FILE *pFile;
+
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <capture file>\n", argv[0]);
+		return 2;
+	}
+
+	pFile = fopen(argv[1], "r");
+
+	if (pFile == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	while (fgets(arrLine, sizeof(arrLine), pFile) != NULL)
+	{
+		switch (arrLine[0])
+		{
+		case 'S':
+			ReplayShelfConfig(arrLine);
+			break;
+
+		case 'T':
+			ReplayRealStock(arrLine);
+			break;
+
+		case 'F':
+			ReplayFrame(arrLine);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	fclose(pFile);
+	PrintReport();
+
+	return 0;
+}
+
+// @brief Shelf record - as in ToF_Init, the stock starts from 0 until the first estimate
+/* ======================================================*/
+static void ReplayShelfConfig(const char *pLine)
+/* ======================================================*/
+{
+	unsigned int nShelf, nType, nInitialStock, nLeftStock;
+	REPLAY_SHELF *pShelf;
+
+	if (sscanf(pLine, "S %u %u %u %u", &nShelf, &nType, &nInitialStock, &nLeftStock) != 4 || nShelf >= REPLAY_SHELVES_MAX)
+	{
+		return;
+	}
+
+	pShelf = &g_arrShelves[nShelf];
+	memset(pShelf, 0, sizeof(*pShelf));
+
+	pShelf->m_bConfigured = 1;
+	pShelf->m_eShelfType  = (uint8_t)nType;
+	pShelf->m_nRealItems  = REPLAY_STOCK_UNKNOWN;
+	Stock_Init(&pShelf->m_sEstimator, (uint8_t)nInitialStock);
+}
+
+// @brief The real stock changes from the next frame on
+/* ======================================================*/
+static void ReplayRealStock(const char *pLine)
+/* ======================================================*/
+{
+	unsigned int nShelf, nItems;
+	REPLAY_SHELF *pShelf;
+
+	if (sscanf(pLine, "T %u %u", &nShelf, &nItems) != 2 || nShelf >= REPLAY_SHELVES_MAX || !g_arrShelves[nShelf].m_bConfigured)
+	{
+		return;
+	}
+
+	pShelf = &g_arrShelves[nShelf];
+
+	if (pShelf->m_nRealItems == nItems)
+	{
+		return;
+	}
+
+	// The previous change was never reported
+	if (pShelf->m_bPendingDetection)
+	{
+		pShelf->m_nMissedDetections++;
+	}
+
+	pShelf->m_nRealItems         = (uint16_t)nItems;
+	pShelf->m_nFramesSinceChange = 0;
+	pShelf->m_bPendingDetection  = (pShelf->m_nPublishedItems != nItems);
+}
+
+// @brief Measurement record - the same path as ProcessLatchedData/CalculateLeftShelfItems
+/* ======================================================*/
+static void ReplayFrame(const char *pLine)
+/* ======================================================*/
+{
+	unsigned int nShelf, nTimestamp, nStatus, nSigma, nSignal, nAmbient, nStreamCount;
+	int nRange;
+	REPLAY_SHELF *pShelf;
+	uint64_t nStart_ns;
+	uint8_t  nLeftItems;
+
+	if (sscanf(pLine, "F %u %x %u %d %u %u %u %u", &nShelf, &nTimestamp, &nStatus, &nRange,
+			&nSigma, &nSignal, &nAmbient, &nStreamCount) != 8 || nShelf >= REPLAY_SHELVES_MAX)
+	{
+		return;
+	}
+
+	pShelf = &g_arrShelves[nShelf];
+
+	if (!pShelf->m_bConfigured || pShelf->m_eShelfType != REPLAY_SHELF_DRINK)
+	{
+		return;
+	}
+
+	pShelf->m_nFrames++;
+	pShelf->m_nFramesSinceChange++;
+
+	if (nStatus == REPLAY_RANGE_VALID)
+	{
+		pShelf->m_nValidFrames++;
+
+		nStart_ns = GetTime_ns();
+
+		if (Stock_Filter(&pShelf->m_sEstimator, (int16_t)nRange, (uint16_t)nSigma, (uint16_t)nSignal, &nLeftItems))
+		{
+			pShelf->m_nLeftItems = nLeftItems;
+		}
+
+		pShelf->m_nProcessing_ns += GetTime_ns() - nStart_ns;
+
+		// Single frame estimate, to see how noisy the capture is
+		nLeftItems = Stock_Estimate(&pShelf->m_sEstimator, (int16_t)nRange);
+
+		if (nLeftItems != pShelf->m_nRawItems)
+		{
+			pShelf->m_nRawItems = nLeftItems;
+			pShelf->m_nRawChanges++;
+		}
+	}
+
+	PublishStock(pShelf);
+}
+
+// @brief Propagation of the stock as in User_Process - GATT update, EEPROM write and the empty shelf log
+/* ======================================================*/
+static void PublishStock(REPLAY_SHELF *pShelf)
+/* ======================================================*/
+{
+	if (pShelf->m_nPublishedItems == pShelf->m_nLeftItems)
+	{
+		return;
+	}
+
+	pShelf->m_nPublishedItems = pShelf->m_nLeftItems;
+	pShelf->m_nTransitions++;
+
+	if (!pShelf->m_nPublishedItems)
+	{
+		pShelf->m_nEmptyEvents++;
+	}
+
+	if (pShelf->m_nRealItems == REPLAY_STOCK_UNKNOWN)
+	{
+		return;
+	}
+
+	if (pShelf->m_nPublishedItems != pShelf->m_nRealItems)
+	{
+		pShelf->m_nFalseTransitions++;
+	}
+	else if (pShelf->m_bPendingDetection)
+	{
+		pShelf->m_bPendingDetection = 0;
+		pShelf->m_nDetections++;
+		pShelf->m_nTotalLatency += pShelf->m_nFramesSinceChange;
+
+		if (pShelf->m_nFramesSinceChange > pShelf->m_nMaxLatency)
+		{
+			pShelf->m_nMaxLatency = pShelf->m_nFramesSinceChange;
+		}
+	}
+}
+
+/* ======================================================*/
+static void PrintReport(void)
+/* ======================================================*/
+{
+	for (uint8_t i = 0; i < REPLAY_SHELVES_MAX; i++)
+	{
+		REPLAY_SHELF *pShelf = &g_arrShelves[i];
+
+		if (!pShelf->m_bConfigured || pShelf->m_nFrames == 0)
+		{
+			continue;
+		}
+
+		if (pShelf->m_bPendingDetection)
+		{
+			pShelf->m_nMissedDetections++;
+			pShelf->m_bPendingDetection = 0;
+		}
+
+		printf("Shelf %u: %u frames (%u valid), stock %u\n", i, pShelf->m_nFrames, pShelf->m_nValidFrames, pShelf->m_nPublishedItems);
+		printf("  Published transitions: %u (%u to empty), single frame estimate changes: %u\n",
+				pShelf->m_nTransitions, pShelf->m_nEmptyEvents, pShelf->m_nRawChanges);
+
+		if (pShelf->m_nDetections || pShelf->m_nMissedDetections || pShelf->m_nFalseTransitions)
+		{
+			printf("  Detected changes: %u, missed: %u, false transitions: %u\n",
+					pShelf->m_nDetections, pShelf->m_nMissedDetections, pShelf->m_nFalseTransitions);
+			printf("  Detection latency: %.2f frames average, %u frames max\n",
+					pShelf->m_nDetections ? (double)pShelf->m_nTotalLatency / pShelf->m_nDetections : 0.0, pShelf->m_nMaxLatency);
+		}
+
+		printf("  Filter CPU time: %.1f ns per valid frame\n",
+				pShelf->m_nValidFrames ? (double)pShelf->m_nProcessing_ns / pShelf->m_nValidFrames : 0.0);
+	}
+}
+
+/* ======================================================*/
+static uint64_t GetTime_ns(void)
+/* ======================================================*/
+{
+	struct timespec sTime;
+
+	clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+	return (uint64_t)sTime.tv_sec * 1000000000u + sTime.tv_nsec;
+}